@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include <grpcpp/grpcpp.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "local_cluster.h"
+#include "utils/logging.h"
+
+// Client-visible cost of writing/reading a batch of keys through one
+// coordinator: one Put/Get RPC per key versus a single MultiPut/MultiGet,
+// which the coordinator splits into one internal batch per replica.
+// Runs against a 3-node in-process cluster (RF=3, W=2, R=2) over loopback.
+//
+//   kv_microbench --benchmark_filter='PerKey|Multi'
+namespace {
+
+kvstore::KeyValue::Stub& client() {
+    static LocalCluster cluster = [] {
+        kv::log::set_level(kv::log::LogLevel::None);
+        return LocalCluster(3, 3, 2, 2);
+    }();
+    static auto stub = kvstore::KeyValue::NewStub(grpc::CreateChannel(
+        cluster.addresses().front(), grpc::InsecureChannelCredentials()));
+    return *stub;
+}
+
+std::vector<std::string> make_keys(int64_t count) {
+    std::vector<std::string> keys;
+    for (int64_t i = 0; i < count; ++i) {
+        keys.push_back("bench_key_" + std::to_string(i));
+    }
+    return keys;
+}
+
+void BM_PerKeyPut(benchmark::State& state) {
+    auto& stub = client();
+    const auto keys = make_keys(state.range(0));
+    const std::string value(100, 'v');
+    for (auto _ : state) {
+        for (const auto& key : keys) {
+            grpc::ClientContext ctx;
+            kvstore::PutRequest req;
+            kvstore::PutResponse resp;
+            req.set_key(key);
+            req.set_value(value);
+            benchmark::DoNotOptimize(stub.Put(&ctx, req, &resp).ok());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PerKeyPut)->Arg(16)->Arg(128)->UseRealTime();
+
+void BM_MultiPut(benchmark::State& state) {
+    auto& stub = client();
+    kvstore::MultiPutRequest req;
+    for (const auto& key : make_keys(state.range(0))) {
+        auto* entry = req.add_entries();
+        entry->set_key(key);
+        entry->set_value(std::string(100, 'v'));
+    }
+    for (auto _ : state) {
+        grpc::ClientContext ctx;
+        kvstore::MultiPutResponse resp;
+        benchmark::DoNotOptimize(stub.MultiPut(&ctx, req, &resp).ok());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MultiPut)->Arg(16)->Arg(128)->UseRealTime();
+
+void BM_PerKeyGet(benchmark::State& state) {
+    auto& stub = client();
+    const auto keys = make_keys(state.range(0));
+    for (auto _ : state) {
+        for (const auto& key : keys) {
+            grpc::ClientContext ctx;
+            kvstore::GetRequest req;
+            kvstore::GetResponse resp;
+            req.set_key(key);
+            benchmark::DoNotOptimize(stub.Get(&ctx, req, &resp).ok());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PerKeyGet)->Arg(16)->Arg(128)->UseRealTime();
+
+void BM_MultiGet(benchmark::State& state) {
+    auto& stub = client();
+    kvstore::MultiGetRequest req;
+    for (const auto& key : make_keys(state.range(0))) {
+        req.add_keys(key);
+    }
+    for (auto _ : state) {
+        grpc::ClientContext ctx;
+        kvstore::MultiGetResponse resp;
+        benchmark::DoNotOptimize(stub.MultiGet(&ctx, req, &resp).ok());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MultiGet)->Arg(16)->Arg(128)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,26 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "hash/murmur3.h"
+
+// murmur3_64 throughput by key length. Short keys are dominated by the tail
+// and finalizer, long ones by the 16-byte block loop; bytes/s should level
+// off once the block loop dominates.
+//
+//   kv_microbench --benchmark_filter=Murmur3
+namespace {
+
+void BM_Murmur3(benchmark::State& state) {
+    const std::string key(static_cast<size_t>(state.range(0)), 'k');
+    uint64_t seed = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kv::hash::murmur3_64(key, seed++));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_Murmur3)->Arg(8)->Arg(16)->Arg(24)->Arg(64)->Arg(256)->Arg(1024)->Arg(4096);
@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cluster/cluster_view.h"
+#include "node/node.h"
+#include "node/node_config.h"
+#include "utils/logging.h"
+
+using kv::node::Node;
+using kv::node::Version;
+
+// Replica-side cost of Node::local_get / Node::apply_put_local (what every
+// internal Get/Put RPC ends up calling) at 1..N threads on one shared node:
+// storage engine lookup, LWW check and metrics, without the RPC layer.
+//
+//   kv_microbench --benchmark_filter=NodeLocal
+namespace {
+
+constexpr size_t kKeys = 100000;
+
+const std::vector<std::string>& keys() {
+    static const std::vector<std::string> k = [] {
+        std::vector<std::string> out;
+        out.reserve(kKeys);
+        for (size_t i = 0; i < kKeys; ++i) {
+            out.push_back("key_" + std::to_string(i));
+        }
+        return out;
+    }();
+    return k;
+}
+
+// One preloaded in-memory node shared by all benchmark threads.
+Node& preloaded_node() {
+    static kv::cluster::ClusterView view(100);
+    static std::unique_ptr<Node> node = [] {
+        kv::log::set_level(kv::log::LogLevel::None);
+        kv::NodeConfig cfg;
+        cfg.node_id = "n1";
+        cfg.port = 1;
+        view.add_node_to_cluster(cfg.node_id, "localhost:1");
+        auto n = std::make_unique<Node>(cfg, view);
+        for (const auto& key : keys()) {
+            n->apply_put_local(key, std::string(64, 'v'), Version{1, 1});
+        }
+        return n;
+    }();
+    return *node;
+}
+
+// Newer-than-preload timestamps shared across threads so every put wins LWW.
+std::atomic<uint64_t> g_ts{2};
+
+void BM_NodeLocalGet(benchmark::State& state) {
+    auto& node = preloaded_node();
+    const auto& k = keys();
+    std::mt19937_64 rng(static_cast<uint64_t>(state.thread_index()) + 1);
+    std::uniform_int_distribution<size_t> pick(0, k.size() - 1);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(node.local_get(k[pick(rng)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_NodeLocalPut(benchmark::State& state) {
+    auto& node = preloaded_node();
+    const auto& k = keys();
+    const std::string value(64, 'w');
+    std::mt19937_64 rng(static_cast<uint64_t>(state.thread_index()) + 1);
+    std::uniform_int_distribution<size_t> pick(0, k.size() - 1);
+
+    for (auto _ : state) {
+        auto ts = g_ts.fetch_add(1, std::memory_order_relaxed);
+        benchmark::DoNotOptimize(node.apply_put_local(k[pick(rng)], value, Version{ts, 1}));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// All threads writing one key: worst case for the per-key LWW check.
+void BM_NodeLocalPutHotKey(benchmark::State& state) {
+    auto& node = preloaded_node();
+    const std::string value(64, 'h');
+
+    for (auto _ : state) {
+        auto ts = g_ts.fetch_add(1, std::memory_order_relaxed);
+        benchmark::DoNotOptimize(node.apply_put_local("hot_key", value, Version{ts, 1}));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+int max_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<int>(n);
+}
+
+}  // namespace
+
+BENCHMARK(BM_NodeLocalGet)->ThreadRange(1, max_threads())->UseRealTime();
+BENCHMARK(BM_NodeLocalPut)->ThreadRange(1, max_threads())->UseRealTime();
+BENCHMARK(BM_NodeLocalPutHotKey)->ThreadRange(1, max_threads())->UseRealTime();
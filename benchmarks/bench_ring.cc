@@ -0,0 +1,116 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cluster/cluster_view.h"
+#include "ring/consistent_hash_ring.h"
+
+using kv::ring::ConsistentHashRing;
+
+// Cost of routing a key: get_owner_node, get_preference_list and
+// preference_slots (RF=3) over a grid of cluster sizes and vnodes per node.
+// Lookups are a binary search over the token array, so time should grow with
+// log(nodes * vnodes); get_preference_list adds copying out the node ids.
+//
+//   kv_microbench --benchmark_filter=Ring
+namespace {
+
+constexpr size_t kKeys = 4096;  // power of two; the loop masks into it
+
+const std::vector<std::string>& keys() {
+    static const std::vector<std::string> k = [] {
+        std::vector<std::string> out;
+        out.reserve(kKeys);
+        for (size_t i = 0; i < kKeys; ++i) {
+            out.push_back("user" + std::to_string(i * 7919));
+        }
+        return out;
+    }();
+    return k;
+}
+
+ConsistentHashRing make_ring(int64_t nodes, int64_t vnodes) {
+    ConsistentHashRing ring(static_cast<size_t>(vnodes));
+    for (int64_t i = 0; i < nodes; ++i) {
+        ring.add_node("node" + std::to_string(i));
+    }
+    return ring;
+}
+
+void BM_RingOwner(benchmark::State& state) {
+    const auto ring = make_ring(state.range(0), state.range(1));
+    const auto& k = keys();
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ring.get_owner_node(k[i++ & (kKeys - 1)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_RingPreferenceList(benchmark::State& state) {
+    const auto ring = make_ring(state.range(0), state.range(1));
+    const auto& k = keys();
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ring.get_preference_list(k[i++ & (kKeys - 1)], 3));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// The allocation-free form: owner slots straight from the precomputed table.
+void BM_RingPreferenceSlots(benchmark::State& state) {
+    const auto ring = make_ring(state.range(0), state.range(1));
+    const auto& k = keys();
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ring.preference_slots(k[i++ & (kKeys - 1)], 3).data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Membership change cost: adding one node inserts `vnodes` ring entries and
+// rebuilds the preference table.
+void BM_RingAddNode(benchmark::State& state) {
+    auto ring = make_ring(state.range(0), state.range(1));
+    for (auto _ : state) {
+        ring.add_node("joining");
+        state.PauseTiming();
+        ring.remove_node("joining");
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// The request-path lookup through ClusterView at 1..N threads. Reads are
+// lock-free against a published snapshot, so throughput should scale with
+// threads instead of serializing on a view-wide mutex.
+void BM_ClusterViewReplicaSet(benchmark::State& state) {
+    static kv::cluster::ClusterView* view = [] {
+        auto* v = new kv::cluster::ClusterView(100, 3);
+        for (int i = 0; i < 16; ++i) {
+            v->add_node_to_cluster("node" + std::to_string(i), "localhost:" + std::to_string(5000 + i));
+        }
+        return v;
+    }();
+    const auto& k = keys();
+    size_t i = static_cast<size_t>(state.thread_index()) * 997;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(view->get_replica_set_for_key(k[i++ & (kKeys - 1)], 3));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+int max_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<int>(n);
+}
+
+}  // namespace
+
+BENCHMARK(BM_RingOwner)->ArgsProduct({{3, 16, 64}, {16, 100, 1000}});
+BENCHMARK(BM_RingPreferenceList)->ArgsProduct({{3, 16, 64}, {16, 100, 1000}});
+BENCHMARK(BM_RingPreferenceSlots)->ArgsProduct({{3, 16, 64}, {16, 100, 1000}});
+BENCHMARK(BM_RingAddNode)->ArgsProduct({{3, 64}, {16, 100, 1000}});
+BENCHMARK(BM_ClusterViewReplicaSet)->ThreadRange(1, max_threads())->UseRealTime();
@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/sharded_store.h"
+
+using kv::storage::ShardedStore;
+using kv::node::Version;
+
+// Multi-threaded GET/PUT throughput of the sharded store. Each benchmark takes
+// the shard count as its argument and runs at 1..N threads, so items/s across
+// thread counts shows how throughput scales with cores for a given sharding.
+//
+//   kv_microbench --benchmark_filter=ShardedStore
+namespace {
+
+constexpr size_t kKeys = 100000;
+
+const std::vector<std::string>& keys() {
+    static const std::vector<std::string> k = [] {
+        std::vector<std::string> out;
+        out.reserve(kKeys);
+        for (size_t i = 0; i < kKeys; ++i) {
+            out.push_back("key_" + std::to_string(i));
+        }
+        return out;
+    }();
+    return k;
+}
+
+// One preloaded store per shard count, shared by all benchmark threads.
+ShardedStore& preloaded_store(size_t shards) {
+    static std::mutex mu;
+    static std::map<size_t, std::unique_ptr<ShardedStore>> stores;
+
+    std::lock_guard<std::mutex> lock(mu);
+    auto& store = stores[shards];
+    if (!store) {
+        store = std::make_unique<ShardedStore>(shards);
+        for (const auto& key : keys()) {
+            store->put_if_newer(key, std::string(64, 'v'), Version{1, 1});
+        }
+    }
+    return *store;
+}
+
+void BM_ShardedStoreGet(benchmark::State& state) {
+    auto& store = preloaded_store(static_cast<size_t>(state.range(0)));
+    const auto& k = keys();
+    std::mt19937_64 rng(static_cast<uint64_t>(state.thread_index()) + 1);
+    std::uniform_int_distribution<size_t> pick(0, k.size() - 1);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.get(k[pick(rng)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ShardedStorePut(benchmark::State& state) {
+    auto& store = preloaded_store(static_cast<size_t>(state.range(0)));
+    const auto& k = keys();
+    const std::string value(64, 'w');
+    std::mt19937_64 rng(static_cast<uint64_t>(state.thread_index()) + 1);
+    std::uniform_int_distribution<size_t> pick(0, k.size() - 1);
+    uint64_t ts = 2;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.put_if_newer(k[pick(rng)], value, Version{ts++, 1}));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 95% GET / 5% PUT, the node's expected steady-state mix.
+void BM_ShardedStoreMixed(benchmark::State& state) {
+    auto& store = preloaded_store(static_cast<size_t>(state.range(0)));
+    const auto& k = keys();
+    const std::string value(64, 'm');
+    std::mt19937_64 rng(static_cast<uint64_t>(state.thread_index()) + 1);
+    std::uniform_int_distribution<size_t> pick(0, k.size() - 1);
+    std::uniform_int_distribution<int> op(0, 99);
+    uint64_t ts = 2;
+
+    for (auto _ : state) {
+        const auto& key = k[pick(rng)];
+        if (op(rng) < 5) {
+            benchmark::DoNotOptimize(store.put_if_newer(key, value, Version{ts++, 1}));
+        } else {
+            benchmark::DoNotOptimize(store.get(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+int max_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<int>(n);
+}
+
+}  // namespace
+
+BENCHMARK(BM_ShardedStoreGet)->Arg(1)->Arg(16)->Arg(64)->ThreadRange(1, max_threads())->UseRealTime();
+BENCHMARK(BM_ShardedStorePut)->Arg(1)->Arg(16)->Arg(64)->ThreadRange(1, max_threads())->UseRealTime();
+BENCHMARK(BM_ShardedStoreMixed)->Arg(1)->Arg(16)->Arg(64)->ThreadRange(1, max_threads())->UseRealTime();
@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "storage/memory_engine.h"
+#include "storage/wal.h"
+
+using kv::node::Version;
+using kv::storage::MemoryEngine;
+using kv::storage::StorageEngineOptions;
+using kv::storage::WalSyncMode;
+using kv::storage::WriteAheadLog;
+
+// Append throughput of the write-ahead log per sync mode, at 1..N threads.
+// In batch mode the per-write fsync cost should fall as threads are added,
+// since concurrent appends share each group commit. BM_MemoryEnginePutOneShard
+// does the same through a one-shard MemoryEngine, where every writer contends
+// for the same shard lock; items/s should still grow with threads.
+//
+//   kv_microbench --benchmark_filter=Wal
+namespace {
+
+std::mutex g_wal_mu;
+std::unique_ptr<WriteAheadLog> g_wal;
+std::filesystem::path g_wal_dir;
+
+void BM_WalAppend(benchmark::State& state) {
+    auto mode = static_cast<WalSyncMode>(state.range(0));
+    if (state.thread_index() == 0) {
+        std::lock_guard<std::mutex> lock(g_wal_mu);
+        g_wal_dir = std::filesystem::temp_directory_path() / "kv_bench_wal";
+        std::filesystem::remove_all(g_wal_dir);
+        WriteAheadLog::Options options;
+        options.dir = g_wal_dir.string();
+        options.sync_mode = mode;
+        g_wal = std::make_unique<WriteAheadLog>(options, [](auto&&...) {});
+    }
+
+    const std::string value(128, 'v');
+    const std::string key = "key_" + std::to_string(state.thread_index());
+    uint64_t ts = 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(g_wal->append(key, value, Version{ts++, 1}));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(kv::storage::to_string(mode));
+
+    if (state.thread_index() == 0) {
+        std::lock_guard<std::mutex> lock(g_wal_mu);
+        g_wal.reset();
+        std::filesystem::remove_all(g_wal_dir);
+    }
+}
+
+std::unique_ptr<MemoryEngine> g_engine;
+
+void BM_MemoryEnginePutOneShard(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        std::lock_guard<std::mutex> lock(g_wal_mu);
+        g_wal_dir = std::filesystem::temp_directory_path() / "kv_bench_engine_wal";
+        std::filesystem::remove_all(g_wal_dir);
+        StorageEngineOptions options;
+        options.data_dir = g_wal_dir.string();
+        options.wal_sync_mode = WalSyncMode::Batch;
+        options.memory_shards = 1;
+        g_engine = std::make_unique<MemoryEngine>(options);
+    }
+
+    const std::string value(128, 'v');
+    const std::string key = "key_" + std::to_string(state.thread_index());
+    const auto writer = static_cast<uint32_t>(state.thread_index()) + 1;
+    uint64_t ts = 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(g_engine->put_if_newer(key, value, Version{ts++, writer}));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        std::lock_guard<std::mutex> lock(g_wal_mu);
+        g_engine.reset();
+        std::filesystem::remove_all(g_wal_dir);
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_WalAppend)
+    ->Arg(static_cast<int>(WalSyncMode::None))
+    ->Arg(static_cast<int>(WalSyncMode::Batch))
+    ->Arg(static_cast<int>(WalSyncMode::Periodic))
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK(BM_MemoryEnginePutOneShard)->ThreadRange(1, 16)->UseRealTime();
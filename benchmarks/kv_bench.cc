@@ -0,0 +1,478 @@
+#include <grpcpp/grpcpp.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kv.grpc.pb.h"
+#include "latency_histogram.h"
+#include "local_cluster.h"
+#include "utils/logging.h"
+#include "ycsb_workload.h"
+
+// YCSB-style load generator. Starts an in-process cluster (default) or drives
+// a running one (--target), loads --records keys with MultiPut, then runs a
+// core workload from closed-loop client threads and reports throughput and
+// per-operation latency percentiles as text and, with --json, as JSON.
+//
+//   kv_bench --workload A --records 100000 --operations 200000 --threads 16
+//   kv_bench --target localhost:50051,localhost:50052 --workload C --duration 30
+//
+// The store has no range reads, so workload E's scans are MultiGets of
+// consecutive record indexes.
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    ycsb::Workload workload = *ycsb::core_workload('A');
+    uint64_t records = 10000;
+    uint64_t operations = 100000;
+    double duration_s = 0;  // >0 runs for this long instead of --operations
+    size_t threads = 8;
+    size_t value_size = 100;
+    std::optional<ycsb::Distribution> distribution;
+    std::optional<double> read_proportion;
+
+    std::vector<std::string> targets;  // empty: start an in-process cluster
+    size_t nodes = 3;
+    size_t rf = 3;
+    int write_quorum = 2;
+    int read_quorum = 2;
+
+    bool skip_load = false;
+    size_t load_batch = 100;
+    std::string json_path;  // "-" for stdout
+};
+
+void print_usage() {
+    std::cerr
+        << "Usage: kv_bench [options]\n"
+        << "Workload:\n"
+        << "  --workload A-F            YCSB core workload (default A)\n"
+        << "  --records N               records loaded before the run (default 10000)\n"
+        << "  --operations N            operations in the run (default 100000)\n"
+        << "  --duration S              run for S seconds instead of --operations\n"
+        << "  --threads N               client threads (default 8)\n"
+        << "  --value-size B            value size in bytes (default 100)\n"
+        << "  --distribution D          uniform | zipfian | latest (default per workload)\n"
+        << "  --read-proportion P       override the mix: P reads, 1-P updates\n"
+        << "Cluster:\n"
+        << "  --target H:P[,H:P...]     drive a running cluster instead of an in-process one\n"
+        << "  --nodes N --rf N --w N --r N   in-process cluster shape (default 3 3 2 2)\n"
+        << "  --skip-load               do not load records first\n"
+        << "  --load-batch N            keys per MultiPut while loading (default 100)\n"
+        << "Output:\n"
+        << "  --json PATH               also write results as JSON (\"-\" for stdout)\n";
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> out;
+    std::istringstream in(s);
+    for (std::string part; std::getline(in, part, sep);) {
+        if (!part.empty()) {
+            out.push_back(part);
+        }
+    }
+    return out;
+}
+
+// Returns an error message, or std::nullopt once `config` is filled in.
+std::optional<std::string> parse_args(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--skip-load") {
+            config.skip_load = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return arg + " requires a value";
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--workload") {
+                auto workload = value.size() == 1 ? ycsb::core_workload(value[0]) : std::nullopt;
+                if (!workload) {
+                    return "unknown workload '" + value + "'";
+                }
+                config.workload = *workload;
+            } else if (arg == "--records") {
+                config.records = std::stoull(value);
+            } else if (arg == "--operations") {
+                config.operations = std::stoull(value);
+            } else if (arg == "--duration") {
+                config.duration_s = std::stod(value);
+            } else if (arg == "--threads") {
+                config.threads = std::stoul(value);
+            } else if (arg == "--value-size") {
+                config.value_size = std::stoul(value);
+            } else if (arg == "--distribution") {
+                config.distribution = ycsb::parse_distribution(value);
+                if (!config.distribution) {
+                    return "unknown distribution '" + value + "'";
+                }
+            } else if (arg == "--read-proportion") {
+                config.read_proportion = std::stod(value);
+            } else if (arg == "--target") {
+                config.targets = split(value, ',');
+            } else if (arg == "--nodes") {
+                config.nodes = std::stoul(value);
+            } else if (arg == "--rf") {
+                config.rf = std::stoul(value);
+            } else if (arg == "--w") {
+                config.write_quorum = std::stoi(value);
+            } else if (arg == "--r") {
+                config.read_quorum = std::stoi(value);
+            } else if (arg == "--load-batch") {
+                config.load_batch = std::stoul(value);
+            } else if (arg == "--json") {
+                config.json_path = value;
+            } else {
+                return "unknown option " + arg;
+            }
+        } catch (const std::exception&) {
+            return "invalid value for " + arg + ": " + value;
+        }
+    }
+
+    if (config.distribution) {
+        config.workload.distribution = *config.distribution;
+    }
+    if (config.read_proportion) {
+        if (*config.read_proportion < 0 || *config.read_proportion > 1) {
+            return "--read-proportion must be within [0, 1]";
+        }
+        config.workload.read = *config.read_proportion;
+        config.workload.update = 1.0 - *config.read_proportion;
+        config.workload.insert = config.workload.scan = config.workload.read_modify_write = 0;
+    }
+    if (config.threads == 0 || config.load_batch == 0 || config.records == 0) {
+        return "--threads, --records and --load-batch must be >= 1";
+    }
+    if (config.targets.empty() && (config.nodes == 0 || config.rf == 0)) {
+        return "--nodes and --rf must be >= 1";
+    }
+    return std::nullopt;
+}
+
+std::unique_ptr<kvstore::KeyValue::Stub> make_stub(const std::string& address, size_t index) {
+    // Distinct channel args give each client thread its own connection.
+    grpc::ChannelArguments args;
+    args.SetInt("kv_bench.channel_index", static_cast<int>(index));
+    return kvstore::KeyValue::NewStub(
+        grpc::CreateCustomChannel(address, grpc::InsecureChannelCredentials(), args));
+}
+
+std::string random_value(size_t size, std::mt19937_64& rng) {
+    std::string value(size, '\0');
+    std::uniform_int_distribution<int> printable('a', 'z');
+    for (auto& c : value) {
+        c = static_cast<char>(printable(rng));
+    }
+    return value;
+}
+
+struct ThreadStats {
+    std::array<LatencyHistogram, ycsb::OP_COUNT> latency_ns;
+    std::array<uint64_t, ycsb::OP_COUNT> failures{};
+};
+
+// Loads records [0, records) in MultiPut batches. Returns failed keys.
+uint64_t load(const BenchConfig& config, const std::vector<std::string>& addresses) {
+    std::atomic<uint64_t> next{0};
+    std::atomic<uint64_t> failed{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < config.threads; ++t) {
+        threads.emplace_back([&, t] {
+            auto stub = make_stub(addresses[t % addresses.size()], t);
+            std::mt19937_64 rng(t + 1);
+            const std::string value = random_value(config.value_size, rng);
+            for (uint64_t start = next.fetch_add(config.load_batch); start < config.records;
+                 start = next.fetch_add(config.load_batch)) {
+                kvstore::MultiPutRequest req;
+                kvstore::MultiPutResponse resp;
+                grpc::ClientContext ctx;
+                uint64_t end = std::min<uint64_t>(config.records, start + config.load_batch);
+                for (uint64_t i = start; i < end; ++i) {
+                    auto* entry = req.add_entries();
+                    entry->set_key(ycsb::key_name(i));
+                    entry->set_value(value);
+                }
+                if (!stub->MultiPut(&ctx, req, &resp).ok()) {
+                    failed.fetch_add(end - start);
+                    continue;
+                }
+                for (const auto& result : resp.results()) {
+                    failed.fetch_add(result.success() ? 0 : 1);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return failed.load();
+}
+
+class Client {
+public:
+    Client(const BenchConfig& config,
+           const std::string& address,
+           size_t index,
+           ycsb::ZipfianGenerator* zipfian,
+           std::atomic<uint64_t>& inserted,
+           std::atomic<uint64_t>& next_insert)
+        : config_(config),
+          stub_(make_stub(address, index)),
+          chooser_(config.workload.distribution, config.records, 0x9e3779b97f4a7c15ULL * (index + 1)),
+          inserted_(inserted),
+          next_insert_(next_insert),
+          rng_(index + 1) {
+        chooser_.set_zipfian(zipfian);
+        value_ = random_value(config.value_size, rng_);
+    }
+
+    void run_one(ThreadStats& stats) {
+        auto op = ycsb::choose_op(config_.workload, std::uniform_real_distribution<double>(0, 1)(rng_));
+        auto started = Clock::now();
+        bool ok = execute(op);
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started);
+        auto slot = static_cast<size_t>(op);
+        stats.latency_ns[slot].record(static_cast<uint64_t>(elapsed.count()));
+        stats.failures[slot] += ok ? 0 : 1;
+    }
+
+private:
+    bool read(const std::string& key) {
+        grpc::ClientContext ctx;
+        kvstore::GetRequest req;
+        kvstore::GetResponse resp;
+        req.set_key(key);
+        return stub_->Get(&ctx, req, &resp).ok();
+    }
+
+    bool write(const std::string& key) {
+        grpc::ClientContext ctx;
+        kvstore::PutRequest req;
+        kvstore::PutResponse resp;
+        req.set_key(key);
+        req.set_value(value_);
+        return stub_->Put(&ctx, req, &resp).ok() && resp.success();
+    }
+
+    bool execute(ycsb::Op op) {
+        const uint64_t inserted = inserted_.load(std::memory_order_relaxed);
+        switch (op) {
+            case ycsb::Op::Read:
+                return read(ycsb::key_name(chooser_.next(inserted)));
+            case ycsb::Op::Update:
+                return write(ycsb::key_name(chooser_.next(inserted)));
+            case ycsb::Op::ReadModifyWrite: {
+                auto key = ycsb::key_name(chooser_.next(inserted));
+                return read(key) && write(key);
+            }
+            case ycsb::Op::Insert: {
+                uint64_t index = next_insert_.fetch_add(1, std::memory_order_relaxed);
+                bool ok = write(ycsb::key_name(index));
+                // Not strictly ordered with other inserts; only feeds the
+                // "latest" chooser, which tolerates reading a missing key.
+                inserted_.fetch_add(1, std::memory_order_relaxed);
+                return ok;
+            }
+            case ycsb::Op::Scan: {
+                uint64_t start = chooser_.next(inserted);
+                std::uniform_int_distribution<uint64_t> length(1, config_.workload.max_scan_length);
+                uint64_t end = std::min(inserted, start + chooser_.draw(length));
+                grpc::ClientContext ctx;
+                kvstore::MultiGetRequest req;
+                kvstore::MultiGetResponse resp;
+                for (uint64_t i = start; i < end; ++i) {
+                    req.add_keys(ycsb::key_name(i));
+                }
+                return stub_->MultiGet(&ctx, req, &resp).ok();
+            }
+        }
+        return false;
+    }
+
+    const BenchConfig& config_;
+    std::unique_ptr<kvstore::KeyValue::Stub> stub_;
+    ycsb::KeyChooser chooser_;
+    std::atomic<uint64_t>& inserted_;
+    std::atomic<uint64_t>& next_insert_;
+    std::mt19937_64 rng_;
+    std::string value_;
+};
+
+struct RunResult {
+    ThreadStats totals;
+    double elapsed_s = 0;
+    uint64_t operations = 0;
+};
+
+RunResult run(const BenchConfig& config, const std::vector<std::string>& addresses) {
+    // Zipfian ranks are drawn over the loaded records; "latest" reuses the
+    // same table as a distance back from the newest insert.
+    ycsb::ZipfianGenerator zipfian(config.records);
+    std::atomic<uint64_t> inserted{config.records};
+    std::atomic<uint64_t> next_insert{config.records};
+    std::atomic<uint64_t> next_op{0};
+    const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                             std::chrono::duration<double>(config.duration_s));
+
+    std::vector<ThreadStats> stats(config.threads);
+    std::vector<std::thread> threads;
+    auto started = Clock::now();
+    for (size_t t = 0; t < config.threads; ++t) {
+        threads.emplace_back([&, t] {
+            Client client(config, addresses[t % addresses.size()], t, &zipfian, inserted, next_insert);
+            if (config.duration_s > 0) {
+                while (Clock::now() < deadline) {
+                    client.run_one(stats[t]);
+                }
+                return;
+            }
+            while (next_op.fetch_add(1, std::memory_order_relaxed) < config.operations) {
+                client.run_one(stats[t]);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    RunResult result;
+    result.elapsed_s = std::chrono::duration<double>(Clock::now() - started).count();
+    for (const auto& s : stats) {
+        for (size_t op = 0; op < ycsb::OP_COUNT; ++op) {
+            result.totals.latency_ns[op].merge(s.latency_ns[op]);
+            result.totals.failures[op] += s.failures[op];
+        }
+    }
+    for (const auto& h : result.totals.latency_ns) {
+        result.operations += h.count();
+    }
+    return result;
+}
+
+double us(uint64_t ns) {
+    return static_cast<double>(ns) / 1000.0;
+}
+
+void print_text(const BenchConfig& config, const RunResult& result) {
+    std::cout << std::fixed << std::setprecision(1)
+              << "[OVERALL] workload=" << config.workload.name
+              << " distribution=" << ycsb::to_string(config.workload.distribution)
+              << " threads=" << config.threads
+              << " runtime_ms=" << result.elapsed_s * 1000
+              << " operations=" << result.operations
+              << " throughput_ops_s=" << static_cast<double>(result.operations) / result.elapsed_s
+              << "\n";
+    for (size_t op = 0; op < ycsb::OP_COUNT; ++op) {
+        const auto& h = result.totals.latency_ns[op];
+        if (h.count() == 0) {
+            continue;
+        }
+        std::cout << "[" << ycsb::to_string(static_cast<ycsb::Op>(op)) << "]"
+                  << " count=" << h.count()
+                  << " failures=" << result.totals.failures[op]
+                  << " mean_us=" << us(static_cast<uint64_t>(h.mean()))
+                  << " p50_us=" << us(h.percentile(50))
+                  << " p99_us=" << us(h.percentile(99))
+                  << " p999_us=" << us(h.percentile(99.9))
+                  << " max_us=" << us(h.max()) << "\n";
+    }
+}
+
+std::string to_json(const BenchConfig& config, const RunResult& result, size_t nodes) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\n"
+        << "  \"workload\": \"" << config.workload.name << "\",\n"
+        << "  \"distribution\": \"" << ycsb::to_string(config.workload.distribution) << "\",\n"
+        << "  \"records\": " << config.records << ",\n"
+        << "  \"threads\": " << config.threads << ",\n"
+        << "  \"value_size\": " << config.value_size << ",\n"
+        << "  \"nodes\": " << nodes << ",\n"
+        << "  \"in_process\": " << (config.targets.empty() ? "true" : "false") << ",\n"
+        << "  \"runtime_s\": " << result.elapsed_s << ",\n"
+        << "  \"operations\": " << result.operations << ",\n"
+        << "  \"throughput_ops_s\": " << static_cast<double>(result.operations) / result.elapsed_s << ",\n"
+        << "  \"latency\": {";
+    bool first = true;
+    for (size_t op = 0; op < ycsb::OP_COUNT; ++op) {
+        const auto& h = result.totals.latency_ns[op];
+        if (h.count() == 0) {
+            continue;
+        }
+        out << (first ? "\n" : ",\n") << "    \"" << ycsb::to_string(static_cast<ycsb::Op>(op))
+            << "\": {\"count\": " << h.count()
+            << ", \"failures\": " << result.totals.failures[op]
+            << ", \"mean_us\": " << us(static_cast<uint64_t>(h.mean()))
+            << ", \"p50_us\": " << us(h.percentile(50))
+            << ", \"p99_us\": " << us(h.percentile(99))
+            << ", \"p999_us\": " << us(h.percentile(99.9))
+            << ", \"max_us\": " << us(h.max()) << "}";
+        first = false;
+    }
+    out << "\n  }\n}\n";
+    return out.str();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    if (auto err = parse_args(argc, argv, config)) {
+        std::cerr << "kv_bench: " << *err << "\n";
+        print_usage();
+        return 1;
+    }
+
+    std::unique_ptr<LocalCluster> cluster;
+    std::vector<std::string> addresses = config.targets;
+    if (addresses.empty()) {
+        kv::log::set_level(kv::log::LogLevel::None);
+        cluster = std::make_unique<LocalCluster>(config.nodes, config.rf,
+                                                 config.write_quorum, config.read_quorum);
+        addresses = cluster->addresses();
+    }
+
+    if (!config.skip_load) {
+        auto started = Clock::now();
+        uint64_t failed = load(config, addresses);
+        double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+        std::cout << std::fixed << std::setprecision(1)
+                  << "[LOAD] records=" << config.records << " failed=" << failed
+                  << " runtime_ms=" << elapsed * 1000
+                  << " throughput_ops_s=" << static_cast<double>(config.records) / elapsed << "\n";
+    }
+
+    auto result = run(config, addresses);
+    print_text(config, result);
+
+    if (!config.json_path.empty()) {
+        auto json = to_json(config, result, addresses.size());
+        if (config.json_path == "-") {
+            std::cout << json;
+        } else {
+            std::ofstream file(config.json_path);
+            file << json;
+            if (!file) {
+                std::cerr << "kv_bench: cannot write " << config.json_path << "\n";
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
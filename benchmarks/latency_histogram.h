@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// HDR-style latency histogram: values below 128 are counted exactly, larger
+// ones in log-linear buckets of 64 sub-buckets each, so every recorded value
+// is kept to within 1/64 (~1.6%) of its magnitude across the full uint64
+// range in a fixed ~30 KiB of counters. One per client thread; merge() them
+// for the report.
+class LatencyHistogram {
+public:
+    LatencyHistogram() : counts_(index_of(UINT64_MAX) + 1, 0) {}
+
+    void record(uint64_t value) {
+        counts_[index_of(value)]++;
+        count_++;
+        sum_ += static_cast<double>(value);
+        max_ = std::max(max_, value);
+        min_ = std::min(min_, value);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+        min_ = std::min(min_, other.min_);
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t max() const { return count_ ? max_ : 0; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    double mean() const { return count_ ? sum_ / static_cast<double>(count_) : 0.0; }
+
+    // Smallest recorded bucket value such that at least `percentile`% of
+    // samples are <= it (reported as the bucket's upper bound, capped at max).
+    uint64_t percentile(double percentile) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        auto target = static_cast<uint64_t>(
+            std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(count_)));
+        target = std::max<uint64_t>(target, 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= target) {
+                return std::min(upper_bound_of(i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static constexpr int SUB_BITS = 7;
+    static constexpr uint64_t SUB_COUNT = uint64_t{1} << SUB_BITS;  // exact range
+    static constexpr uint64_t HALF = SUB_COUNT / 2;                 // sub-buckets per bucket
+
+    static size_t index_of(uint64_t value) {
+        if (value < SUB_COUNT) {
+            return static_cast<size_t>(value);
+        }
+        // Shift so the top SUB_BITS bits remain: value >> shift is in [HALF, SUB_COUNT).
+        const int shift = static_cast<int>(std::bit_width(value)) - SUB_BITS;
+        return static_cast<size_t>(SUB_COUNT + static_cast<uint64_t>(shift - 1) * HALF +
+                                   ((value >> shift) - HALF));
+    }
+
+    static uint64_t upper_bound_of(size_t index) {
+        if (index < SUB_COUNT) {
+            return index;
+        }
+        const uint64_t k = index - SUB_COUNT;
+        const auto shift = static_cast<int>(k / HALF + 1);
+        const uint64_t sub = k % HALF + HALF;
+        return (sub << shift) + ((uint64_t{1} << shift) - 1);
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    double sum_ = 0;
+    uint64_t max_ = 0;
+    uint64_t min_ = UINT64_MAX;
+};
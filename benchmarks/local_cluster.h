@@ -0,0 +1,63 @@
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cluster/cluster_view.h"
+#include "node/node.h"
+#include "node/node_config.h"
+#include "node/node_rpc_service.h"
+
+// N real gRPC nodes in one process on ephemeral loopback ports, sharing one
+// ClusterView (the benchmark counterpart of the integration tests'
+// ClusterFixture). Clients reach them through addresses().
+class LocalCluster {
+public:
+    LocalCluster(size_t nodes, size_t rf, int write_quorum, int read_quorum) {
+        for (size_t i = 0; i < nodes; ++i) {
+            auto inst = std::make_unique<Instance>();
+            kv::NodeConfig cfg;
+            cfg.node_id = "n" + std::to_string(i + 1);
+            cfg.port = 1;  // placeholder; the server binds an ephemeral port
+            cfg.replication_factor = rf;
+            cfg.write_quorum = write_quorum;
+            cfg.read_quorum = read_quorum;
+            inst->node = std::make_unique<kv::node::Node>(cfg, view_);
+            inst->service = std::make_unique<kv::NodeRpcService>(*inst->node);
+
+            int port = 0;
+            grpc::ServerBuilder builder;
+            builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(), &port);
+            builder.RegisterService(inst->service.get());
+            inst->server = builder.BuildAndStart();
+            addresses_.push_back("localhost:" + std::to_string(port));
+            view_.add_node_to_cluster(cfg.node_id, addresses_.back());
+            instances_.push_back(std::move(inst));
+        }
+    }
+
+    ~LocalCluster() {
+        for (auto& inst : instances_) {
+            inst->server->Shutdown();
+        }
+    }
+
+    LocalCluster(const LocalCluster&) = delete;
+    LocalCluster& operator=(const LocalCluster&) = delete;
+
+    const std::vector<std::string>& addresses() const { return addresses_; }
+
+private:
+    struct Instance {
+        std::unique_ptr<kv::node::Node> node;
+        std::unique_ptr<kv::NodeRpcService> service;
+        std::unique_ptr<grpc::Server> server;
+    };
+
+    kv::cluster::ClusterView view_{100};
+    std::vector<std::unique_ptr<Instance>> instances_;
+    std::vector<std::string> addresses_;
+};
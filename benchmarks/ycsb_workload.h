@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "hash/murmur3.h"
+
+/*
+- YCSB core workloads A-F, key choosers and key naming for kv_bench.
+- Zipfian follows YCSB's ZipfianGenerator (Gray et al., "Quickly generating
+  billion-record synthetic databases"); "zipfian" keys are scrambled by
+  hashing so hot keys spread over the ring instead of clustering at the low
+  indexes.
+*/
+namespace ycsb {
+
+enum class Op { Read, Update, Insert, Scan, ReadModifyWrite };
+inline constexpr size_t OP_COUNT = 5;
+
+inline const char* to_string(Op op) {
+    switch (op) {
+        case Op::Read: return "read";
+        case Op::Update: return "update";
+        case Op::Insert: return "insert";
+        case Op::Scan: return "scan";
+        case Op::ReadModifyWrite: return "read_modify_write";
+    }
+    return "unknown";
+}
+
+enum class Distribution { Uniform, Zipfian, Latest };
+
+inline std::optional<Distribution> parse_distribution(std::string_view value) {
+    if (value == "uniform") return Distribution::Uniform;
+    if (value == "zipfian") return Distribution::Zipfian;
+    if (value == "latest") return Distribution::Latest;
+    return std::nullopt;
+}
+
+inline const char* to_string(Distribution distribution) {
+    switch (distribution) {
+        case Distribution::Uniform: return "uniform";
+        case Distribution::Zipfian: return "zipfian";
+        case Distribution::Latest: return "latest";
+    }
+    return "unknown";
+}
+
+// Operation mix; proportions are normalized when an operation is chosen.
+struct Workload {
+    char name = 'A';
+    double read = 0;
+    double update = 0;
+    double insert = 0;
+    double scan = 0;
+    double read_modify_write = 0;
+    Distribution distribution = Distribution::Zipfian;
+    size_t max_scan_length = 100;
+};
+
+// A: update heavy, B: read mostly, C: read only, D: read latest,
+// E: short ranges, F: read-modify-write.
+inline std::optional<Workload> core_workload(char name) {
+    Workload w;
+    w.name = name;
+    switch (name) {
+        case 'A': w.read = 0.5; w.update = 0.5; break;
+        case 'B': w.read = 0.95; w.update = 0.05; break;
+        case 'C': w.read = 1.0; break;
+        case 'D': w.read = 0.95; w.insert = 0.05; w.distribution = Distribution::Latest; break;
+        case 'E': w.scan = 0.95; w.insert = 0.05; break;
+        case 'F': w.read = 0.5; w.read_modify_write = 0.5; break;
+        default: return std::nullopt;
+    }
+    return w;
+}
+
+inline Op choose_op(const Workload& w, double u) {
+    const double total = w.read + w.update + w.insert + w.scan + w.read_modify_write;
+    double x = u * total;
+    if ((x -= w.read) < 0) return Op::Read;
+    if ((x -= w.update) < 0) return Op::Update;
+    if ((x -= w.insert) < 0) return Op::Insert;
+    if ((x -= w.scan) < 0) return Op::Scan;
+    return Op::ReadModifyWrite;
+}
+
+// Draws integers in [0, items) with P(i) proportional to 1 / (i+1)^theta.
+// Construction is O(items) (zeta); next() is O(1).
+class ZipfianGenerator {
+public:
+    explicit ZipfianGenerator(uint64_t items, double theta = 0.99)
+        : items_(std::max<uint64_t>(items, 1)),
+          theta_(theta),
+          alpha_(1.0 / (1.0 - theta)),
+          zeta2_(zeta(2, theta)),
+          zetan_(zeta(items_, theta)),
+          eta_((1.0 - std::pow(2.0 / static_cast<double>(items_), 1.0 - theta)) /
+               (1.0 - zeta2_ / zetan_)) {}
+
+    template <typename Rng>
+    uint64_t next(Rng& rng) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * zetan_;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < 1.0 + std::pow(0.5, theta_)) {
+            return std::min<uint64_t>(1, items_ - 1);
+        }
+        auto v = static_cast<uint64_t>(static_cast<double>(items_) *
+                                       std::pow(eta_ * u - eta_ + 1.0, alpha_));
+        return std::min(v, items_ - 1);
+    }
+
+private:
+    static double zeta(uint64_t n, double theta) {
+        double sum = 0;
+        for (uint64_t i = 1; i <= n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        return sum;
+    }
+
+    uint64_t items_;
+    double theta_;
+    double alpha_;
+    double zeta2_;
+    double zetan_;
+    double eta_;
+};
+
+// Picks record indexes for one client thread. `inserted` is the shared count
+// of records loaded or inserted so far; "latest" favours the newest of them.
+class KeyChooser {
+public:
+    KeyChooser(Distribution distribution, uint64_t records, uint64_t seed)
+        : distribution_(distribution), records_(std::max<uint64_t>(records, 1)), rng_(seed) {}
+
+    // The zipfian table is shared between threads; build it once and pass it in.
+    void set_zipfian(ZipfianGenerator* zipfian) { zipfian_ = zipfian; }
+
+    uint64_t next(uint64_t inserted) {
+        inserted = std::max<uint64_t>(inserted, 1);
+        switch (distribution_) {
+            case Distribution::Uniform:
+                return std::uniform_int_distribution<uint64_t>(0, inserted - 1)(rng_);
+            case Distribution::Zipfian: {
+                uint64_t rank = zipfian_->next(rng_);
+                uint64_t h = kv::hash::murmur3_64(&rank, sizeof(rank), 0x5c4a3b2d);
+                return h % std::min(records_, inserted);
+            }
+            case Distribution::Latest: {
+                uint64_t back = zipfian_->next(rng_);
+                return back < inserted ? inserted - 1 - back : inserted - 1;
+            }
+        }
+        return 0;
+    }
+
+    template <typename Dist>
+    auto draw(Dist& dist) { return dist(rng_); }
+
+private:
+    Distribution distribution_;
+    uint64_t records_;
+    std::mt19937_64 rng_;
+    ZipfianGenerator* zipfian_ = nullptr;
+};
+
+inline std::string key_name(uint64_t index) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "user%012llu", static_cast<unsigned long long>(index));
+    return buf;
+}
+
+}  // namespace ycsb
@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 #include <grpcpp/grpcpp.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <thread>
 #include <vector>
@@ -12,6 +16,8 @@
 #include "node/node_config.h"
 #include "node/node_rpc_service.h"
 
+using kv::AsyncNodeServer;
+using kv::AsyncServerOptions;
 using kv::NodeConfig;
 using kv::NodeRpcService;
 using kv::cluster::ClusterView;
@@ -26,17 +32,88 @@ using kv::node::Version;
 //
 // kill(i)   — shuts down node i's server but keeps it in the ClusterView,
 //             simulating a crash (RPCs to it will fail with UNAVAILABLE).
+//
+// With `async` options set, nodes are served by AsyncNodeServer instead of
+// the synchronous NodeRpcService.
 // ---------------------------------------------------------------------------
 namespace {
 
+// NodeRpcService that can delay every internal (replica) request, to play a
+// slow or hung peer.
+class DelayingService final : public kvstore::KeyValue::Service {
+public:
+    explicit DelayingService(Node& node) : inner_(node) {}
+
+    std::atomic<int> internal_delay_ms{0};
+    std::atomic<bool> refuse_internal{false};  // replica RPCs fail with UNAVAILABLE
+
+    grpc::Status Get(grpc::ServerContext* ctx, const kvstore::GetRequest* req,
+                     kvstore::GetResponse* resp) override {
+        if (refused(req->is_internal())) {
+            return grpc::Status(grpc::StatusCode::UNAVAILABLE, "refused");
+        }
+        delay(req->is_internal());
+        return inner_.Get(ctx, req, resp);
+    }
+    grpc::Status Put(grpc::ServerContext* ctx, const kvstore::PutRequest* req,
+                     kvstore::PutResponse* resp) override {
+        if (refused(req->is_internal())) {
+            return grpc::Status(grpc::StatusCode::UNAVAILABLE, "refused");
+        }
+        delay(req->is_internal());
+        return inner_.Put(ctx, req, resp);
+    }
+    grpc::Status MultiGet(grpc::ServerContext* ctx, const kvstore::MultiGetRequest* req,
+                          kvstore::MultiGetResponse* resp) override {
+        if (refused(req->is_internal())) {
+            return grpc::Status(grpc::StatusCode::UNAVAILABLE, "refused");
+        }
+        delay(req->is_internal());
+        return inner_.MultiGet(ctx, req, resp);
+    }
+    grpc::Status MultiPut(grpc::ServerContext* ctx, const kvstore::MultiPutRequest* req,
+                          kvstore::MultiPutResponse* resp) override {
+        if (refused(req->is_internal())) {
+            return grpc::Status(grpc::StatusCode::UNAVAILABLE, "refused");
+        }
+        delay(req->is_internal());
+        return inner_.MultiPut(ctx, req, resp);
+    }
+    // Heartbeats are not delayed: a slow replica is still alive.
+    grpc::Status Ping(grpc::ServerContext* ctx, const kvstore::PingRequest* req,
+                      kvstore::PingResponse* resp) override {
+        return inner_.Ping(ctx, req, resp);
+    }
+    grpc::Status MerkleLevel(grpc::ServerContext* ctx, const kvstore::MerkleLevelRequest* req,
+                             kvstore::MerkleLevelResponse* resp) override {
+        if (refused(true)) {
+            return grpc::Status(grpc::StatusCode::UNAVAILABLE, "refused");
+        }
+        return inner_.MerkleLevel(ctx, req, resp);
+    }
+
+private:
+    bool refused(bool internal) const { return internal && refuse_internal.load(); }
+
+    void delay(bool internal) {
+        int ms = internal_delay_ms.load();
+        if (internal && ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        }
+    }
+
+    NodeRpcService inner_;
+};
+
 struct ClusterFixture {
     ClusterView view{100};
 
     struct Instance {
         std::string id;
         std::unique_ptr<Node> node;
-        std::unique_ptr<NodeRpcService> service;
+        std::unique_ptr<DelayingService> service;
         std::unique_ptr<grpc::Server> server;
+        std::unique_ptr<AsyncNodeServer> async_server;
         int port{0};
         bool alive{true};
     };
@@ -44,8 +121,12 @@ struct ClusterFixture {
     std::vector<std::unique_ptr<Instance>> instances;
     size_t rf_;
     int wq_;
+    int rq_;
+    std::optional<AsyncServerOptions> async;
+    std::function<void(NodeConfig&)> configure;  // applied to every node's config
 
-    explicit ClusterFixture(size_t rf = 3, int wq = 1) : rf_(rf), wq_(wq) {}
+    explicit ClusterFixture(size_t rf = 3, int wq = 1, int rq = 1)
+        : rf_(rf), wq_(wq), rq_(rq) {}
 
     ~ClusterFixture() {
         auto deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(300);
@@ -64,9 +145,21 @@ struct ClusterFixture {
         cfg.port = 1;  // placeholder — not used for binding
         cfg.replication_factor = rf_;
         cfg.write_quorum = wq_;
+        cfg.read_quorum = rq_;
+        if (configure) {
+            configure(cfg);
+        }
 
         inst->node = std::make_unique<Node>(cfg, view);
-        inst->service = std::make_unique<NodeRpcService>(*inst->node);
+        if (async) {
+            inst->async_server = std::make_unique<AsyncNodeServer>(
+                *inst->node, "localhost:0", *async);
+            inst->port = inst->async_server->port();
+            view.add_node_to_cluster(id, "localhost:" + std::to_string(inst->port));
+            instances.push_back(std::move(inst));
+            return;
+        }
+        inst->service = std::make_unique<DelayingService>(*inst->node);
 
         grpc::ServerBuilder builder;
         builder.AddListeningPort(
@@ -91,9 +184,20 @@ struct ClusterFixture {
 
     Node& node(size_t i) { return *instances[i]->node; }
 
+    std::unique_ptr<kvstore::KeyValue::Stub> client(size_t i) {
+        return kvstore::KeyValue::NewStub(grpc::CreateChannel(
+            "localhost:" + std::to_string(instances[i]->port),
+            grpc::InsecureChannelCredentials()));
+    }
+
     // Crash node i: server stops, but it stays in the ClusterView so routing
     // still targets it and forwarding RPCs will fail with UNAVAILABLE.
     void kill(size_t i) {
+        if (instances[i]->async_server) {
+            instances[i]->async_server->shutdown();
+            instances[i]->alive = false;
+            return;
+        }
         instances[i]->server->Shutdown(
             std::chrono::system_clock::now() + std::chrono::milliseconds(100)
         );
@@ -130,9 +234,10 @@ TEST(ClusterIntegration, ForwardingReplicatesValueToAllNodes) {
 //   2. Remove n3 from the cluster view so the next write doesn't reach it.
 //   3. Write "v2" — only n1 and n2 receive it; n3 keeps "v1".
 //   4. Re-add n3 to the view so the coordinator queries it again.
-//   5. GET must return "v2" (LWW winner) and repair n3 synchronously.
+//   5. GET must return "v2" (LWW winner) and queue a repair for n3.
+// R=3 so the coordinator waits for n3's stale reply before returning.
 TEST(ClusterIntegration, ReadRepairFixesStalReplica) {
-    ClusterFixture f(3, 1);
+    ClusterFixture f(3, 1, 3);
     f.start(3);
     f.node(0).set_early_write_return(false);
 
@@ -157,7 +262,8 @@ TEST(ClusterIntegration, ReadRepairFixesStalReplica) {
     ASSERT_TRUE(result.has_value());
     EXPECT_EQ(result->value, "v2");
 
-    // Read repair is synchronous — n3 must be patched before get() returned.
+    // Read repair runs on the coordinator's background repair queue.
+    f.node(0).wait_for_read_repairs();
     auto repaired = f.node(2).local_get("foo");
     ASSERT_TRUE(repaired.has_value());
     EXPECT_EQ(repaired->value, "v2");
@@ -190,7 +296,7 @@ TEST(ClusterIntegration, ForwardFailureCountIncrementsOnDeadReplicas) {
     f.kill(2);
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
 
-    // Disable early write return so put() joins all worker threads and the
+    // Disable early write return so put() waits for every replica RPC and the
     // failure counters are guaranteed to be updated before we read them.
     f.node(0).set_early_write_return(false);
     EXPECT_TRUE(f.node(0).put("k", "v"));  // W=1, local ack is enough
@@ -233,3 +339,531 @@ TEST(ClusterIntegration, AnyNodeCanCoordinateGet) {
         EXPECT_EQ(result->value, "v") << "n" << (i + 1) << " returned wrong value";
     }
 }
+
+// With early write return (the default) and W=1, put() returns once the
+// local replica has acked. The remaining replica writes keep running in the
+// background and must still land on every replica.
+TEST(ClusterIntegration, EarlyWriteReturnStragglersStillReplicate) {
+    ClusterFixture f(3, 1);
+    f.start(3);
+
+    ASSERT_TRUE(f.node(0).put("k", "v"));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    for (size_t i = 0; i < 3; ++i) {
+        std::optional<kv::node::StoreEntry> entry;
+        while (!(entry = f.node(i).local_get("k")) &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        ASSERT_TRUE(entry.has_value()) << "n" << (i + 1) << " never received the write";
+        EXPECT_EQ(entry->value, "v");
+    }
+}
+
+// With R=1 a GET is answered by the first replica to reply. A dead replica in
+// the preference list must not hold the read up: the coordinator still
+// answers from the surviving replicas.
+TEST(ClusterIntegration, ReadQuorumSkipsDeadReplica) {
+    ClusterFixture f(3, 1, 1);
+    f.start(3);
+    f.node(0).set_early_write_return(false);
+
+    ASSERT_TRUE(f.node(0).put("k", "v"));
+
+    f.kill(2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    for (size_t i = 0; i < 2; ++i) {
+        auto result = f.node(i).get("k");
+        ASSERT_TRUE(result.has_value()) << "n" << (i + 1) << " GET returned nullopt";
+        EXPECT_EQ(result->value, "v");
+    }
+}
+
+// With R=1 the coordinator answers from its own up-to-date replica before the
+// stale replica replies. The late reply must still trigger a background repair.
+TEST(ClusterIntegration, LateStaleReplyIsRepairedInBackground) {
+    ClusterFixture f(3, 1, 1);
+    f.start(3);
+    f.node(0).set_early_write_return(false);
+
+    ASSERT_TRUE(f.node(0).put("foo", "v1"));
+
+    f.view.remove_node_from_cluster("n3");
+    ASSERT_TRUE(f.node(0).put("foo", "v2"));
+    std::string n3_addr = "localhost:" + std::to_string(f.instances[2]->port);
+    f.view.add_node_to_cluster("n3", n3_addr);
+
+    auto result = f.node(0).get("foo");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->value, "v2");
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    std::optional<kv::node::StoreEntry> entry;
+    while (std::chrono::steady_clock::now() < deadline) {
+        entry = f.node(2).local_get("foo");
+        if (entry && entry->value == "v2") break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->value, "v2");
+}
+
+// MultiPut groups keys by preference list. With RF=2 on 4 nodes each key
+// lands on exactly its two replicas, and MultiGet from any coordinator
+// returns every value in request order.
+TEST(ClusterIntegration, MultiPutAndMultiGetRouteKeysToTheirReplicas) {
+    ClusterFixture f(2, 2, 2);
+    f.start(4);
+    f.node(0).set_early_write_return(false);
+
+    std::vector<std::pair<std::string, std::string>> items;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 50; ++i) {
+        keys.push_back("key_" + std::to_string(i));
+        items.emplace_back(keys.back(), "value_" + std::to_string(i));
+    }
+    auto acks = f.node(0).multi_put(items);
+    ASSERT_EQ(acks.size(), items.size());
+    for (size_t i = 0; i < acks.size(); ++i) {
+        EXPECT_TRUE(acks[i]) << keys[i];
+    }
+
+    for (const auto& key : keys) {
+        auto replicas = f.view.get_replica_set_for_key(key, 2);
+        for (size_t n = 0; n < 4; ++n) {
+            bool owner = std::find(replicas.begin(), replicas.end(),
+                                   f.instances[n]->id) != replicas.end();
+            EXPECT_EQ(f.node(n).local_get(key).has_value(), owner)
+                << key << " on " << f.instances[n]->id;
+        }
+    }
+
+    keys.push_back("missing");
+    auto values = f.node(3).multi_get(keys);
+    ASSERT_EQ(values.size(), keys.size());
+    for (size_t i = 0; i + 1 < keys.size(); ++i) {
+        ASSERT_TRUE(values[i].has_value()) << keys[i];
+        EXPECT_EQ(values[i]->value, items[i].second);
+    }
+    EXPECT_FALSE(values.back().has_value());
+}
+
+// Status is per key: with W=2 and one replica down, only keys whose
+// preference list avoids the dead node are acknowledged.
+TEST(ClusterIntegration, MultiPutReportsPerKeyQuorumFailures) {
+    ClusterFixture f(2, 2);
+    f.start(3);
+
+    f.kill(2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<std::pair<std::string, std::string>> items;
+    for (int i = 0; i < 30; ++i) {
+        items.emplace_back("key_" + std::to_string(i), "v");
+    }
+    auto acks = f.node(0).multi_put(items);
+    ASSERT_EQ(acks.size(), items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        auto replicas = f.view.get_replica_set_for_key(items[i].first, 2);
+        bool touches_dead = std::find(replicas.begin(), replicas.end(), "n3") != replicas.end();
+        EXPECT_EQ(acks[i], !touches_dead) << items[i].first;
+    }
+}
+
+// Client RPCs through the completion-queue server behave like the sync
+// service: a Put reaches every replica and Get/MultiGet see it from any node.
+TEST(ClusterIntegration, AsyncServerServesClientRequests) {
+    ClusterFixture f(3, 2, 2);
+    f.async = AsyncServerOptions{1, 2};
+    f.start(3);
+    f.node(0).set_early_write_return(false);
+
+    auto stub = f.client(0);
+    {
+        grpc::ClientContext ctx;
+        kvstore::PutRequest req;
+        kvstore::PutResponse resp;
+        req.set_key("key");
+        req.set_value("value");
+        ASSERT_TRUE(stub->Put(&ctx, req, &resp).ok());
+        EXPECT_TRUE(resp.success());
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        auto entry = f.node(i).local_get("key");
+        ASSERT_TRUE(entry.has_value()) << "n" << (i + 1);
+        EXPECT_EQ(entry->value, "value");
+    }
+    {
+        grpc::ClientContext ctx;
+        kvstore::GetRequest req;
+        kvstore::GetResponse resp;
+        req.set_key("key");
+        ASSERT_TRUE(f.client(2)->Get(&ctx, req, &resp).ok());
+        ASSERT_TRUE(resp.found());
+        EXPECT_EQ(resp.value(), "value");
+        EXPECT_EQ(resp.version().writer_id(), "n1");
+    }
+    {
+        grpc::ClientContext ctx;
+        kvstore::MultiPutRequest req;
+        kvstore::MultiPutResponse resp;
+        for (int i = 0; i < 20; ++i) {
+            auto* entry = req.add_entries();
+            entry->set_key("multi_" + std::to_string(i));
+            entry->set_value("v" + std::to_string(i));
+        }
+        ASSERT_TRUE(stub->MultiPut(&ctx, req, &resp).ok());
+        ASSERT_EQ(resp.results_size(), 20);
+        for (const auto& result : resp.results()) {
+            EXPECT_TRUE(result.success());
+        }
+    }
+    {
+        grpc::ClientContext ctx;
+        kvstore::MultiGetRequest req;
+        kvstore::MultiGetResponse resp;
+        for (int i = 0; i < 20; ++i) {
+            req.add_keys("multi_" + std::to_string(i));
+        }
+        req.add_keys("missing");
+        ASSERT_TRUE(f.client(1)->MultiGet(&ctx, req, &resp).ok());
+        ASSERT_EQ(resp.results_size(), 21);
+        for (int i = 0; i < 20; ++i) {
+            ASSERT_TRUE(resp.results(i).found()) << i;
+            EXPECT_EQ(resp.results(i).value(), "v" + std::to_string(i));
+        }
+        EXPECT_FALSE(resp.results(20).found());
+    }
+}
+
+// One queue thread per node, yet hundreds of client requests are in flight
+// at once: coordinators park on replica replies instead of on the thread.
+TEST(ClusterIntegration, AsyncServerHoldsManyConcurrentClientRequests) {
+    ClusterFixture f(3, 2, 2);
+    f.async = AsyncServerOptions{1, 1};
+    f.start(3);
+
+    constexpr int kRequests = 300;
+    auto stub = f.client(0);
+    grpc::CompletionQueue cq;
+
+    struct Call {
+        grpc::ClientContext ctx;
+        kvstore::PutResponse resp;
+        grpc::Status status;
+        std::unique_ptr<grpc::ClientAsyncResponseReader<kvstore::PutResponse>> reader;
+    };
+    std::vector<std::unique_ptr<Call>> calls;
+    for (int i = 0; i < kRequests; ++i) {
+        auto call = std::make_unique<Call>();
+        kvstore::PutRequest req;
+        req.set_key("concurrent_" + std::to_string(i));
+        req.set_value("v" + std::to_string(i));
+        call->reader = stub->AsyncPut(&call->ctx, req, &cq);
+        call->reader->Finish(&call->resp, &call->status, call.get());
+        calls.push_back(std::move(call));
+    }
+
+    int done = 0;
+    void* tag = nullptr;
+    bool ok = false;
+    while (done < kRequests && cq.Next(&tag, &ok)) {
+        auto* call = static_cast<Call*>(tag);
+        EXPECT_TRUE(ok);
+        EXPECT_TRUE(call->status.ok()) << call->status.error_message();
+        EXPECT_TRUE(call->resp.success());
+        done++;
+    }
+    EXPECT_EQ(done, kRequests);
+    cq.Shutdown();
+    while (cq.Next(&tag, &ok)) {}
+
+    for (int i = 0; i < kRequests; i += 37) {
+        auto entry = f.node(1).get("concurrent_" + std::to_string(i));
+        ASSERT_TRUE(entry.has_value()) << i;
+        EXPECT_EQ(entry->value, "v" + std::to_string(i));
+    }
+}
+
+// A second shutdown() is a no-op and wait() returns once the first finished.
+TEST(ClusterIntegration, AsyncServerShutdownIsIdempotent) {
+    ClusterFixture f(1, 1, 1);
+    f.async = AsyncServerOptions{2, 2};
+    f.start(1);
+    ASSERT_TRUE(f.node(0).put("k", "v"));
+
+    f.kill(0);
+    f.instances[0]->async_server->shutdown();
+    f.instances[0]->async_server->wait();
+    EXPECT_EQ(f.instances[0]->async_server->inflight(), 0u);
+}
+
+// With read hedging a GET contacts one replica (R=1); when that replica is
+// slow, the hedge to the next one in the preference list answers first.
+TEST(ClusterIntegration, HedgedReadAvoidsSlowReplica) {
+    ClusterFixture f(2, 2, 1);
+    f.configure = [](NodeConfig& cfg) {
+        cfg.read_hedging = true;
+        cfg.hedge_delay_ms = 5;
+        cfg.hedge_budget_percent = 100;
+    };
+    f.start(3);
+
+    // A key n1 coordinates but does not store.
+    std::string key;
+    std::vector<std::string> replicas;
+    for (int i = 0; i < 100; ++i) {
+        key = "hedge_" + std::to_string(i);
+        replicas = f.view.get_replica_set_for_key(key, 2);
+        if (std::find(replicas.begin(), replicas.end(), "n1") == replicas.end()) break;
+    }
+    ASSERT_EQ(std::find(replicas.begin(), replicas.end(), "n1"), replicas.end());
+    f.node(0).set_early_write_return(false);
+    ASSERT_TRUE(f.node(0).put(key, "v"));
+
+    const size_t slow = replicas[0] == "n2" ? 1 : 2;
+    f.instances[slow]->service->internal_delay_ms = 40;
+
+    auto before = f.node(0).metrics();
+    auto start = std::chrono::steady_clock::now();
+    auto result = f.node(0).get(key);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto after = f.node(0).metrics();
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->value, "v");
+    EXPECT_EQ(after.hedged_reads - before.hedged_reads, 1u);
+    EXPECT_EQ(after.hedged_reads_won - before.hedged_reads_won, 1u);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(40));
+}
+
+// A hedged-mode read whose only contacted replica is down moves on to the
+// next replica at once, without spending hedge budget.
+TEST(ClusterIntegration, HedgedReadReplacesFailedReplica) {
+    ClusterFixture f(2, 2, 1);
+    f.configure = [](NodeConfig& cfg) {
+        cfg.read_hedging = true;
+        cfg.hedge_delay_ms = 1000;
+        cfg.hedge_budget_percent = 0;
+    };
+    f.start(3);
+
+    std::string key;
+    std::vector<std::string> replicas;
+    for (int i = 0; i < 100; ++i) {
+        key = "retry_" + std::to_string(i);
+        replicas = f.view.get_replica_set_for_key(key, 2);
+        if (std::find(replicas.begin(), replicas.end(), "n1") == replicas.end()) break;
+    }
+    ASSERT_EQ(std::find(replicas.begin(), replicas.end(), "n1"), replicas.end());
+    f.node(0).set_early_write_return(false);
+    ASSERT_TRUE(f.node(0).put(key, "v"));
+
+    f.kill(replicas[0] == "n2" ? 1 : 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = f.node(0).get(key);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->value, "v");
+    EXPECT_EQ(f.node(0).metrics().hedged_reads, 0u);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(500));
+}
+
+// A replica that accepts a write but never answers used to hold put() (with
+// early return off) until it did; the write deadline now cuts it loose.
+TEST(ClusterIntegration, HungReplicaCannotStallAWrite) {
+    ClusterFixture f(3, 1, 1);
+    f.configure = [](NodeConfig& cfg) {
+        cfg.replica_timeout_max_ms = 100;
+    };
+    f.start(3);
+    f.node(0).set_early_write_return(false);
+    f.instances[1]->service->internal_delay_ms = 500;
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(f.node(0).put("hung_key", "v"));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    f.instances[1]->service->internal_delay_ms = 0;
+
+    EXPECT_LT(elapsed, std::chrono::milliseconds(400));
+    EXPECT_GE(f.node(0).metrics().replica_timeouts, 1u);
+}
+
+// Once a replica has latency history, reads go to the faster one first and
+// each peer's deadline follows its own p99.
+TEST(ClusterIntegration, ReadsPreferTheFasterReplicaAndDeadlinesFollowLatency) {
+    ClusterFixture f(2, 2, 1);
+    f.configure = [](NodeConfig& cfg) {
+        cfg.read_hedging = true;  // contact one replica at a time...
+        cfg.hedge_budget_percent = 0;  // ...and never hedge
+        cfg.replica_timeout_ms = 200;
+    };
+    f.start(3);
+
+    std::string key;
+    std::vector<std::string> replicas;
+    for (int i = 0; i < 100; ++i) {
+        key = "order_" + std::to_string(i);
+        replicas = f.view.get_replica_set_for_key(key, 2);
+        if (std::find(replicas.begin(), replicas.end(), "n1") == replicas.end()) break;
+    }
+    ASSERT_EQ(std::find(replicas.begin(), replicas.end(), "n1"), replicas.end());
+    f.node(0).set_early_write_return(false);
+    ASSERT_TRUE(f.node(0).put(key, "v"));
+
+    const size_t slow = replicas[0] == "n2" ? 1 : 2;
+    f.instances[slow]->service->internal_delay_ms = 20;
+
+    // The preferred replica is read until it has enough history, then the
+    // other one, still unknown, is sampled and turns out faster.
+    for (int i = 0; i < 40; ++i) {
+        ASSERT_TRUE(f.node(0).get(key).has_value());
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto result = f.node(0).get(key);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_TRUE(result.has_value());
+    EXPECT_LT(elapsed, std::chrono::milliseconds(20));
+
+    auto metrics = f.node(0).metrics();
+    ASSERT_EQ(metrics.peers.size(), 2u);
+    const auto& slow_peer = metrics.peers[0].node_id == replicas[0] ? metrics.peers[0] : metrics.peers[1];
+    const auto& fast_peer = metrics.peers[0].node_id == replicas[0] ? metrics.peers[1] : metrics.peers[0];
+    EXPECT_GE(slow_peer.p50, std::chrono::milliseconds(20));
+    EXPECT_GE(slow_peer.read_timeout, std::chrono::milliseconds(60));
+    EXPECT_LT(fast_peer.p99, std::chrono::milliseconds(20));
+    EXPECT_LT(fast_peer.read_timeout, slow_peer.read_timeout);
+    EXPECT_EQ(metrics.replica_timeouts, 0u);
+}
+
+// Once the failure detector has a crashed replica down, coordinators stop
+// calling it: replica RPCs to it fail at once and are counted as skips.
+TEST(ClusterIntegration, DeadReplicaIsSkippedOnceDetected) {
+    ClusterFixture f(3, 1, 1);
+    f.configure = [](NodeConfig& cfg) {
+        cfg.heartbeat_interval_ms = 20;
+    };
+    f.start(3);
+    ASSERT_TRUE(f.node(0).put("k", "v"));
+
+    f.kill(2);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (f.node(0).metrics().down_peers != std::vector<std::string>{"n3"} &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(f.node(0).metrics().down_peers, std::vector<std::string>{"n3"});
+
+    auto before = f.node(0).metrics();
+    f.node(0).set_early_write_return(false);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(f.node(0).put("k", "v2"));  // RF=3: n3 is a replica of every key
+    auto result = f.node(0).get("k");
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto after = f.node(0).metrics();
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->value, "v2");
+    EXPECT_EQ(after.peer_skips - before.peer_skips, 2u);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(200));
+}
+
+// RF=2, W=2 on three nodes: while one replica refuses writes, the third node
+// takes the write as a hint, the PUT still meets W, and the hint reaches the
+// replica once it accepts writes again.
+TEST(ClusterIntegration, SloppyQuorumHandsOffHintsToTheReplica) {
+    ClusterFixture f(2, 2, 1);
+    f.configure = [](NodeConfig& cfg) {
+        cfg.handoff_interval_ms = 20;
+    };
+    f.start(3);
+    f.node(0).set_early_write_return(false);
+
+    // A key n1 and n2 own, so n3 is the fallback.
+    std::string key;
+    for (int i = 0; key.empty(); ++i) {
+        std::string candidate = "k" + std::to_string(i);
+        auto replicas = f.view.get_replica_set_for_key(candidate, 2);
+        if (replicas == std::vector<std::string>{"n1", "n2"}) {
+            key = candidate;
+        }
+    }
+
+    f.instances[1]->service->refuse_internal = true;
+    ASSERT_TRUE(f.node(0).put(key, "v"));
+    EXPECT_EQ(f.node(0).metrics().hinted_writes, 1u);
+    EXPECT_EQ(f.node(2).metrics().hints_pending, 1u);
+    EXPECT_FALSE(f.node(1).local_get(key).has_value());
+    EXPECT_FALSE(f.node(2).local_get(key).has_value());  // held, not applied
+
+    f.instances[1]->service->refuse_internal = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (!f.node(1).local_get(key) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    auto delivered = f.node(1).local_get(key);
+    ASSERT_TRUE(delivered.has_value());
+    EXPECT_EQ(delivered->value, "v");
+    EXPECT_EQ(f.node(2).metrics().hints_pending, 0u);
+    EXPECT_EQ(f.node(2).metrics().hints_delivered, 1u);
+}
+
+// A replica that missed writes while refusing them, with no hints and no
+// reads to repair it, catches up through anti-entropy: its peers find the
+// leaves that differ and push it only what they hold there.
+TEST(ClusterIntegration, AntiEntropyRepairsAReplicaThatMissedWrites) {
+    ClusterFixture f(3, 1, 1);
+    f.configure = [](NodeConfig& cfg) {
+        cfg.hinted_handoff = false;
+        cfg.failure_detection = false;
+        cfg.anti_entropy_interval_ms = 30;
+        cfg.anti_entropy_keys_per_sec = 100000;
+    };
+    f.start(3);
+    f.node(0).set_early_write_return(false);
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(f.node(0).put("warm" + std::to_string(i), "v"));
+    }
+    f.instances[2]->service->refuse_internal = true;
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(f.node(0).put("missed" + std::to_string(i), "v"));
+    }
+    EXPECT_FALSE(f.node(2).local_get("missed0").has_value());
+    f.instances[2]->service->refuse_internal = false;
+
+    // A push is counted once its MULTI_PUT returns, just after the entries
+    // land, so wait for the count as well.
+    auto pushes = [&f] {
+        return f.node(0).metrics().anti_entropy_pushes + f.node(1).metrics().anti_entropy_pushes;
+    };
+    auto converged = [&f, &pushes] {
+        for (int i = 0; i < 5; ++i) {
+            if (!f.node(2).local_get("missed" + std::to_string(i))) {
+                return false;
+            }
+        }
+        return pushes() >= 5u;
+    };
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!converged() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(converged());
+
+    // Only the differing leaves were pushed, not everything n3 already had.
+    EXPECT_LT(pushes(), 100u);
+
+    // Once the trees agree, rounds keep running and push nothing.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto before = f.node(0).metrics();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    auto after = f.node(0).metrics();
+    EXPECT_GT(after.anti_entropy_rounds, before.anti_entropy_rounds);
+    EXPECT_EQ(after.anti_entropy_pushes, before.anti_entropy_pushes);
+}
@@ -1,6 +1,13 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <grpcpp/grpcpp.h>
 
@@ -79,49 +86,232 @@ void run_repl(kvstore::KeyValue::Stub& stub) {
     }
 }
 
-// Sequential batch PUTs used by simple benchmark drivers.
-int run_batch_put(kvstore::KeyValue::Stub& stub,
+// Load-generation knobs for batch_put/batch_get.
+struct LoadOptions {
+    int concurrency = 1;  // channels, each driven by its own completion-queue thread
+    int inflight = 1;     // requests kept outstanding per channel
+};
+
+template <typename Response>
+using AsyncReader = std::unique_ptr<grpc::ClientAsyncResponseReader<Response>>;
+
+template <typename Request, typename Response>
+using PrepareFn = AsyncReader<Response> (kvstore::KeyValue::Stub::*)(
+    grpc::ClientContext*, const Request&, grpc::CompletionQueue*);
+
+template <typename Request, typename Response>
+struct PipelinedCall {
+    grpc::ClientContext ctx;
+    Request req;
+    Response resp;
+    grpc::Status status;
+    AsyncReader<Response> reader;
+    int index = 0;
+};
+
+// Issues requests 0..count-1 through the async stub, keeping
+// options.inflight of them outstanding on each of options.concurrency
+// channels. Stops issuing after the first failure and reports the lowest
+// failed index; otherwise prints the achieved throughput.
+template <typename Request, typename Response>
+int run_pipelined(const std::string& name,
+                  const std::string& address,
+                  const LoadOptions& options,
+                  int count,
+                  PrepareFn<Request, Response> prepare,
+                  const std::function<void(int, Request&)>& fill,
+                  const std::function<bool(const Response&)>& succeeded) {
+    using Call = PipelinedCall<Request, Response>;
+    std::atomic<int> next{0};
+    std::atomic<int> failed_at{count};
+
+    auto worker = [&](int channel_index) {
+        // Distinct channel args stop gRPC from sharing one connection
+        // between the channels.
+        grpc::ChannelArguments args;
+        args.SetInt("kv_cli.channel_index", channel_index);
+        auto stub = kvstore::KeyValue::NewStub(
+            grpc::CreateCustomChannel(address, grpc::InsecureChannelCredentials(), args));
+        grpc::CompletionQueue cq;
+        int outstanding = 0;
+
+        auto start_next = [&] {
+            if (failed_at.load(std::memory_order_relaxed) < count) {
+                return;
+            }
+            int i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= count) {
+                return;
+            }
+            auto* call = new Call();
+            call->index = i;
+            fill(i, call->req);
+            call->reader = ((*stub).*prepare)(&call->ctx, call->req, &cq);
+            call->reader->StartCall();
+            call->reader->Finish(&call->resp, &call->status, call);
+            outstanding++;
+        };
+
+        for (int k = 0; k < options.inflight; ++k) {
+            start_next();
+        }
+        void* tag = nullptr;
+        bool ok = false;
+        while (outstanding > 0 && cq.Next(&tag, &ok)) {
+            std::unique_ptr<Call> call(static_cast<Call*>(tag));
+            outstanding--;
+            if (!call->status.ok() || !succeeded(call->resp)) {
+                int lowest = failed_at.load();
+                while (call->index < lowest &&
+                       !failed_at.compare_exchange_weak(lowest, call->index)) {
+                }
+            }
+            start_next();
+        }
+        cq.Shutdown();
+        while (cq.Next(&tag, &ok)) {
+        }
+    };
+
+    auto started = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int c = 1; c < options.concurrency; ++c) {
+        workers.emplace_back(worker, c);
+    }
+    worker(0);
+    for (auto& t : workers) {
+        t.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started);
+
+    if (failed_at.load() < count) {
+        std::cerr << name << " failed at i=" << failed_at.load() << "\n";
+        return 1;
+    }
+    std::cout << name << ": " << count << " requests in "
+              << static_cast<long long>(elapsed.count() * 1000) << " ms ("
+              << static_cast<long long>(elapsed.count() > 0 ? count / elapsed.count() : 0)
+              << " req/s, concurrency=" << options.concurrency
+              << " inflight=" << options.inflight << ")\n";
+    return 0;
+}
+
+// Batch PUTs of <key_prefix>_0 .. <key_prefix>_<count-1>, used by simple
+// benchmark drivers.
+int run_batch_put(const std::string& address,
+                  const LoadOptions& options,
                   const std::string& key_prefix,
                   const std::string& value,
                   int count) {
-    kvstore::PutRequest req;
-    kvstore::PutResponse resp;
-    req.set_value(value);
+    return run_pipelined<kvstore::PutRequest, kvstore::PutResponse>(
+        "batch_put", address, options, count,
+        &kvstore::KeyValue::Stub::PrepareAsyncPut,
+        [&](int i, kvstore::PutRequest& req) {
+            req.set_key(key_prefix + "_" + std::to_string(i));
+            req.set_value(value);
+        },
+        [](const kvstore::PutResponse& resp) { return resp.success(); });
+}
 
-    for (int i = 0; i < count; ++i) {
-        std::string key = key_prefix + "_" + std::to_string(i);
-        grpc::ClientContext ctx;
+// Repeated GETs of one key, used by simple benchmark drivers.
+int run_batch_get(const std::string& address,
+                  const LoadOptions& options,
+                  const std::string& key,
+                  int count) {
+    return run_pipelined<kvstore::GetRequest, kvstore::GetResponse>(
+        "batch_get", address, options, count,
+        &kvstore::KeyValue::Stub::PrepareAsyncGet,
+        [&](int, kvstore::GetRequest& req) { req.set_key(key); },
+        [](const kvstore::GetResponse&) { return true; });
+}
 
-        req.set_key(key);
+// Removes --concurrency N / --inflight N from argv. Returns false (after
+// printing why) if a value is missing or not a positive integer.
+bool parse_load_options(int& argc, char** argv, LoadOptions& options) {
+    int out = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        int* target = arg == "--concurrency" ? &options.concurrency
+                    : arg == "--inflight" ? &options.inflight
+                    : nullptr;
+        if (!target) {
+            argv[out++] = argv[i];
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << arg << " requires a value\n";
+            return false;
+        }
+        try {
+            *target = std::stoi(argv[++i]);
+        } catch (const std::exception&) {
+            *target = 0;
+        }
+        if (*target <= 0) {
+            std::cerr << arg << " must be a positive integer\n";
+            return false;
+        }
+    }
+    argc = out;
+    return true;
+}
+
+// Bulk load in MultiPut batches of `batch` keys (<key_prefix>_<i>).
+int run_multi_put(kvstore::KeyValue::Stub& stub,
+                  const std::string& key_prefix,
+                  const std::string& value,
+                  int count,
+                  int batch) {
+    for (int start = 0; start < count; start += batch) {
+        kvstore::MultiPutRequest req;
+        kvstore::MultiPutResponse resp;
+        grpc::ClientContext ctx;
+        for (int i = start; i < std::min(count, start + batch); ++i) {
+            auto* entry = req.add_entries();
+            entry->set_key(key_prefix + "_" + std::to_string(i));
+            entry->set_value(value);
+        }
 
-        resp.Clear();
-        auto status = stub.Put(&ctx, req, &resp);
-        if (!status.ok() || !resp.success()) {
-            std::cerr << "batch_put failed at i=" << i << "\n";
+        auto status = stub.MultiPut(&ctx, req, &resp);
+        if (!status.ok()) {
+            std::cerr << "multi_put RPC failed at i=" << start << "\n";
             return 1;
         }
+        for (int j = 0; j < resp.results_size(); ++j) {
+            if (!resp.results(j).success()) {
+                std::cerr << "multi_put rejected (acks < W) at i=" << start + j << "\n";
+                return 1;
+            }
+        }
     }
     return 0;
 }
 
-// Sequential batch GETs used by simple benchmark drivers.
-int run_batch_get(kvstore::KeyValue::Stub& stub,
-                  const std::string& key,
-                  int count) {
-    kvstore::GetRequest req;
-    kvstore::GetResponse resp;
-    req.set_key(key);
-
-    for (int i = 0; i < count; ++i) {
+// Reads <key_prefix>_0 .. <key_prefix>_<count-1> in MultiGet batches and
+// reports how many were found.
+int run_multi_get(kvstore::KeyValue::Stub& stub,
+                  const std::string& key_prefix,
+                  int count,
+                  int batch) {
+    int found = 0;
+    for (int start = 0; start < count; start += batch) {
+        kvstore::MultiGetRequest req;
+        kvstore::MultiGetResponse resp;
         grpc::ClientContext ctx;
+        for (int i = start; i < std::min(count, start + batch); ++i) {
+            req.add_keys(key_prefix + "_" + std::to_string(i));
+        }
 
-        resp.Clear();
-        auto status = stub.Get(&ctx, req, &resp);
+        auto status = stub.MultiGet(&ctx, req, &resp);
         if (!status.ok()) {
-            std::cerr << "batch_get failed at i=" << i << "\n";
+            std::cerr << "multi_get RPC failed at i=" << start << "\n";
             return 1;
         }
+        for (const auto& result : resp.results()) {
+            found += result.found();
+        }
     }
+    std::cout << "found " << found << "/" << count << " keys\n";
     return 0;
 }
 
@@ -129,9 +319,14 @@ static void print_usage() {
     std::cerr << "Usage:\n"
               << "  kv_cli <addr> put <key> <value>\n"
               << "  kv_cli <addr> get <key>\n"
-              << "  kv_cli <addr> batch_put <key_prefix> <value> <count>\n"
-              << "  kv_cli <addr> batch_get <key> <count>\n"
-              << "  kv_cli <addr>\n";
+              << "  kv_cli <addr> batch_put <key_prefix> <value> <count> [load options]\n"
+              << "  kv_cli <addr> batch_get <key> <count> [load options]\n"
+              << "  kv_cli <addr> multi_put <key_prefix> <value> <count> <batch>\n"
+              << "  kv_cli <addr> multi_get <key_prefix> <count> <batch>\n"
+              << "  kv_cli <addr>\n"
+              << "Load options (batch_put/batch_get):\n"
+              << "  --concurrency N   spread requests over N channels (default 1)\n"
+              << "  --inflight N      keep N requests outstanding per channel (default 1)\n";
 }
 
 // CLI entrypoint; routes to REPL or one-shot commands.
@@ -139,6 +334,11 @@ int main(int argc, char** argv) {
     std::ios::sync_with_stdio(false);
     std::cin.tie(nullptr);
 
+    LoadOptions load_options;
+    if (!parse_load_options(argc, argv, load_options)) {
+        return 1;
+    }
+
     if (argc < 2) {
         print_usage();
         return 1;
@@ -225,7 +425,7 @@ int main(int argc, char** argv) {
             std::cerr << "count must be non-negative\n";
             return 1;
         }
-        return run_batch_put(*stub, key_prefix, value, count);
+        return run_batch_put(address, load_options, key_prefix, value, count);
     } else if (cmd == "batch_get") {
         if (argc < 5) {
             std::cerr << "batch_get requires <key> <count>\n";
@@ -237,7 +437,31 @@ int main(int argc, char** argv) {
             std::cerr << "count must be non-negative\n";
             return 1;
         }
-        return run_batch_get(*stub, key_arg, count);
+        return run_batch_get(address, load_options, key_arg, count);
+    } else if (cmd == "multi_put") {
+        if (argc < 7) {
+            std::cerr << "multi_put requires <key_prefix> <value> <count> <batch>\n";
+            return 1;
+        }
+        int count = std::stoi(argv[5]);
+        int batch = std::stoi(argv[6]);
+        if (count < 0 || batch <= 0) {
+            std::cerr << "count must be non-negative and batch positive\n";
+            return 1;
+        }
+        return run_multi_put(*stub, argv[3], argv[4], count, batch);
+    } else if (cmd == "multi_get") {
+        if (argc < 6) {
+            std::cerr << "multi_get requires <key_prefix> <count> <batch>\n";
+            return 1;
+        }
+        int count = std::stoi(argv[4]);
+        int batch = std::stoi(argv[5]);
+        if (count < 0 || batch <= 0) {
+            std::cerr << "count must be non-negative and batch positive\n";
+            return 1;
+        }
+        return run_multi_get(*stub, argv[3], count, batch);
     } else {
         std::cerr << "Unknown command: " << cmd << "\n";
         return 1;
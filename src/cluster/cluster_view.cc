@@ -1,42 +1,80 @@
 #include "cluster/cluster_view.h"
 
+#include <stdexcept>
 #include <utility>
 
+#include "hash/murmur3.h"
+#include "storage/epoch.h"
+
 namespace kv::cluster {
 
-ClusterView::ClusterView(size_t vnodes)
-    : ring_(vnodes) {}
+namespace {
+constexpr uint64_t WRITER_SEED = 0x9747b28c;
+
+uint32_t writer_id_for(const std::string& node_id) {
+    auto id = static_cast<uint32_t>(kv::hash::murmur3_64(node_id, WRITER_SEED));
+    return id != 0 ? id : 1;
+}
+}
+
+ClusterView::ClusterView(size_t vnodes, size_t replicas)
+    : snapshot_(new Snapshot{{}, {}, kv::ring::ConsistentHashRing(vnodes, replicas)}) {}
+
+ClusterView::~ClusterView() {
+    delete snapshot_.load(std::memory_order_acquire);
+}
+
+void ClusterView::publish(std::unique_ptr<Snapshot> next) {
+    const Snapshot* old = snapshot_.exchange(next.release(), std::memory_order_acq_rel);
+    kv::storage::epoch::retire(const_cast<Snapshot*>(old));
+}
 
 void ClusterView::add_node_to_cluster(const std::string& node_id,
                                       const std::string& address) {
     std::lock_guard<std::mutex> lock(mutex_);
+    const Snapshot* current = snapshot_.load(std::memory_order_relaxed);
 
-    if (nodes_.find(node_id) != nodes_.end()) {
+    if (current->nodes.find(node_id) != current->nodes.end()) {
         return;
     }
 
-    nodes_.emplace(node_id, address);
-    ring_.add_node(node_id);
+    // Checked before anything changes: two members sharing a writer id
+    // could not tell their versions apart.
+    const uint32_t writer = writer_id_for(node_id);
+    auto known = current->writer_names.find(writer);
+    if (known != current->writer_names.end() && known->second != node_id) {
+        throw std::invalid_argument("writer id collision between '" + known->second +
+                                    "' and '" + node_id + "'");
+    }
+
+    auto next = std::make_unique<Snapshot>(*current);
+    next->nodes.emplace(node_id, address);
+    next->ring.add_node(node_id);
+    next->writer_names.emplace(writer, node_id);
+    publish(std::move(next));
 }
 
 void ClusterView::remove_node_from_cluster(const std::string& node_id) {
     std::lock_guard<std::mutex> lock(mutex_);
+    const Snapshot* current = snapshot_.load(std::memory_order_relaxed);
 
-    auto it = nodes_.find(node_id);
-    if (it == nodes_.end()) {
+    if (current->nodes.find(node_id) == current->nodes.end()) {
         return;
     }
 
-    ring_.remove_node(node_id);
-    nodes_.erase(it);
+    auto next = std::make_unique<Snapshot>(*current);
+    next->ring.remove_node(node_id);
+    next->nodes.erase(node_id);
+    publish(std::move(next));
 }
 
 std::vector<std::string> ClusterView::get_node_ids() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    kv::storage::epoch::Guard guard;
+    const Snapshot* snap = snapshot_.load(std::memory_order_acquire);
 
     std::vector<std::string> ids;
-    ids.reserve(nodes_.size());
-    for (const auto& [id, _] : nodes_) {
+    ids.reserve(snap->nodes.size());
+    for (const auto& [id, _] : snap->nodes) {
         ids.push_back(id);
     }
     return ids;
@@ -45,15 +83,23 @@ std::vector<std::string> ClusterView::get_node_ids() const {
 std::vector<std::string>
 ClusterView::get_replica_set_for_key(const std::string& key,
                                      size_t replication_factor) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return ring_.get_preference_list(key, replication_factor);
+    kv::storage::epoch::Guard guard;
+    return snapshot_.load(std::memory_order_acquire)->ring.get_preference_list(key, replication_factor);
+}
+
+std::vector<kv::ring::TokenRange>
+ClusterView::get_token_ranges_for_node(const std::string& node_id,
+                                       size_t replication_factor) const {
+    kv::storage::epoch::Guard guard;
+    return snapshot_.load(std::memory_order_acquire)->ring.ranges_for(node_id, replication_factor);
 }
 
 std::optional<std::string> ClusterView::get_node_address(const std::string& node_id) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    kv::storage::epoch::Guard guard;
+    const Snapshot* snap = snapshot_.load(std::memory_order_acquire);
 
-    auto it = nodes_.find(node_id);
-    if (it == nodes_.end()) {
+    auto it = snap->nodes.find(node_id);
+    if (it == snap->nodes.end()) {
         return std::nullopt;
     }
     return it->second;
@@ -61,17 +107,67 @@ std::optional<std::string> ClusterView::get_node_address(const std::string& node
 
 std::shared_ptr<grpc::Channel>
 ClusterView::create_grpc_channel_for_node(const std::string& node_id) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    auto it = nodes_.find(node_id);
-    if (it == nodes_.end()) {
+    auto address = get_node_address(node_id);
+    if (!address) {
         return nullptr;
     }
 
     return grpc::CreateChannel(
-        it->second,
+        *address,
         grpc::InsecureChannelCredentials()
     );
 }
 
-} 
+uint32_t ClusterView::intern_writer(const std::string& node_id) {
+    uint32_t id = writer_id_for(node_id);
+    {
+        // Known ids skip the lock.
+        kv::storage::epoch::Guard guard;
+        const Snapshot* snap = snapshot_.load(std::memory_order_acquire);
+        auto it = snap->writer_names.find(id);
+        if (it != snap->writer_names.end() && it->second == node_id) {
+            return id;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Snapshot* current = snapshot_.load(std::memory_order_relaxed);
+    auto it = current->writer_names.find(id);
+    if (it != current->writer_names.end()) {
+        if (it->second != node_id) {
+            throw std::invalid_argument("writer id collision between '" + it->second +
+                                        "' and '" + node_id + "'");
+        }
+        return id;
+    }
+
+    auto next = std::make_unique<Snapshot>(*current);
+    next->writer_names.emplace(id, node_id);
+    publish(std::move(next));
+    return id;
+}
+
+std::optional<uint32_t> ClusterView::find_writer(const std::string& node_id) const {
+    uint32_t id = writer_id_for(node_id);
+    kv::storage::epoch::Guard guard;
+    const Snapshot* snap = snapshot_.load(std::memory_order_acquire);
+
+    auto it = snap->writer_names.find(id);
+    if (it == snap->writer_names.end() || it->second != node_id) {
+        return std::nullopt;
+    }
+    return id;
+}
+
+std::optional<std::string> ClusterView::writer_name(uint32_t writer) const {
+    kv::storage::epoch::Guard guard;
+    const Snapshot* snap = snapshot_.load(std::memory_order_acquire);
+
+    auto it = snap->writer_names.find(writer);
+    if (it == snap->writer_names.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -11,12 +13,28 @@
 
 #include "ring/consistent_hash_ring.h"
 
+/*
+- Membership, ring and writer names are published as one immutable Snapshot
+  behind an atomic pointer. Readers pin an epoch (storage/epoch.h) and read
+  the current snapshot without taking any lock; writers serialize on mutex_,
+  copy the snapshot, modify the copy, publish it and retire the old one.
+- Membership changes are rare and cost a full copy; the request path never
+  blocks on them.
+*/
 namespace kv::cluster {
 
 class ClusterView {
 public:
-    explicit ClusterView(size_t vnodes = 100);
+    // Replica sets of up to `replicas` nodes are served from the ring's
+    // precomputed table; pass the cluster's replication factor.
+    explicit ClusterView(size_t vnodes = 100, size_t replicas = 3);
+    ~ClusterView();
 
+    ClusterView(const ClusterView&) = delete;
+    ClusterView& operator=(const ClusterView&) = delete;
+
+    // Adds a member and interns its writer id. Throws std::invalid_argument,
+    // leaving the view unchanged, if the id collides with a known name.
     void add_node_to_cluster(const std::string& node_id, const std::string& address);
     void remove_node_from_cluster(const std::string& node_id);
 
@@ -26,13 +44,39 @@ public:
 
     std::vector<std::string>
     get_replica_set_for_key(const std::string& key, size_t replication_factor) const;
+
+    // Token ranges `node_id` is a replica of; see ConsistentHashRing::ranges_for.
+    std::vector<kv::ring::TokenRange>
+    get_token_ranges_for_node(const std::string& node_id, size_t replication_factor) const;
     
     std::shared_ptr<grpc::Channel> create_grpc_channel_for_node(const std::string& node_id) const;
 
+    // Maps a node id to its compact writer id. Ids are derived from a hash of
+    // the name, so every node agrees on them without coordination; the name
+    // is remembered for writer_name(). Throws std::invalid_argument if two
+    // names collide. Never returns 0.
+    uint32_t intern_writer(const std::string& node_id);
+
+    // Writer id of an already known name (a member, or one interned before),
+    // without adding it. Unknown and colliding names yield nullopt.
+    std::optional<uint32_t> find_writer(const std::string& node_id) const;
+
+    // Name previously interned for `writer`, if any.
+    std::optional<std::string> writer_name(uint32_t writer) const;
+
 private:
-    mutable std::mutex mutex_;
-    std::unordered_map<std::string, std::string> nodes_;
-    kv::ring::ConsistentHashRing ring_;
+    struct Snapshot {
+        std::unordered_map<std::string, std::string> nodes;
+        // Grow-only: versions written by removed nodes still resolve.
+        std::unordered_map<uint32_t, std::string> writer_names;
+        kv::ring::ConsistentHashRing ring;
+    };
+
+    // Publishes `next` and retires the snapshot it replaces. Requires mutex_.
+    void publish(std::unique_ptr<Snapshot> next);
+
+    std::mutex mutex_;  // serializes writers only
+    std::atomic<const Snapshot*> snapshot_;
 };
 
 } 
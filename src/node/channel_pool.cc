@@ -0,0 +1,201 @@
+#include "node/channel_pool.h"
+
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace kv::node {
+
+struct ChannelPool::Slot {
+    size_t index = 0;
+    std::shared_ptr<grpc::Channel> channel;
+    std::unique_ptr<kvstore::KeyValue::Stub> stub;
+    std::atomic<uint64_t> inflight{0};
+
+    bool healthy() const {
+        return channel->GetState(false) != GRPC_CHANNEL_TRANSIENT_FAILURE;
+    }
+};
+
+struct ChannelPool::Peer {
+    std::string address;
+    std::unique_ptr<Slot[]> slots;
+    size_t size = 0;
+    std::atomic<uint64_t> next{0};  // round-robin cursor
+};
+
+std::optional<ChannelSelection> parse_channel_selection(std::string_view value) {
+    if (value == "round_robin") return ChannelSelection::RoundRobin;
+    if (value == "least_inflight") return ChannelSelection::LeastInflight;
+    return std::nullopt;
+}
+
+const char* to_string(ChannelSelection selection) {
+    switch (selection) {
+        case ChannelSelection::RoundRobin: return "round_robin";
+        case ChannelSelection::LeastInflight: return "least_inflight";
+    }
+    return "unknown";
+}
+
+ChannelPool::Lease::Lease(std::shared_ptr<Peer> peer, Slot* slot)
+    : peer_(std::move(peer)), slot_(slot) {
+    slot_->inflight.fetch_add(1, std::memory_order_relaxed);
+}
+
+ChannelPool::Lease::Lease(Lease&& other) noexcept
+    : peer_(std::move(other.peer_)), slot_(std::exchange(other.slot_, nullptr)) {}
+
+ChannelPool::Lease& ChannelPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        peer_ = std::move(other.peer_);
+        slot_ = std::exchange(other.slot_, nullptr);
+    }
+    return *this;
+}
+
+ChannelPool::Lease::~Lease() {
+    release();
+}
+
+void ChannelPool::Lease::release() {
+    if (slot_) {
+        slot_->inflight.fetch_sub(1, std::memory_order_relaxed);
+        slot_ = nullptr;
+    }
+    peer_.reset();
+}
+
+kvstore::KeyValue::Stub* ChannelPool::Lease::stub() const {
+    return slot_ ? slot_->stub.get() : nullptr;
+}
+
+size_t ChannelPool::Lease::channel_index() const {
+    return slot_ ? slot_->index : 0;
+}
+
+ChannelPool::ChannelPool(const kv::cluster::ClusterView& cluster,
+                         size_t channels_per_peer,
+                         ChannelSelection selection)
+    : cluster_(cluster), channels_per_peer_(channels_per_peer), selection_(selection) {
+    if (channels_per_peer_ == 0) {
+        throw std::invalid_argument("channels_per_peer must be >= 1");
+    }
+}
+
+ChannelPool::Lease ChannelPool::acquire(const std::string& node_id) {
+    auto peer = peer_for(node_id);
+    if (!peer) {
+        return Lease();
+    }
+    Slot* slot = pick(*peer);
+    return Lease(std::move(peer), slot);
+}
+
+void ChannelPool::warm_up(const std::vector<std::string>& node_ids) {
+    for (const auto& node_id : node_ids) {
+        auto peer = peer_for(node_id);
+        if (!peer) {
+            continue;
+        }
+        for (size_t i = 0; i < peer->size; ++i) {
+            peer->slots[i].channel->GetState(true);
+        }
+    }
+}
+
+uint64_t ChannelPool::inflight(const std::string& node_id) const {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    auto it = peers_.find(node_id);
+    if (it == peers_.end()) {
+        return 0;
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < it->second->size; ++i) {
+        total += it->second->slots[i].inflight.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::shared_ptr<ChannelPool::Peer> ChannelPool::peer_for(const std::string& node_id) {
+    // The address is re-read on every call (a lock-free snapshot read), so a
+    // member that moved gets fresh channels on its next request.
+    auto address = cluster_.get_node_address(node_id);
+    if (!address) {
+        return nullptr;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        auto it = peers_.find(node_id);
+        if (it != peers_.end() && it->second->address == *address) {
+            return it->second;
+        }
+    }
+
+    // Build outside the lock; channel creation does not connect.
+    auto peer = std::make_shared<Peer>();
+    peer->address = *address;
+    peer->size = channels_per_peer_;
+    peer->slots = std::make_unique<Slot[]>(channels_per_peer_);
+    for (size_t i = 0; i < channels_per_peer_; ++i) {
+        // Channels with identical arguments share one connection; a distinct
+        // argument per index forces a separate one.
+        grpc::ChannelArguments args;
+        args.SetInt("kv.channel_index", static_cast<int>(i));
+        auto& slot = peer->slots[i];
+        slot.index = i;
+        slot.channel = grpc::CreateCustomChannel(*address, grpc::InsecureChannelCredentials(), args);
+        slot.stub = kvstore::KeyValue::NewStub(slot.channel);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mu_);
+    auto& current = peers_[node_id];
+    if (current && current->address == *address) {
+        return current;  // another thread got here first
+    }
+    current = std::move(peer);
+    return current;
+}
+
+ChannelPool::Slot* ChannelPool::pick(Peer& peer) {
+    if (peer.size == 1) {
+        return &peer.slots[0];
+    }
+
+    if (selection_ == ChannelSelection::RoundRobin) {
+        const size_t start = static_cast<size_t>(
+            peer.next.fetch_add(1, std::memory_order_relaxed) % peer.size);
+        for (size_t k = 0; k < peer.size; ++k) {
+            Slot& slot = peer.slots[(start + k) % peer.size];
+            if (slot.healthy()) {
+                return &slot;
+            }
+        }
+        return &peer.slots[start];
+    }
+
+    // Least in flight, preferring healthy channels. Ties go to the lowest
+    // index after a rotating start, so idle channels still share the load.
+    const size_t start = static_cast<size_t>(
+        peer.next.fetch_add(1, std::memory_order_relaxed) % peer.size);
+    Slot* best = nullptr;
+    bool best_healthy = false;
+    uint64_t best_inflight = std::numeric_limits<uint64_t>::max();
+    for (size_t k = 0; k < peer.size; ++k) {
+        Slot& slot = peer.slots[(start + k) % peer.size];
+        const bool healthy = slot.healthy();
+        const uint64_t inflight = slot.inflight.load(std::memory_order_relaxed);
+        if ((healthy && !best_healthy) ||
+            (healthy == best_healthy && inflight < best_inflight)) {
+            best = &slot;
+            best_healthy = healthy;
+            best_inflight = inflight;
+        }
+    }
+    return best;
+}
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cluster/cluster_view.h"
+#include "kv.grpc.pb.h"
+
+/*
+- Outgoing connections to peers: a fixed number of independent gRPC channels
+  (each its own HTTP/2 connection) per peer, so inter-node traffic is not
+  capped by one connection's concurrent stream limit.
+- acquire() picks a channel by round robin or fewest in-flight calls,
+  skipping channels in TRANSIENT_FAILURE while a healthier one exists, and
+  returns a Lease that counts as in flight until it is destroyed.
+- A peer's channels are rebuilt when its address in ClusterView changes.
+  Leases keep the channels they came from alive, so calls already issued on
+  the old address complete normally.
+*/
+namespace kv::node {
+
+enum class ChannelSelection {
+    RoundRobin,
+    LeastInflight,
+};
+
+// Accepts round_robin/least_inflight (case-sensitive).
+std::optional<ChannelSelection> parse_channel_selection(std::string_view value);
+const char* to_string(ChannelSelection selection);
+
+class ChannelPool {
+    struct Peer;
+    struct Slot;
+
+public:
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        explicit operator bool() const { return slot_ != nullptr; }
+        kvstore::KeyValue::Stub* stub() const;
+        // Index of the channel within its peer's pool.
+        size_t channel_index() const;
+
+    private:
+        friend class ChannelPool;
+        Lease(std::shared_ptr<Peer> peer, Slot* slot);
+        void release();
+
+        std::shared_ptr<Peer> peer_;
+        Slot* slot_ = nullptr;
+    };
+
+    // `channels_per_peer` must be >= 1.
+    ChannelPool(const kv::cluster::ClusterView& cluster,
+                size_t channels_per_peer,
+                ChannelSelection selection);
+
+    // Empty lease if `node_id` is not a cluster member.
+    Lease acquire(const std::string& node_id);
+
+    // Builds the pools for `node_ids` and starts connecting every channel in
+    // the background, so the first requests do not pay for the handshakes.
+    void warm_up(const std::vector<std::string>& node_ids);
+
+    size_t channels_per_peer() const { return channels_per_peer_; }
+    ChannelSelection selection() const { return selection_; }
+
+    // Calls currently holding a lease on `node_id`'s channels. For tests.
+    uint64_t inflight(const std::string& node_id) const;
+
+private:
+    std::shared_ptr<Peer> peer_for(const std::string& node_id);
+    Slot* pick(Peer& peer);
+
+    const kv::cluster::ClusterView& cluster_;
+    const size_t channels_per_peer_;
+    const ChannelSelection selection_;
+
+    mutable std::shared_mutex mu_;
+    std::unordered_map<std::string, std::shared_ptr<Peer>> peers_;
+};
+
+}
@@ -0,0 +1,607 @@
+#pragma once
+
+#include <grpcpp/alarm.h>
+#include <grpcpp/grpcpp.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "node/channel_pool.h"
+
+/*
+- Coroutine layer for the coordinator: Task<T>, detached spawn(), awaitable
+  unary RPCs on a grpc::CompletionQueue, Quorum<T> (when_n_of) for
+  waiting on n of several concurrent operations with an optional deadline,
+  and WorkerPool for blocking work the completion-queue thread must not do.
+- No thread blocks while a replica call is outstanding: the awaiting
+  coroutine is resumed by the thread draining the completion queue, or by
+  whichever thread completes the operation that satisfies a quorum.
+*/
+namespace kv::node::coro {
+
+// Tag for a completion queue: the poller calls on_complete() and then
+// deletes the object.
+class AsyncCall {
+public:
+    virtual ~AsyncCall() = default;
+    virtual void on_complete() = 0;
+};
+
+template <typename T>
+class Task;
+
+namespace detail {
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // Hands control straight to the awaiting coroutine, so long await
+    // chains do not grow the stack.
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+            auto next = h.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    void return_value(T v) { value.emplace(std::move(v)); }
+
+    T result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : PromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+
+    void result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+}  // namespace detail
+
+// Lazily started coroutine producing a T. It starts when first awaited and
+// resumes its awaiter on whichever thread it finishes on. Exceptions are
+// rethrown to the awaiter.
+template <typename T = void>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            Handle handle;
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().result(); }
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    friend struct detail::TaskPromise<T>;
+    explicit Task(Handle handle) : handle_(handle) {}
+
+    Handle handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+}  // namespace detail
+
+// Return type of a fire-and-forget coroutine: it starts immediately and
+// frees itself when done.
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        // Nothing is left to report to; same as an exception escaping a
+        // completion-queue callback.
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// Runs `task` to completion in the background and passes its result to
+// `done` on the thread that finishes it (the calling thread if it never
+// suspends).
+template <typename T, typename Done>
+Detached spawn(Task<T> task, Done done) {
+    done(co_await std::move(task));
+}
+
+template <typename Done>
+Detached spawn(Task<void> task, Done done) {
+    co_await std::move(task);
+    done();
+}
+
+inline Detached spawn(Task<void> task) {
+    co_await std::move(task);
+}
+
+template <typename Response>
+struct RpcResult {
+    grpc::Status status;
+    Response response;
+};
+
+// Awaitable unary RPC, issued on `cq` when awaited; yields the status and
+// response. The lease stays held, counting the call as in flight on its
+// channel, until the RPC completes. An empty lease yields UNAVAILABLE
+// without suspending.
+template <typename Response>
+class UnaryCall {
+public:
+    template <typename Request>
+    using Prepare = std::unique_ptr<grpc::ClientAsyncResponseReader<Response>> (
+        kvstore::KeyValue::Stub::*)(grpc::ClientContext*, const Request&, grpc::CompletionQueue*);
+
+    // `request` must stay alive until the call completes.
+    template <typename Request>
+    UnaryCall(ChannelPool::Lease lease,
+              Prepare<Request> prepare,
+              const Request& request,
+              grpc::CompletionQueue* cq,
+              std::optional<std::chrono::milliseconds> deadline) {
+        if (!lease) {
+            result_.status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "no channel to peer");
+            return;
+        }
+        call_ = new Call();
+        call_->lease = std::move(lease);
+        if (deadline) {
+            call_->ctx.set_deadline(std::chrono::system_clock::now() + *deadline);
+        }
+        call_->reader = (call_->lease.stub()->*prepare)(&call_->ctx, request, cq);
+    }
+
+    UnaryCall(UnaryCall&& other) noexcept
+        : call_(std::exchange(other.call_, nullptr)), result_(std::move(other.result_)) {}
+    UnaryCall& operator=(UnaryCall&&) = delete;
+
+    // A call that was never awaited was never started.
+    ~UnaryCall() { delete call_; }
+
+    bool await_ready() const noexcept { return call_ == nullptr; }
+
+    void await_suspend(std::coroutine_handle<> awaiting) {
+        Call* call = std::exchange(call_, nullptr);  // owned by the queue from here
+        call->awaiting = awaiting;
+        call->result = &result_;
+        call->reader->StartCall();
+        call->reader->Finish(&call->response, &call->status, call);
+    }
+
+    RpcResult<Response> await_resume() { return std::move(result_); }
+
+private:
+    struct Call final : AsyncCall {
+        grpc::ClientContext ctx;
+        Response response;
+        grpc::Status status;
+        std::unique_ptr<grpc::ClientAsyncResponseReader<Response>> reader;
+        ChannelPool::Lease lease;
+        std::coroutine_handle<> awaiting;
+        RpcResult<Response>* result = nullptr;
+
+        void on_complete() override {
+            result->status = std::move(status);
+            result->response.Swap(&response);
+            awaiting.resume();
+        }
+    };
+
+    Call* call_ = nullptr;
+    RpcResult<Response> result_;
+};
+
+template <typename Request, typename Response>
+UnaryCall<Response> unary_call(
+        ChannelPool::Lease lease,
+        std::unique_ptr<grpc::ClientAsyncResponseReader<Response>> (kvstore::KeyValue::Stub::*prepare)(
+            grpc::ClientContext*, const Request&, grpc::CompletionQueue*),
+        const Request& request,
+        grpc::CompletionQueue* cq,
+        std::optional<std::chrono::milliseconds> deadline = std::nullopt) {
+    return UnaryCall<Response>(std::move(lease), prepare, request, cq, deadline);
+}
+
+// Results of a group of concurrent operations, awaited until `n` of them
+// are accepted. Operations are started with run() (or expect() plus a later
+// complete()); results known up front are recorded with add(). wait()
+// resumes once n results are accepted, or once every operation has finished;
+// with `fail_fast`, also as soon as the outstanding operations can no longer
+// make up the shortfall. Results arriving after that go to the on_late()
+// handler. ready_by() waits for the same condition without ending the wait,
+// so a caller can start more operations (hedges, retries) and wait again.
+//
+// Held through shared_ptr: running operations keep it alive.
+template <typename T>
+class Quorum : public std::enable_shared_from_this<Quorum<T>> {
+public:
+    using Accept = std::function<bool(const T&)>;
+
+    Quorum(size_t n, Accept accept, bool fail_fast = false)
+        : n_(n), accept_(std::move(accept)), fail_fast_(fail_fast) {}
+
+    Quorum(const Quorum&) = delete;
+    Quorum& operator=(const Quorum&) = delete;
+
+    // Starts `task` now; its result completes one expected operation.
+    void run(Task<T> task) {
+        expect();
+        feed(this->shared_from_this(), std::move(task));
+    }
+
+    // Registers `count` operations whose results will arrive via complete().
+    void expect(size_t count = 1) {
+        std::lock_guard<std::mutex> lock(mu_);
+        outstanding_ += count;
+    }
+
+    void complete(T result) { record(std::move(result), true); }
+    void add(T result) { record(std::move(result), false); }
+
+    // Awaitable yielding the results gathered when the wait ended, in
+    // completion order. Await at most once.
+    auto wait() { return Awaiter{{this->shared_from_this(), nullptr, std::nullopt}}; }
+
+    // As wait(), but also resumes at `deadline`, using an alarm on `cq`.
+    auto wait_until(grpc::CompletionQueue* cq, std::chrono::system_clock::time_point deadline) {
+        return Awaiter{{this->shared_from_this(), cq, deadline}};
+    }
+
+    // Awaitable yielding true once wait() would resume, or false at
+    // `deadline`. Results stay in place; may be awaited repeatedly.
+    auto ready_by(grpc::CompletionQueue* cq, std::chrono::system_clock::time_point deadline) {
+        return ReadyAwaiter{{this->shared_from_this(), cq, deadline}};
+    }
+
+    // Results accepted so far.
+    size_t accepted() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return accepted_;
+    }
+
+    // Handles results that arrive after the wait has ended, including any
+    // that came in before the handler was installed. Runs on the completing
+    // thread and must not block.
+    void on_late(std::function<void(T)> handler) {
+        std::vector<T> pending;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            late_ = std::move(handler);
+            pending.swap(results_);
+        }
+        for (auto& result : pending) {
+            late_(std::move(result));
+        }
+    }
+
+    // True once a wait has ended because its deadline passed.
+    bool expired() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return expired_;
+    }
+
+    size_t outstanding() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return outstanding_;
+    }
+
+private:
+    struct AwaiterBase {
+        std::shared_ptr<Quorum> quorum;
+        grpc::CompletionQueue* cq;
+        std::optional<std::chrono::system_clock::time_point> deadline;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            return quorum->suspend(awaiting, cq, deadline);
+        }
+    };
+
+    struct Awaiter : AwaiterBase {
+        std::vector<T> await_resume() { return this->quorum->settle(); }
+    };
+
+    struct ReadyAwaiter : AwaiterBase {
+        bool await_resume() {
+            std::lock_guard<std::mutex> lock(this->quorum->mu_);
+            return this->quorum->satisfied();
+        }
+    };
+
+    struct AlarmCall final : AsyncCall {
+        std::shared_ptr<Quorum> quorum;
+        grpc::Alarm alarm;
+        void on_complete() override { quorum->expire(this); }
+    };
+
+    static Detached feed(std::shared_ptr<Quorum> quorum, Task<T> task) {
+        quorum->complete(co_await std::move(task));
+    }
+
+    // Requires mu_.
+    bool satisfied() const {
+        if (accepted_ >= n_ || outstanding_ == 0) {
+            return true;
+        }
+        return fail_fast_ && accepted_ + outstanding_ < n_;
+    }
+
+    void record(T result, bool was_outstanding) {
+        std::coroutine_handle<> resume;
+        std::function<void(T)>* late = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (was_outstanding) {
+                outstanding_--;
+            }
+            if (settled_ && late_) {
+                late = &late_;
+            } else {
+                if (!settled_ && accept_(result)) {
+                    accepted_++;
+                }
+                results_.push_back(std::move(result));
+                if (awaiting_ && satisfied()) {
+                    resume = std::exchange(awaiting_, {});
+                    cancel_alarm();
+                }
+            }
+        }
+        if (late) {
+            // late_ is only assigned once, before settled_ results reach it.
+            (*late)(std::move(result));
+            return;
+        }
+        if (resume) {
+            resume.resume();
+        }
+    }
+
+    bool suspend(std::coroutine_handle<> awaiting,
+                 grpc::CompletionQueue* cq,
+                 std::optional<std::chrono::system_clock::time_point> deadline) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (satisfied()) {
+            return false;
+        }
+        awaiting_ = awaiting;
+        if (deadline) {
+            alarm_ = new AlarmCall();
+            alarm_->quorum = this->shared_from_this();
+            alarm_->alarm.Set(cq, *deadline, alarm_);
+        }
+        return true;
+    }
+
+    void expire(AlarmCall* alarm) {
+        std::coroutine_handle<> resume;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (alarm != alarm_) {
+                return;  // cancelled: its wait was already resumed by a result
+            }
+            alarm_ = nullptr;  // deleted by the poller once this returns
+            expired_ = true;
+            resume = std::exchange(awaiting_, {});
+        }
+        resume.resume();
+    }
+
+    // Requires mu_. The alarm still completes (not ok) and runs expire(),
+    // which releases the quorum.
+    void cancel_alarm() {
+        if (alarm_) {
+            alarm_->alarm.Cancel();
+            alarm_ = nullptr;
+        }
+    }
+
+    std::vector<T> settle() {
+        std::vector<T> results;
+        std::lock_guard<std::mutex> lock(mu_);
+        settled_ = true;
+        results.swap(results_);
+        return results;
+    }
+
+    const size_t n_;
+    const Accept accept_;
+    const bool fail_fast_;
+
+    mutable std::mutex mu_;
+    std::vector<T> results_;
+    size_t accepted_ = 0;
+    size_t outstanding_ = 0;
+    std::coroutine_handle<> awaiting_;
+    bool settled_ = false;
+    bool expired_ = false;
+    AlarmCall* alarm_ = nullptr;  // pending deadline alarm, owned by the queue
+    std::function<void(T)> late_;
+};
+
+// Starts every task and returns the quorum over their results; co_await
+// its wait() for the first `n` accepted.
+template <typename T>
+std::shared_ptr<Quorum<T>> when_n_of(size_t n,
+                                     std::vector<Task<T>> tasks,
+                                     typename Quorum<T>::Accept accept,
+                                     bool fail_fast = false) {
+    auto quorum = std::make_shared<Quorum<T>>(n, std::move(accept), fail_fast);
+    for (auto& task : tasks) {
+        quorum->run(std::move(task));
+    }
+    return quorum;
+}
+
+// Threads for blocking work, such as log syncs, that would otherwise stall
+// every coroutine on the completion-queue thread. Awaiting run(fn) calls fn
+// on a worker and resumes the awaiting coroutine there with its result; fn
+// must not throw. A pool without threads, or one that has been stopped,
+// calls fn inline instead.
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t threads) {
+        stopping_ = threads == 0;
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this] { work(); });
+        }
+    }
+    ~WorkerPool() { stop(); }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    template <typename Fn>
+    auto run(Fn fn) {
+        return Awaiter<Fn>{this, std::move(fn), std::nullopt};
+    }
+
+    // Finishes the queued work, resuming its coroutines, then joins the
+    // workers. Later run() calls execute inline.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& thread : threads_) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+private:
+    template <typename Fn>
+    struct Awaiter {
+        using Result = std::invoke_result_t<Fn&>;
+
+        WorkerPool* pool;
+        Fn fn;
+        std::optional<Result> result;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            // The frame holding this awaiter may be gone once the coroutine
+            // resumes, so nothing touches it afterwards.
+            if (pool->post([this, awaiting] {
+                    result.emplace(fn());
+                    awaiting.resume();
+                })) {
+                return true;
+            }
+            result.emplace(fn());
+            return false;
+        }
+        Result await_resume() { return std::move(*result); }
+    };
+
+    // False, without queueing, once the pool is stopping.
+    bool post(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (stopping_) {
+                return false;
+            }
+            jobs_.push_back(std::move(job));
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mu_);
+        for (;;) {
+            cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) {
+                return;
+            }
+            auto job = std::move(jobs_.front());
+            jobs_.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> jobs_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace kv::node::coro
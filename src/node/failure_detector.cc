@@ -0,0 +1,157 @@
+#include "node/failure_detector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace kv::node {
+
+FailureDetector::FailureDetector(const FailureDetectorOptions& options)
+    : options_(options) {}
+
+FailureDetector::Peer& FailureDetector::peer_for(const std::string& peer, Clock::time_point now) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        auto it = peers_.find(peer);
+        if (it != peers_.end()) {
+            return *it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mu_);
+    auto& state = peers_[peer];
+    if (!state) {
+        state = std::make_unique<Peer>();
+        state->silent_since = now;
+    }
+    return *state;
+}
+
+FailureDetector::Peer* FailureDetector::find(const std::string& peer) const {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    auto it = peers_.find(peer);
+    return it == peers_.end() ? nullptr : it->second.get();  // entries are never removed
+}
+
+bool FailureDetector::begin_ping(const std::string& peer, Clock::time_point now) {
+    Peer& state = peer_for(peer, now);
+    std::lock_guard<std::mutex> lock(state.mu);
+    if (state.ping_outstanding) {
+        return false;
+    }
+    state.ping_outstanding = true;
+    return true;
+}
+
+void FailureDetector::ping_succeeded(const std::string& peer, Clock::time_point now) {
+    Peer& state = peer_for(peer, now);
+    std::lock_guard<std::mutex> lock(state.mu);
+    state.ping_outstanding = false;
+    state.consecutive_failures = 0;
+
+    // The silence of an outage is not a heartbeat interval; recording it
+    // would make the peer look slow and blunt detection of the next one.
+    if (state.last_heartbeat && !state.open) {
+        state.intervals.push_back(now - *state.last_heartbeat);
+        state.interval_sum += state.intervals.back();
+        if (state.intervals.size() > options_.window) {
+            state.interval_sum -= state.intervals.front();
+            state.intervals.pop_front();
+        }
+    }
+    state.last_heartbeat = now;
+    state.silent_since = now;
+
+    if (state.open && now - state.opened_at >= options_.open_duration) {
+        state.open = false;
+    }
+}
+
+void FailureDetector::ping_failed(const std::string& peer, Clock::time_point now) {
+    Peer& state = peer_for(peer, now);
+    std::lock_guard<std::mutex> lock(state.mu);
+    state.ping_outstanding = false;
+    failure_locked(state, now);
+}
+
+void FailureDetector::ping_missed(const std::string& peer) {
+    Peer* state = find(peer);
+    if (!state) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(state->mu);
+    state->ping_outstanding = false;
+}
+
+void FailureDetector::record_success(const std::string& peer) {
+    Peer* state = find(peer);
+    if (!state) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(state->mu);
+    state->consecutive_failures = 0;
+}
+
+void FailureDetector::record_failure(const std::string& peer, Clock::time_point now) {
+    Peer& state = peer_for(peer, now);
+    std::lock_guard<std::mutex> lock(state.mu);
+    failure_locked(state, now);
+}
+
+void FailureDetector::failure_locked(Peer& peer, Clock::time_point now) {
+    if (++peer.consecutive_failures >= options_.failure_threshold && !peer.open) {
+        peer.open = true;
+        peer.opened_at = now;
+    }
+}
+
+double FailureDetector::phi_locked(const Peer& peer, Clock::time_point now) const {
+    const auto mean = peer.intervals.empty()
+        ? std::chrono::duration<double>(options_.heartbeat_interval)
+        : std::chrono::duration<double>(peer.interval_sum) / static_cast<double>(peer.intervals.size());
+    const std::chrono::duration<double> silence = now - peer.silent_since;
+    if (silence.count() <= 0 || mean.count() <= 0) {
+        return 0.0;
+    }
+    // -log10(P(no heartbeat for `silence`)) with exponential intervals.
+    return silence / mean * std::log10(std::exp(1.0));
+}
+
+bool FailureDetector::allow_locked(Peer& peer, Clock::time_point now) {
+    if (!peer.open && phi_locked(peer, now) > options_.phi_threshold) {
+        peer.open = true;
+        peer.opened_at = now;
+    }
+    return !peer.open;
+}
+
+bool FailureDetector::allow(const std::string& peer, Clock::time_point now) {
+    Peer* state = find(peer);
+    if (!state) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(state->mu);
+    return allow_locked(*state, now);
+}
+
+double FailureDetector::phi(const std::string& peer, Clock::time_point now) const {
+    const Peer* state = find(peer);
+    if (!state) {
+        return 0.0;
+    }
+    std::lock_guard<std::mutex> lock(state->mu);
+    return phi_locked(*state, now);
+}
+
+std::vector<std::string> FailureDetector::down_peers(Clock::time_point now) const {
+    std::vector<std::string> down;
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    for (const auto& [name, state] : peers_) {
+        std::lock_guard<std::mutex> peer_lock(state->mu);
+        if (state->open || phi_locked(*state, now) > options_.phi_threshold) {
+            down.push_back(name);
+        }
+    }
+    std::sort(down.begin(), down.end());
+    return down;
+}
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+- Per-peer failure detection for replica RPCs, from two signals:
+  - phi accrual over heartbeats (successful pings): phi measures how unlikely
+    the current silence is, given the peer's recent heartbeat intervals
+    modelled as exponential. A peer whose phi passes phi_threshold is down.
+  - a circuit breaker over call outcomes: failure_threshold transport
+    failures in a row (requests or pings) open it.
+- Either one opens the peer's circuit, and allow() then turns calls away
+  without an RPC. The circuit stays open for at least open_duration; the
+  first heartbeat after that closes it.
+- Peers are tracked from their first ping or call; unknown peers are allowed.
+*/
+namespace kv::node {
+
+struct FailureDetectorOptions {
+    double phi_threshold = 8.0;
+    uint32_t failure_threshold = 3;
+    // Expected heartbeat interval, used until a peer has interval history.
+    std::chrono::milliseconds heartbeat_interval{100};
+    std::chrono::milliseconds open_duration{1000};
+    size_t window = 100;  // heartbeat intervals remembered per peer
+};
+
+class FailureDetector {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FailureDetector(const FailureDetectorOptions& options);
+
+    FailureDetector(const FailureDetector&) = delete;
+    FailureDetector& operator=(const FailureDetector&) = delete;
+
+    // Starts a ping to `peer`, unless one is still outstanding (returns
+    // false). The first ping starts the peer's silence clock.
+    bool begin_ping(const std::string& peer, Clock::time_point now = Clock::now());
+    void ping_succeeded(const std::string& peer, Clock::time_point now = Clock::now());
+    // A ping the peer refused counts as a failure; one it did not answer in
+    // time is only a missing heartbeat, which phi already accounts for.
+    void ping_failed(const std::string& peer, Clock::time_point now = Clock::now());
+    void ping_missed(const std::string& peer);
+
+    // Outcomes of replica RPCs; only transport failures should be recorded.
+    void record_success(const std::string& peer);
+    void record_failure(const std::string& peer, Clock::time_point now = Clock::now());
+
+    // False while `peer`'s circuit is open. Opens it if phi has passed the
+    // threshold.
+    bool allow(const std::string& peer, Clock::time_point now = Clock::now());
+
+    // Current suspicion of `peer`; 0 for unknown peers.
+    double phi(const std::string& peer, Clock::time_point now = Clock::now()) const;
+
+    // Peers allow() would turn away, sorted.
+    std::vector<std::string> down_peers(Clock::time_point now = Clock::now()) const;
+
+private:
+    struct Peer {
+        mutable std::mutex mu;
+        std::optional<Clock::time_point> last_heartbeat;
+        Clock::time_point silent_since;
+        std::deque<Clock::duration> intervals;
+        Clock::duration interval_sum{0};
+        uint32_t consecutive_failures = 0;
+        bool ping_outstanding = false;
+        bool open = false;
+        Clock::time_point opened_at;
+    };
+
+    Peer& peer_for(const std::string& peer, Clock::time_point now);
+    Peer* find(const std::string& peer) const;
+
+    double phi_locked(const Peer& peer, Clock::time_point now) const;
+    void failure_locked(Peer& peer, Clock::time_point now);
+    bool allow_locked(Peer& peer, Clock::time_point now);
+
+    const FailureDetectorOptions options_;
+
+    mutable std::shared_mutex mu_;
+    std::unordered_map<std::string, std::unique_ptr<Peer>> peers_;
+};
+
+}
@@ -0,0 +1,213 @@
+#include "node/hint_store.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+
+#include "utils/logging.h"
+
+namespace kv::node {
+
+namespace fs = std::filesystem;
+
+HintStore::HintStore(Options options) : options_(std::move(options)) {
+    if (options_.dir.empty()) {
+        return;
+    }
+    fs::create_directories(options_.dir);
+    for (const auto& entry : fs::directory_iterator(options_.dir)) {
+        if (!entry.is_directory()) {
+            continue;
+        }
+        const std::string target = decode_target(entry.path().filename().string());
+        Target& state = targets_[target];
+        kv::storage::WriteAheadLog::Options wal_options;
+        wal_options.dir = entry.path().string();
+        wal_options.sync_mode = options_.sync_mode;
+        state.wal = std::make_unique<kv::storage::WriteAheadLog>(
+            wal_options, [&](const std::string& key, ValueRef value, const Version& version) {
+                state.hints.push_back(Hint{key, std::move(value), version});
+                pending_bytes_ += size_of(state.hints.back());
+            });
+        pending_ += state.hints.size();
+        if (!state.hints.empty()) {
+            LOG_INFO("hint store: recovered " << state.hints.size() << " hints for " << target);
+        }
+    }
+}
+
+std::string HintStore::encode_target(const std::string& target) {
+    std::string name;
+    for (char ch : target) {
+        const auto c = static_cast<unsigned char>(ch);
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.') {
+            name.push_back(ch);
+        } else {
+            char escaped[4];
+            std::snprintf(escaped, sizeof(escaped), "%%%02X", c);
+            name.append(escaped);
+        }
+    }
+    // "." and ".." are not usable directory names.
+    if (name.find_first_not_of('.') == std::string::npos) {
+        name.insert(name.begin(), '%');
+    }
+    return name;
+}
+
+std::string HintStore::decode_target(const std::string& name) {
+    std::string target;
+    for (size_t i = 0; i < name.size(); ++i) {
+        unsigned int c = 0;
+        if (name[i] == '%' && i + 2 < name.size() &&
+            std::sscanf(name.c_str() + i + 1, "%2X", &c) == 1) {
+            target.push_back(static_cast<char>(c));
+            i += 2;
+        } else if (name[i] != '%') {
+            target.push_back(name[i]);
+        }
+    }
+    return target;
+}
+
+HintStore::Target& HintStore::target_for(const std::string& target) {
+    Target& state = targets_[target];
+    if (!state.wal && !options_.dir.empty()) {
+        kv::storage::WriteAheadLog::Options wal_options;
+        wal_options.dir = (fs::path(options_.dir) / encode_target(target)).string();
+        wal_options.sync_mode = options_.sync_mode;
+        state.wal = std::make_unique<kv::storage::WriteAheadLog>(
+            wal_options, [](const std::string&, ValueRef, const Version&) {});
+    }
+    return state;
+}
+
+bool HintStore::add(const std::string& target, const std::string& key, const ValueRef& value,
+                    const Version& version) {
+    return add(target, std::vector<Hint>{Hint{key, value, version}}) == 1;
+}
+
+size_t HintStore::add(const std::string& target, std::vector<Hint> hints) {
+    Target* state = nullptr;
+    size_t accepted = 0;
+    size_t accepted_bytes = 0;
+    uint64_t last_seq = 0;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        try {
+            state = &target_for(target);
+        } catch (const std::exception& e) {
+            LOG_INFO("hint store: cannot open the log for " << target << ": " << e.what());
+            dropped_ += hints.size();
+            return 0;
+        }
+        // Hints past the byte budget are dropped; the rest reserve their
+        // space now so concurrent adds cannot overshoot it.
+        while (accepted < hints.size() &&
+               pending_bytes_ + accepted_bytes + size_of(hints[accepted]) <= options_.max_bytes) {
+            accepted_bytes += size_of(hints[accepted]);
+            accepted++;
+        }
+        dropped_ += hints.size() - accepted;
+        hints.resize(accepted);
+        if (accepted == 0) {
+            return 0;
+        }
+        pending_bytes_ += accepted_bytes;
+
+        if (state->wal) {
+            // Enqueued here, synced below without the lock. remove() leaves
+            // the log alone while `logging` is non-zero, so it cannot
+            // truncate these records before they are visible.
+            for (const auto& hint : hints) {
+                last_seq = state->wal->enqueue(hint.key, hint.value.view(), hint.version);
+                if (last_seq == 0) {
+                    break;
+                }
+            }
+            state->logging++;
+        }
+    }
+
+    // One sync covers the whole batch.
+    const bool logged = !state->wal || state->wal->wait(last_seq);
+
+    std::lock_guard<std::mutex> lock(mu_);
+    if (state->wal) {
+        state->logging--;
+    }
+    if (!logged) {
+        pending_bytes_ -= accepted_bytes;
+        dropped_ += accepted;
+        return 0;
+    }
+    pending_ += accepted;
+    for (auto& hint : hints) {
+        state->hints.push_back(std::move(hint));
+    }
+    return accepted;
+}
+
+std::vector<std::string> HintStore::targets() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::vector<std::string> names;
+    for (const auto& [name, state] : targets_) {
+        if (!state.hints.empty()) {
+            names.push_back(name);
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+std::vector<Hint> HintStore::peek(const std::string& target, size_t max) const {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = targets_.find(target);
+    if (it == targets_.end()) {
+        return {};
+    }
+    const auto& hints = it->second.hints;
+    return std::vector<Hint>(hints.begin(),
+                             hints.begin() + static_cast<std::ptrdiff_t>(std::min(max, hints.size())));
+}
+
+void HintStore::remove(const std::string& target, size_t count) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = targets_.find(target);
+    if (it == targets_.end()) {
+        return;
+    }
+    Target& state = it->second;
+    count = std::min(count, state.hints.size());
+    for (size_t i = 0; i < count; ++i) {
+        pending_bytes_ -= size_of(state.hints.front());
+        state.hints.pop_front();
+    }
+    pending_ -= count;
+
+    // Once everything is delivered the log holds nothing worth replaying,
+    // unless an add() is still syncing hints it has not published yet.
+    if (state.hints.empty() && state.wal && state.logging == 0) {
+        if (uint64_t segment = state.wal->rotate()) {
+            state.wal->remove_segments_before(segment);
+        }
+    }
+}
+
+size_t HintStore::pending() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return pending_;
+}
+
+size_t HintStore::pending_bytes() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return pending_bytes_;
+}
+
+uint64_t HintStore::dropped() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return dropped_;
+}
+
+}
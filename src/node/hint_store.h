@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "node/version.h"
+#include "storage/wal.h"
+
+/*
+- Hinted handoff storage: writes held for replicas that could not take
+  them, queued per target node in arrival order until they are delivered.
+- With a dir, each target's hints also go to a write-ahead log in
+  <dir>/<target>, so they survive a restart; without one they live only in
+  memory. A target's log is truncated once all its hints are delivered;
+  until then a restart replays delivered hints too, which last-write-wins
+  makes harmless to deliver again.
+- Bounded by max_bytes of pending keys and values; hints beyond it are
+  dropped and the replica is left to read repair.
+*/
+namespace kv::node {
+
+struct Hint {
+    std::string key;
+    ValueRef value;
+    Version version;
+};
+
+class HintStore {
+public:
+    struct Options {
+        std::string dir;  // empty: memory only
+        size_t max_bytes = 64u << 20;
+        kv::storage::WalSyncMode sync_mode = kv::storage::WalSyncMode::Batch;
+    };
+
+    // Loads the hints left in options.dir. Throws std::runtime_error on I/O
+    // failure.
+    explicit HintStore(Options options);
+
+    HintStore(const HintStore&) = delete;
+    HintStore& operator=(const HintStore&) = delete;
+
+    // Queues a hint for `target`. False if the store is full or the hint
+    // could not be logged; the hint is then dropped. Blocks for the log's
+    // sync, but not while holding the store's lock.
+    bool add(const std::string& target, const std::string& key, const ValueRef& value,
+             const Version& version);
+
+    // Queues several hints for `target` with one log sync. Hints past the
+    // byte budget are dropped, and all of them are dropped if the log fails.
+    // Returns the number queued.
+    size_t add(const std::string& target, std::vector<Hint> hints);
+
+    // Targets with pending hints.
+    std::vector<std::string> targets() const;
+
+    // Up to `max` of `target`'s oldest pending hints.
+    std::vector<Hint> peek(const std::string& target, size_t max) const;
+
+    // Drops `target`'s `count` oldest hints once they have been delivered.
+    void remove(const std::string& target, size_t count);
+
+    size_t pending() const;
+    size_t pending_bytes() const;
+    uint64_t dropped() const;
+
+private:
+    struct Target {
+        std::deque<Hint> hints;
+        std::unique_ptr<kv::storage::WriteAheadLog> wal;
+        size_t logging = 0;  // add() calls syncing hints not yet in `hints`
+    };
+
+    static size_t size_of(const Hint& hint) { return hint.key.size() + hint.value.size(); }
+
+    // Directory name for a target's log; node ids are escaped so any id is a
+    // safe file name.
+    static std::string encode_target(const std::string& target);
+    static std::string decode_target(const std::string& name);
+
+    Target& target_for(const std::string& target);
+
+    const Options options_;
+
+    mutable std::mutex mu_;
+    // Entries are never erased, so a Target& stays valid without the lock.
+    std::unordered_map<std::string, Target> targets_;
+    size_t pending_ = 0;
+    size_t pending_bytes_ = 0;
+    uint64_t dropped_ = 0;
+};
+
+}
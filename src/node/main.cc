@@ -16,6 +16,7 @@ CLI:
   --id <node-id>
   --port <port>
   --config <cluster.yaml>
+  --data-dir <dir>        (overrides storage.data_dir; node id is appended)
 */
 
 int main(int argc, char** argv) {
@@ -23,6 +24,7 @@ int main(int argc, char** argv) {
     std::string config_path;
     int port = -1;
     std::string log_level_arg;
+    std::string data_dir_arg;
 
     // --------------------
     // Parse CLI args
@@ -37,12 +39,14 @@ int main(int argc, char** argv) {
             config_path = argv[++i];
         } else if (arg == "--log-level" && i + 1 < argc) {
             log_level_arg = argv[++i];
+        } else if (arg == "--data-dir" && i + 1 < argc) {
+            data_dir_arg = argv[++i];
         }
     }
 
     if (node_id.empty() || port <= 0 || config_path.empty()) {
         std::cerr << "Usage: kv_node --id <node-id> --port <port> --config <cluster.yaml> "
-                     "[--log-level <none|info|debug>]\n";
+                     "[--log-level <none|info|debug>] [--data-dir <dir>]\n";
         return 1;
     }
 
@@ -56,8 +60,6 @@ int main(int argc, char** argv) {
     // --------------------
     YAML::Node config = YAML::LoadFile(config_path);
 
-    kv::cluster::ClusterView cluster;
-
     YAML::Node cluster_nodes = config["cluster"]["seeds"];
     if (!cluster_nodes || !cluster_nodes.IsSequence()) {
         cluster_nodes = config["cluster"]["nodes"];
@@ -66,6 +68,30 @@ int main(int argc, char** argv) {
     // Parse replication settings from cluster config
     size_t replication_factor = 3;  // default
     int write_quorum = 1;           // default
+    int read_quorum = 1;            // default
+    size_t read_repair_queue_limit = 10000;  // default
+    size_t store_shards = 16;       // default
+    bool read_hedging = false;      // default
+    uint32_t hedge_delay_ms = 10;   // default
+    uint32_t hedge_budget_percent = 10;  // default
+    uint32_t replica_timeout_ms = 50;        // default
+    uint32_t replica_timeout_min_ms = 5;     // default
+    uint32_t replica_timeout_max_ms = 1000;  // default
+    bool failure_detection = true;           // default
+    uint32_t heartbeat_interval_ms = 100;    // default
+    double phi_threshold = 8.0;              // default
+    uint32_t failure_threshold = 3;          // default
+    uint32_t circuit_open_ms = 1000;         // default
+    bool hinted_handoff = true;              // default
+    size_t hint_limit_mb = 64;               // default
+    uint32_t handoff_interval_ms = 1000;     // default
+    size_t handoff_batch_size = 128;         // default
+    bool anti_entropy = true;                // default
+    uint32_t anti_entropy_interval_ms = 10000;  // default
+    uint32_t anti_entropy_keys_per_sec = 1000;  // default
+    uint32_t merkle_tree_depth = 8;          // default
+    size_t peer_channels = 2;       // default
+    kv::node::ChannelSelection peer_channel_selection = kv::node::ChannelSelection::LeastInflight;
 
     if (config["cluster"]["replication_factor"]) {
         replication_factor = config["cluster"]["replication_factor"].as<size_t>();
@@ -73,10 +99,157 @@ int main(int argc, char** argv) {
     if (config["cluster"]["write_quorum"]) {
         write_quorum = config["cluster"]["write_quorum"].as<int>();
     }
+    if (config["cluster"]["read_quorum"]) {
+        read_quorum = config["cluster"]["read_quorum"].as<int>();
+    }
+    if (config["cluster"]["store_shards"]) {
+        store_shards = config["cluster"]["store_shards"].as<size_t>();
+    }
+    if (config["cluster"]["read_repair_queue_limit"]) {
+        read_repair_queue_limit = config["cluster"]["read_repair_queue_limit"].as<size_t>();
+    }
+    if (config["cluster"]["read_hedging"]) {
+        read_hedging = config["cluster"]["read_hedging"].as<bool>();
+    }
+    if (config["cluster"]["hedge_delay_ms"]) {
+        hedge_delay_ms = config["cluster"]["hedge_delay_ms"].as<uint32_t>();
+    }
+    if (config["cluster"]["hedge_budget_percent"]) {
+        hedge_budget_percent = config["cluster"]["hedge_budget_percent"].as<uint32_t>();
+    }
+    if (config["cluster"]["replica_timeout_ms"]) {
+        replica_timeout_ms = config["cluster"]["replica_timeout_ms"].as<uint32_t>();
+    }
+    if (config["cluster"]["replica_timeout_min_ms"]) {
+        replica_timeout_min_ms = config["cluster"]["replica_timeout_min_ms"].as<uint32_t>();
+    }
+    if (config["cluster"]["replica_timeout_max_ms"]) {
+        replica_timeout_max_ms = config["cluster"]["replica_timeout_max_ms"].as<uint32_t>();
+    }
+    if (config["cluster"]["failure_detection"]) {
+        failure_detection = config["cluster"]["failure_detection"].as<bool>();
+    }
+    if (config["cluster"]["heartbeat_interval_ms"]) {
+        heartbeat_interval_ms = config["cluster"]["heartbeat_interval_ms"].as<uint32_t>();
+    }
+    if (config["cluster"]["phi_threshold"]) {
+        phi_threshold = config["cluster"]["phi_threshold"].as<double>();
+    }
+    if (config["cluster"]["failure_threshold"]) {
+        failure_threshold = config["cluster"]["failure_threshold"].as<uint32_t>();
+    }
+    if (config["cluster"]["circuit_open_ms"]) {
+        circuit_open_ms = config["cluster"]["circuit_open_ms"].as<uint32_t>();
+    }
+    if (config["cluster"]["hinted_handoff"]) {
+        hinted_handoff = config["cluster"]["hinted_handoff"].as<bool>();
+    }
+    if (config["cluster"]["hint_limit_mb"]) {
+        hint_limit_mb = config["cluster"]["hint_limit_mb"].as<size_t>();
+    }
+    if (config["cluster"]["handoff_interval_ms"]) {
+        handoff_interval_ms = config["cluster"]["handoff_interval_ms"].as<uint32_t>();
+    }
+    if (config["cluster"]["handoff_batch_size"]) {
+        handoff_batch_size = config["cluster"]["handoff_batch_size"].as<size_t>();
+    }
+    if (config["cluster"]["anti_entropy"]) {
+        anti_entropy = config["cluster"]["anti_entropy"].as<bool>();
+    }
+    if (config["cluster"]["anti_entropy_interval_ms"]) {
+        anti_entropy_interval_ms = config["cluster"]["anti_entropy_interval_ms"].as<uint32_t>();
+    }
+    if (config["cluster"]["anti_entropy_keys_per_sec"]) {
+        anti_entropy_keys_per_sec = config["cluster"]["anti_entropy_keys_per_sec"].as<uint32_t>();
+    }
+    if (config["cluster"]["merkle_tree_depth"]) {
+        merkle_tree_depth = config["cluster"]["merkle_tree_depth"].as<uint32_t>();
+    }
+    if (config["cluster"]["peer_channels"]) {
+        peer_channels = config["cluster"]["peer_channels"].as<size_t>();
+    }
+    if (config["cluster"]["peer_channel_selection"]) {
+        auto selection_name = config["cluster"]["peer_channel_selection"].as<std::string>();
+        auto selection = kv::node::parse_channel_selection(selection_name);
+        if (!selection) {
+            std::cerr << "Invalid config: unknown peer_channel_selection '" << selection_name << "'\n";
+            return 1;
+        }
+        peer_channel_selection = *selection;
+    }
+
+    // Parse server settings: "async" (completion queues, default) or "sync"
+    bool async_server = true;
+    kv::AsyncServerOptions server_options;
+    if (config["server"]["mode"]) {
+        auto mode_name = config["server"]["mode"].as<std::string>();
+        if (mode_name != "async" && mode_name != "sync") {
+            std::cerr << "Invalid config: unknown server mode '" << mode_name << "'\n";
+            return 1;
+        }
+        async_server = mode_name == "async";
+    }
+    if (config["server"]["completion_queues"]) {
+        server_options.completion_queues = config["server"]["completion_queues"].as<size_t>();
+    }
+    if (config["server"]["threads"]) {
+        server_options.threads = config["server"]["threads"].as<size_t>();
+    }
+    if (auto err = server_options.validate()) {
+        std::cerr << "Invalid config: " << *err << "\n";
+        return 1;
+    }
+
+    // Parse storage settings; each node keeps its files under data_dir/<node-id>
+    std::string data_dir = data_dir_arg;
+    kv::storage::WalSyncMode wal_sync_mode = kv::storage::WalSyncMode::Batch;  // default
+    uint32_t wal_sync_interval_ms = 10;  // default
+    uint32_t checkpoint_interval_s = 0;  // default (disabled)
+    kv::storage::StorageEngineKind storage_engine = kv::storage::StorageEngineKind::Memory;
+    size_t lsm_memtable_mb = 64;         // default
+    size_t lsm_compaction_trigger = 4;   // default
+
+    if (data_dir.empty() && config["storage"]["data_dir"]) {
+        data_dir = config["storage"]["data_dir"].as<std::string>();
+    }
+    if (config["storage"]["wal_sync_mode"]) {
+        auto mode_name = config["storage"]["wal_sync_mode"].as<std::string>();
+        auto mode = kv::storage::parse_wal_sync_mode(mode_name);
+        if (!mode) {
+            std::cerr << "Invalid config: unknown wal_sync_mode '" << mode_name << "'\n";
+            return 1;
+        }
+        wal_sync_mode = *mode;
+    }
+    if (config["storage"]["wal_sync_interval_ms"]) {
+        wal_sync_interval_ms = config["storage"]["wal_sync_interval_ms"].as<uint32_t>();
+    }
+    if (config["storage"]["checkpoint_interval_s"]) {
+        checkpoint_interval_s = config["storage"]["checkpoint_interval_s"].as<uint32_t>();
+    }
+    if (config["storage"]["engine"]) {
+        auto engine_name = config["storage"]["engine"].as<std::string>();
+        auto engine = kv::storage::parse_storage_engine(engine_name);
+        if (!engine) {
+            std::cerr << "Invalid config: unknown storage engine '" << engine_name << "'\n";
+            return 1;
+        }
+        storage_engine = *engine;
+    }
+    if (config["storage"]["lsm_memtable_mb"]) {
+        lsm_memtable_mb = config["storage"]["lsm_memtable_mb"].as<size_t>();
+    }
+    if (config["storage"]["lsm_compaction_trigger"]) {
+        lsm_compaction_trigger = config["storage"]["lsm_compaction_trigger"].as<size_t>();
+    }
 
     LOG_INFO("Cluster config: RF=" << replication_factor
              << " W=" << write_quorum
-             << " (reads use LWW)");
+             << " R=" << read_quorum
+             << " (reads use LWW)"
+             << " storage=" << kv::storage::to_string(storage_engine));
+
+    kv::cluster::ClusterView cluster(100, replication_factor);
 
     std::string self_address_from_config;
     if (cluster_nodes && cluster_nodes.IsSequence()) {
@@ -110,14 +283,68 @@ int main(int argc, char** argv) {
     node_config.port = port;
     node_config.replication_factor = replication_factor;
     node_config.write_quorum = write_quorum;
+    node_config.read_quorum = read_quorum;
+    node_config.read_repair_queue_limit = read_repair_queue_limit;
+    node_config.store_shards = store_shards;
+    node_config.read_hedging = read_hedging;
+    node_config.hedge_delay_ms = hedge_delay_ms;
+    node_config.hedge_budget_percent = hedge_budget_percent;
+    node_config.replica_timeout_ms = replica_timeout_ms;
+    node_config.replica_timeout_min_ms = replica_timeout_min_ms;
+    node_config.replica_timeout_max_ms = replica_timeout_max_ms;
+    node_config.failure_detection = failure_detection;
+    node_config.heartbeat_interval_ms = heartbeat_interval_ms;
+    node_config.phi_threshold = phi_threshold;
+    node_config.failure_threshold = failure_threshold;
+    node_config.circuit_open_ms = circuit_open_ms;
+    node_config.hinted_handoff = hinted_handoff;
+    node_config.hint_limit_bytes = hint_limit_mb << 20;
+    node_config.handoff_interval_ms = handoff_interval_ms;
+    node_config.handoff_batch_size = handoff_batch_size;
+    node_config.anti_entropy = anti_entropy;
+    node_config.anti_entropy_interval_ms = anti_entropy_interval_ms;
+    node_config.anti_entropy_keys_per_sec = anti_entropy_keys_per_sec;
+    node_config.merkle_tree_depth = merkle_tree_depth;
+    node_config.peer_channels = peer_channels;
+    node_config.peer_channel_selection = peer_channel_selection;
+    if (!data_dir.empty()) {
+        node_config.data_dir = data_dir + "/" + node_id;
+    }
+    node_config.wal_sync_mode = wal_sync_mode;
+    node_config.wal_sync_interval_ms = wal_sync_interval_ms;
+    node_config.checkpoint_interval_s = checkpoint_interval_s;
+    node_config.storage_engine = storage_engine;
+    node_config.lsm_memtable_bytes = lsm_memtable_mb << 20;
+    node_config.lsm_compaction_trigger = lsm_compaction_trigger;
 
     if (auto err = node_config.validate()) {
         std::cerr << "Invalid config: " << *err << "\n";
         return 1;
     }
 
-    kv::node::Node node(node_config, cluster);
-    kv::NodeRpcService service(node);
+    std::unique_ptr<kv::node::Node> node;
+    try {
+        node = std::make_unique<kv::node::Node>(node_config, cluster);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to start node: " << e.what() << "\n";
+        return 1;
+    }
+    if (async_server) {
+        std::unique_ptr<kv::AsyncNodeServer> server;
+        try {
+            server = std::make_unique<kv::AsyncNodeServer>(*node, listen_addr, server_options);
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to start server: " << e.what() << "\n";
+            return 1;
+        }
+        LOG_INFO("Node " << node_id << " listening on " << listen_addr
+                 << " (async, cqs=" << server_options.completion_queues
+                 << " threads=" << server_options.threads << ")");
+        server->wait();
+        return 0;
+    }
+
+    kv::NodeRpcService service(*node);
 
     grpc::ServerBuilder builder;
     builder.AddListeningPort(listen_addr, grpc::InsecureServerCredentials());
@@ -125,7 +352,7 @@ int main(int argc, char** argv) {
 
     std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
 
-    LOG_INFO("Node " << node_id << " listening on " << listen_addr);
+    LOG_INFO("Node " << node_id << " listening on " << listen_addr << " (sync)");
 
     server->Wait();
     return 0;
@@ -0,0 +1,112 @@
+#include "node/merkle_tree.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "hash/murmur3.h"
+
+namespace kv::node {
+
+namespace {
+constexpr uint64_t MERKLE_SEED = 0x6d65726b;
+
+bool contains(const kv::ring::TokenRange& range, uint64_t token) {
+    if (range.start < range.end) {
+        return token > range.start && token <= range.end;
+    }
+    return token > range.start || token <= range.end;  // wraps, or the whole ring
+}
+}
+
+MerkleTree::MerkleTree(uint32_t depth) : depth_(depth) {
+    if (depth > MAX_DEPTH) {
+        throw std::invalid_argument("merkle tree depth must be <= " + std::to_string(MAX_DEPTH));
+    }
+    leaves_.reset(new std::atomic<uint64_t>[leaf_count()]);
+    for (size_t i = 0; i < leaf_count(); ++i) {
+        leaves_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+std::vector<uint64_t> MerkleTree::level(uint32_t n) const {
+    std::vector<uint64_t> hashes(leaf_count());
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        hashes[i] = leaf(i);
+    }
+    // Fold pairs upward in place until level n is reached.
+    for (uint32_t d = depth_; d > n; --d) {
+        const size_t width = size_t{1} << (d - 1);
+        for (size_t i = 0; i < width; ++i) {
+            const uint64_t children[2] = {hashes[2 * i], hashes[2 * i + 1]};
+            hashes[i] = kv::hash::murmur3_64(children, sizeof(children), MERKLE_SEED);
+        }
+        hashes.resize(width);
+    }
+    return hashes;
+}
+
+uint64_t MerkleTree::entry_hash(uint64_t token, const Version& version) {
+    const uint64_t parts[2] = {version.write_created_at_us, version.writer};
+    return kv::hash::murmur3_64(parts, sizeof(parts), token);
+}
+
+MerkleRanges::MerkleRanges(std::vector<kv::ring::TokenRange> ranges, uint32_t depth)
+    : ranges_(std::move(ranges)), depth_(depth) {
+    trees_.reserve(ranges_.size());
+    for (size_t i = 0; i < ranges_.size(); ++i) {
+        trees_.push_back(std::make_unique<MerkleTree>(depth));
+    }
+}
+
+std::optional<size_t> MerkleRanges::find(uint64_t token) const {
+    if (ranges_.empty()) {
+        return std::nullopt;
+    }
+    // The first range ending at or after the token is the only one that can
+    // hold it; past the last end, only a range wrapping through zero can.
+    auto it = std::lower_bound(ranges_.begin(), ranges_.end(), token,
+                               [](const kv::ring::TokenRange& r, uint64_t t) { return r.end < t; });
+    const size_t i = it == ranges_.end() ? 0 : static_cast<size_t>(it - ranges_.begin());
+    if (!contains(ranges_[i], token)) {
+        return std::nullopt;
+    }
+    return i;
+}
+
+std::optional<size_t> MerkleRanges::find(uint64_t start, uint64_t end) const {
+    auto it = std::lower_bound(ranges_.begin(), ranges_.end(), end,
+                               [](const kv::ring::TokenRange& r, uint64_t e) { return r.end < e; });
+    if (it == ranges_.end() || it->end != end || it->start != start) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(it - ranges_.begin());
+}
+
+size_t MerkleRanges::leaf_for(size_t range, uint64_t token) const {
+    // Tokens start+1 .. end map to offsets 0 .. width-1, in leaf-sized
+    // slices; a width of 0 is the whole ring.
+    if (depth_ == 0) {
+        return 0;
+    }
+    const auto& r = ranges_[range];
+    const uint64_t offset = token - r.start - 1;
+    const uint64_t width = r.end - r.start;
+    const uint64_t slice = width == 0 ? uint64_t{1} << (64 - depth_)
+                                      : (width >> depth_) + 1;
+    return static_cast<size_t>(offset / slice);
+}
+
+void MerkleRanges::update(uint64_t token, const std::optional<Version>& previous,
+                          const Version& version) {
+    auto range = find(token);
+    if (!range) {
+        return;
+    }
+    uint64_t delta = MerkleTree::entry_hash(token, version);
+    if (previous) {
+        delta ^= MerkleTree::entry_hash(token, *previous);
+    }
+    trees_[*range]->toggle(leaf_for(*range, token), delta);
+}
+
+}
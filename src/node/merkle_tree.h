@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "node/version.h"
+#include "ring/consistent_hash_ring.h"
+
+/*
+- Merkle trees for anti-entropy: one per token range a node replicates, so
+  two replicas of a range can compare what they hold level by level and
+  find the few leaves where they differ.
+- A leaf covers an equal slice of its range's tokens and holds the XOR of
+  murmur3(key, version) over the entries in that slice. XOR is its own
+  inverse, so a write updates its leaf in place (out with the replaced
+  version, in with the new one) with one atomic op and no lock.
+- Inner nodes are derived from the leaves when a level is asked for; only
+  the anti-entropy exchange reads them, and it is rare next to writes.
+*/
+namespace kv::node {
+
+class MerkleTree {
+public:
+    static constexpr uint32_t MAX_DEPTH = 16;
+
+    // 2^depth leaves, all empty. depth must be at most MAX_DEPTH.
+    explicit MerkleTree(uint32_t depth);
+
+    MerkleTree(const MerkleTree&) = delete;
+    MerkleTree& operator=(const MerkleTree&) = delete;
+
+    uint32_t depth() const { return depth_; }
+    size_t leaf_count() const { return size_t{1} << depth_; }
+
+    // Folds an entry hash into (or back out of) a leaf.
+    void toggle(size_t index, uint64_t hash) {
+        leaves_[index].fetch_xor(hash, std::memory_order_relaxed);
+    }
+    uint64_t leaf(size_t index) const { return leaves_[index].load(std::memory_order_relaxed); }
+    void set_leaf(size_t index, uint64_t hash) {
+        leaves_[index].store(hash, std::memory_order_relaxed);
+    }
+
+    // The 2^n hashes of level n, left to right; level 0 is the root and
+    // level depth() the leaves. n must be at most depth().
+    std::vector<uint64_t> level(uint32_t n) const;
+
+    // An entry's contribution to its leaf. `token` is the key's ring token,
+    // itself the murmur3 hash of the key.
+    static uint64_t entry_hash(uint64_t token, const Version& version);
+
+private:
+    uint32_t depth_;
+    std::unique_ptr<std::atomic<uint64_t>[]> leaves_;
+};
+
+// A node's trees, one per token range it replicates. The set of ranges is
+// fixed at construction; a membership change means building a new one.
+class MerkleRanges {
+public:
+    // `ranges` must be ordered by end token, as ranges_for() returns them.
+    MerkleRanges(std::vector<kv::ring::TokenRange> ranges, uint32_t depth);
+
+    const std::vector<kv::ring::TokenRange>& ranges() const { return ranges_; }
+    uint32_t depth() const { return depth_; }
+
+    // Index of the range holding `token`, if any.
+    std::optional<size_t> find(uint64_t token) const;
+    // Index of the range with exactly these bounds, if any.
+    std::optional<size_t> find(uint64_t start, uint64_t end) const;
+
+    // The leaf of range `range`'s tree that `token` falls in.
+    size_t leaf_for(size_t range, uint64_t token) const;
+
+    MerkleTree& tree(size_t range) { return *trees_[range]; }
+    const MerkleTree& tree(size_t range) const { return *trees_[range]; }
+
+    // Records a write that replaced `previous` (if any) with `version`. Keys
+    // outside every range are ignored.
+    void update(uint64_t token, const std::optional<Version>& previous, const Version& version);
+
+private:
+    std::vector<kv::ring::TokenRange> ranges_;
+    uint32_t depth_;
+    std::vector<std::unique_ptr<MerkleTree>> trees_;
+};
+
+}
@@ -1,12 +1,16 @@
 #include "node/node.h"
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <condition_variable>
+#include <future>
 #include <vector>
 #include <sstream>
 #include <grpcpp/grpcpp.h>
 
 #include "kv.grpc.pb.h"
+#include "storage/epoch.h"
 #include "utils/logging.h"
 
 namespace kv::node {
@@ -22,66 +26,306 @@ std::string format_list(const std::vector<std::string>& items) {
     }
     return oss.str();
 }
+
+// Converts an internal GetResponse into a StoreEntry (nullopt if not found).
+// The value is moved out of the response rather than copied.
+std::optional<StoreEntry> entry_from_response(kvstore::GetResponse& resp) {
+    if (!resp.found()) {
+        return std::nullopt;
+    }
+
+    Version version{
+        resp.version().write_created_at_us(),
+        resp.version().writer()
+    };
+
+    return StoreEntry{ValueRef(std::move(*resp.mutable_value())), version};
+}
+
+// Hands each entry of a replica batch's result to that key's quorum, which
+// expected one result from the batch.
+template <typename T>
+coro::Detached complete_batch(coro::Task<std::vector<T>> batch,
+                              std::vector<std::shared_ptr<coro::Quorum<T>>> quorums) {
+    auto results = co_await std::move(batch);
+    for (size_t j = 0; j < quorums.size(); ++j) {
+        quorums[j]->complete(std::move(results[j]));
+    }
+}
+
+uint64_t now_us() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
 }  
 
+namespace {
+kv::storage::StorageEngineOptions engine_options(const kv::NodeConfig& config) {
+    kv::storage::StorageEngineOptions options;
+    options.kind = config.storage_engine;
+    options.data_dir = config.data_dir;
+    options.wal_sync_mode = config.wal_sync_mode;
+    options.wal_sync_interval = std::chrono::milliseconds(config.wal_sync_interval_ms);
+    options.memory_shards = config.store_shards;
+    options.lsm_memtable_bytes = config.lsm_memtable_bytes;
+    options.lsm_compaction_trigger = config.lsm_compaction_trigger;
+    options.log_prefix = "[node=" + config.node_id + "] ";
+    return options;
+}
+
+kv::node::HintStore::Options hint_store_options(const kv::NodeConfig& config) {
+    kv::node::HintStore::Options options;
+    if (!config.data_dir.empty()) {
+        options.dir = config.data_dir + "/hints";
+    }
+    options.max_bytes = config.hint_limit_bytes;
+    options.sync_mode = config.wal_sync_mode;
+    return options;
+}
+
+kv::node::FailureDetectorOptions failure_detector_options(const kv::NodeConfig& config) {
+    kv::node::FailureDetectorOptions options;
+    options.phi_threshold = config.phi_threshold;
+    options.failure_threshold = config.failure_threshold;
+    options.heartbeat_interval = std::chrono::milliseconds(config.heartbeat_interval_ms);
+    options.open_duration = std::chrono::milliseconds(config.circuit_open_ms);
+    return options;
+}
+}
+
 Node::Node(const kv::NodeConfig& config, kv::cluster::ClusterView& cluster)
     : config_(config),
-      cluster_(cluster) {}
+      cluster_(cluster),
+      writer_(cluster.intern_writer(config.node_id)),
+      // Recovery runs before any Node thread starts, so a failure can simply throw.
+      engine_(kv::storage::make_storage_engine(engine_options(config))),
+      channels_(cluster, config.peer_channels, config.peer_channel_selection),
+      health_(failure_detector_options(config)),
+      hints_(hint_store_options(config)),
+      cq_thread_([this] { poll_completion_queue(); }),
+      hint_writers_(config.hinted_handoff ? HINT_WRITERS : 0),
+      repair_queue_(config.read_repair_queue_limit,
+                    [this](const RepairTask& task) { apply_read_repair(task); }) {
+    std::vector<std::string> peers;
+    for (auto& id : cluster_.get_node_ids()) {
+        if (id != config_.node_id) {
+            peers.push_back(std::move(id));
+        }
+    }
+    channels_.warm_up(peers);
+
+    // Start with a full burst of hedges, unless hedging has no budget at all.
+    hedge_credit_.store(config_.hedge_budget_percent > 0 ? HEDGE_COST * HEDGE_BURST : 0,
+                        std::memory_order_relaxed);
+
+    if (!config_.data_dir.empty() && config_.checkpoint_interval_s > 0) {
+        checkpoint_thread_ = std::thread([this] { checkpoint_loop(); });
+    }
+    if (config_.failure_detection) {
+        heartbeat_thread_ = std::thread([this] { heartbeat_loop(); });
+    }
+    if (config_.hinted_handoff) {
+        handoff_thread_ = std::thread([this] { handoff_loop(); });
+    }
+    if (config_.anti_entropy) {
+        anti_entropy_thread_ = std::thread([this] { anti_entropy_loop(); });
+    }
+}
+
+bool Node::checkpoint() {
+    return engine_->checkpoint();
+}
+
+void Node::checkpoint_loop() {
+    const auto interval = std::chrono::seconds(config_.checkpoint_interval_s);
+    std::unique_lock<std::mutex> lock(checkpoint_stop_mu_);
+    while (!checkpoint_stop_cv_.wait_for(lock, interval, [this] { return checkpoint_stopping_; })) {
+        lock.unlock();
+        checkpoint();
+        lock.lock();
+    }
+}
+
+Node::~Node() {
+    if (checkpoint_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(checkpoint_stop_mu_);
+            checkpoint_stopping_ = true;
+        }
+        checkpoint_stop_cv_.notify_all();
+        checkpoint_thread_.join();
+    }
+    if (heartbeat_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(heartbeat_stop_mu_);
+            heartbeat_stopping_ = true;
+        }
+        heartbeat_stop_cv_.notify_all();
+        heartbeat_thread_.join();
+    }
+    if (handoff_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(handoff_stop_mu_);
+            handoff_stopping_ = true;
+        }
+        handoff_stop_cv_.notify_all();
+        handoff_thread_.join();
+    }
+    if (anti_entropy_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(anti_entropy_stop_mu_);
+            anti_entropy_stopping_ = true;
+        }
+        anti_entropy_stop_cv_.notify_all();
+        anti_entropy_thread_.join();
+    }
+    // Hint writers resume their coroutines, which may still issue RPCs, so
+    // they finish before the queue shuts down; hints from the drain below
+    // are then logged inline.
+    hint_writers_.stop();
+
+    // Shutdown lets the poller drain every pending RPC (pings included) before Next() returns
+    // false, so no completion runs after the stubs and channels are gone.
+    // Late GET replies may still enqueue repairs while draining, so the
+    // repair worker is stopped only afterwards.
+    cq_.Shutdown();
+    cq_thread_.join();
+    repair_queue_.stop();
+
+    // Repairs update the trees through apply_put_local(); with the repair
+    // worker and every background thread gone, and servers stopped before
+    // their node is destroyed, nothing can still be reading them.
+    delete merkle_.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+bool Node::put(const std::string& key, std::string value) {
+    auto result = std::make_shared<std::promise<bool>>();
+    auto future = result->get_future();
+    put_async(key, std::move(value), [result](bool ok) { result->set_value(ok); });
+    return future.get();
+}
+
+std::optional<StoreEntry> Node::get(const std::string& key) {
+    auto result = std::make_shared<std::promise<std::optional<StoreEntry>>>();
+    auto future = result->get_future();
+    get_async(key, [result](std::optional<StoreEntry> entry) { result->set_value(std::move(entry)); });
+    return future.get();
+}
+
+std::vector<bool> Node::multi_put(std::vector<std::pair<std::string, std::string>> items) {
+    auto result = std::make_shared<std::promise<std::vector<bool>>>();
+    auto future = result->get_future();
+    multi_put_async(std::move(items),
+        [result](std::vector<bool> oks) { result->set_value(std::move(oks)); });
+    return future.get();
+}
+
+std::vector<std::optional<StoreEntry>> Node::multi_get(const std::vector<std::string>& keys) {
+    auto result = std::make_shared<std::promise<std::vector<std::optional<StoreEntry>>>>();
+    auto future = result->get_future();
+    multi_get_async(keys,
+        [result](std::vector<std::optional<StoreEntry>> entries) { result->set_value(std::move(entries)); });
+    return future.get();
+}
+
+void Node::put_async(const std::string& key, std::string value, std::function<void(bool)> done) {
+    coro::spawn(coordinate_put(key, std::move(value)), std::move(done));
+}
+
+void Node::get_async(const std::string& key, std::function<void(std::optional<StoreEntry>)> done) {
+    coro::spawn(coordinate_get(key), std::move(done));
+}
+
+void Node::multi_put_async(std::vector<std::pair<std::string, std::string>> items,
+                           std::function<void(std::vector<bool>)> done) {
+    coro::spawn(coordinate_multi_put(std::move(items)), std::move(done));
+}
+
+void Node::multi_get_async(const std::vector<std::string>& keys,
+                           std::function<void(std::vector<std::optional<StoreEntry>>)> done) {
+    coro::spawn(coordinate_multi_get(keys), std::move(done));
+}
 
-bool Node::put(const std::string& key, const std::string& value) {
+coro::Task<bool> Node::coordinate_put(std::string key, std::string value) {
     write_count_.fetch_add(1, std::memory_order_relaxed);
     const size_t RF = config_.replication_factor;
     const int W = config_.write_quorum;
 
     auto replicas = cluster_.get_replica_set_for_key(key, RF);
 
-    auto now = std::chrono::system_clock::now();
-    auto write_created_at_us = std::chrono::duration_cast<std::chrono::microseconds>(
-        now.time_since_epoch()
-    ).count();
-
-    Version version{
-        static_cast<uint64_t>(write_created_at_us),
-        config_.node_id
-    };
+    Version version{now_us(), writer_};
 
     LOG_DEBUG("[node=" << config_.node_id << "] PUT version (key=" << key
               << "): write_created_at_us=" << version.write_created_at_us
-              << " writer=" << version.writer_id);
+              << " writer=" << version.writer);
 
     if (kv::log::g_log_level == kv::log::LogLevel::Debug) {
         LOG_DEBUG("[node=" << config_.node_id << "] PUT preference list (key=" << key
                   << "): " << format_list(replicas));
     }
 
-    int acks = 0;
+    // With early return the wait ends at W acks, or as soon as W is out of
+    // reach, and stragglers finish in the background; otherwise it waits
+    // for every replica.
+    const bool early_return = early_write_return();
+    auto acks = std::make_shared<coro::Quorum<bool>>(
+        early_return ? static_cast<size_t>(W) : replicas.size(),
+        [](const bool& ok) { return ok; },
+        early_return);
 
+    bool write_local = false;
+    std::vector<const std::string*> remotes;
+    remotes.reserve(replicas.size());
     for (const auto& replica_id : replicas) {
         if (replica_id == config_.node_id) {
-            if (apply_put_local(key, value, version)) {
-                acks++;
-            }
+            write_local = true;
         } else {
+            remotes.push_back(&replica_id);
+        }
+    }
+
+    // Issue every remote write before applying locally so the local apply
+    // overlaps with the network round-trips. One request is shared by all
+    // replica RPCs, and the local store aliases the value it carries, so the
+    // payload is never copied on the coordinator.
+    ValueRef stored;
+    std::shared_ptr<kvstore::PutRequest> request;
+    if (remotes.empty()) {
+        stored = ValueRef(std::move(value));
+    } else {
+        request = make_internal_put_request(key, std::move(value), version);
+        stored = ValueRef(std::shared_ptr<const std::string>(request, &request->value()));
+        auto fallbacks = config_.hinted_handoff ? fallbacks_for(key, replicas.size()) : nullptr;
+        for (const std::string* replica_id : remotes) {
             LOG_DEBUG("[node=" << config_.node_id
-                      << "] forwarding PUT to " << replica_id
+                      << "] forwarding PUT to " << *replica_id
                       << " (key=" << key << ")");
-
-            if (forward_put(replica_id, key, value, version)) {
-                acks++;
+            if (fallbacks) {
+                acks->run(put_replica(*replica_id, request, fallbacks));
+            } else {
+                acks->run(forward_put_async(*replica_id, request, write_timeout(*replica_id)));
             }
         }
     }
 
+    if (write_local) {
+        acks->add(apply_put_local(key, std::move(stored), version));
+    }
+
+    // Nothing is decided before the local apply is done.
+    auto results = co_await acks->wait();
+    const bool ok = std::count(results.begin(), results.end(), true) >= W;
+
     LOG_DEBUG("[node=" << config_.node_id << "] PUT key=" << key
-              << " acks=" << acks << "/" << replicas.size()
+              << " replicas=" << replicas.size() << " ok=" << (ok ? "true" : "false")
               << " (W=" << W << ")");
-
-    return acks >= W;
+    co_return ok;
 }
 
-std::optional<StoreEntry> Node::get(const std::string& key) {
+coro::Task<std::optional<StoreEntry>> Node::coordinate_get(std::string key) {
     read_count_.fetch_add(1, std::memory_order_relaxed);
     const size_t RF = config_.replication_factor;
+    const size_t R = static_cast<size_t>(config_.read_quorum);
     auto replicas = cluster_.get_replica_set_for_key(key, RF);
 
     if (kv::log::g_log_level == kv::log::LogLevel::Debug) {
@@ -89,138 +333,851 @@ std::optional<StoreEntry> Node::get(const std::string& key) {
                   << "): " << format_list(replicas));
     }
 
-    struct ReplicaRead {
-        std::string node_id;
-        std::optional<StoreEntry> entry;
-    };
-
-    std::vector<ReplicaRead> reads;
-    reads.reserve(replicas.size());
+    // Waits for R replies, or for every RPC to settle if fewer than R
+    // replicas can answer. A failed RPC is not a reply.
+    auto replies = std::make_shared<coro::Quorum<ReplicaRead>>(
+        R, [](const ReplicaRead& read) { return read.ok; });
 
+    bool read_local = false;
+    std::vector<const std::string*> remotes;
+    remotes.reserve(replicas.size());
     for (const auto& replica_id : replicas) {
-        std::optional<StoreEntry> entry;
+        if (replica_id == config_.node_id) {
+            read_local = true;
+        } else {
+            remotes.push_back(&replica_id);
+        }
+    }
+
+    // Fastest replicas first: they are the ones a hedged read contacts, and
+    // the rest are hedged to in order of expected latency.
+    order_for_contact(remotes);
 
+    std::shared_ptr<kvstore::GetRequest> request;
+    if (!remotes.empty()) {
+        request = std::make_shared<kvstore::GetRequest>();
+        request->set_key(key);
+        request->set_is_internal(true);
+    }
+
+    // Without hedging every replica is contacted now. With it, only as many
+    // as R needs beyond the local read; the rest of the preference list is
+    // held back for hedges and for replacing replicas that fail.
+    const bool hedging = config_.read_hedging;
+    size_t contacted = remotes.size();
+    if (hedging) {
+        earn_hedge_credit();
+        const size_t needed = R - std::min<size_t>(R, read_local ? 1 : 0);
+        contacted = std::min(remotes.size(), needed);
+    }
+    for (size_t i = 0; i < contacted; ++i) {
         LOG_DEBUG("[node=" << config_.node_id
-                  << "] GET contacting replica " << replica_id);
+                  << "] GET contacting replica " << *remotes[i]);
+        replies->run(forward_get_async(*remotes[i], request, read_timeout(*remotes[i])));
+    }
 
-        if (replica_id == config_.node_id) {
-            entry = local_get(key);
+    if (read_local) {
+        replies->add(local_read(key));
+    }
+
+    std::vector<const std::string*> hedges;
+    while (contacted < remotes.size()) {
+        const bool ready = co_await replies->ready_by(
+            &cq_, std::chrono::system_clock::now() + hedge_delay(remotes, contacted));
+        if (replies->accepted() >= R) {
+            break;
+        }
+        if (ready) {
+            // Every contacted replica has answered or failed, still short of
+            // R: replace the failures without touching the hedge budget.
+            LOG_DEBUG("[node=" << config_.node_id << "] GET retrying on "
+                      << *remotes[contacted] << " (key=" << key << ")");
         } else {
-            entry = forward_get(replica_id, key, std::chrono::milliseconds(50));
+            if (!spend_hedge_credit()) {
+                break;
+            }
+            hedge_count_.fetch_add(1, std::memory_order_relaxed);
+            hedges.push_back(remotes[contacted]);
+            LOG_DEBUG("[node=" << config_.node_id << "] GET hedging to "
+                      << *remotes[contacted] << " (key=" << key << ")");
         }
+        replies->run(forward_get_async(*remotes[contacted], request, read_timeout(*remotes[contacted])));
+        contacted++;
+    }
 
-        if (!entry) {
-            LOG_DEBUG("[node=" << config_.node_id
-                      << "] GET miss from " << replica_id);
+    auto reads = co_await replies->wait();
+
+    // A hedge won if its reply made it into the answer.
+    for (const std::string* hedge : hedges) {
+        for (const auto& read : reads) {
+            if (read.ok && read.node_id == *hedge) {
+                hedge_won_count_.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
         }
+    }
 
-        reads.push_back(ReplicaRead{replica_id, entry});
+    LOG_DEBUG("[node=" << config_.node_id << "] GET key=" << key
+              << " replies=" << std::count_if(reads.begin(), reads.end(),
+                                              [](const ReplicaRead& read) { return read.ok; })
+              << "/" << replicas.size() << " (R=" << R << ")");
+
+    auto best = resolve_reads(key, reads);
+
+    // Late replies: the client already has its answer, but a stale replica
+    // is still worth repairing.
+    if (best) {
+        replies->on_late([this, key, winner = *best](ReplicaRead read) {
+            if (read.ok && (!read.entry || is_newer(winner.version, read.entry->version))) {
+                enqueue_read_repair(read.node_id, key, winner);
+            }
+        });
     }
+    co_return best;
+}
 
-    std::optional<StoreEntry> best;
-    std::string best_node;
+coro::Task<std::vector<bool>> Node::coordinate_multi_put(
+        std::vector<std::pair<std::string, std::string>> items) {
+    const size_t n = items.size();
+    write_count_.fetch_add(n, std::memory_order_relaxed);
+    const size_t RF = config_.replication_factor;
+    const int W = config_.write_quorum;
+    const Version version{now_us(), writer_};
+    const bool early_return = early_write_return();
 
-    for (const auto& read : reads) {
-        if (read.entry) {
-            LOG_DEBUG("[node=" << config_.node_id << "] GET candidate (key=" << key
-                      << ") from " << read.node_id
-                      << " write_created_at_us=" << read.entry->version.write_created_at_us
-                      << " writer=" << read.entry->version.writer_id);
-
-            if (!best || is_newer(read.entry->version, best->version)) {
-                best = *read.entry;
-                best_node = read.node_id;
+    // One quorum per key, as in coordinate_put(); each replica batch
+    // completes one expected result in every quorum it covers.
+    std::vector<std::shared_ptr<coro::Quorum<bool>>> acks(n);
+
+    struct ReplicaBatch {
+        std::shared_ptr<kvstore::MultiPutRequest> request;
+        std::vector<std::shared_ptr<coro::Quorum<bool>>> keys;  // per request entry
+    };
+    std::unordered_map<std::string, ReplicaBatch> batches;
+    std::vector<bool> write_local(n, false);
+
+    for (size_t i = 0; i < n; ++i) {
+        auto replicas = cluster_.get_replica_set_for_key(items[i].first, RF);
+        acks[i] = std::make_shared<coro::Quorum<bool>>(
+            early_return ? static_cast<size_t>(W) : replicas.size(),
+            [](const bool& ok) { return ok; },
+            early_return);
+        for (auto& replica_id : replicas) {
+            if (replica_id == config_.node_id) {
+                write_local[i] = true;
+                continue;
             }
+            auto& batch = batches[replica_id];
+            if (!batch.request) {
+                batch.request = std::make_shared<kvstore::MultiPutRequest>();
+                batch.request->set_is_internal(true);
+            }
+            auto* entry = batch.request->add_entries();
+            entry->set_key(items[i].first);
+            entry->set_value(items[i].second);
+            entry->mutable_version()->set_write_created_at_us(version.write_created_at_us);
+            entry->mutable_version()->set_writer(version.writer);
+            batch.keys.push_back(acks[i]);
+            acks[i]->expect();
         }
     }
 
-    if (!best) {
-        return std::nullopt;
+    LOG_DEBUG("[node=" << config_.node_id << "] MULTI_PUT keys=" << n
+              << " replica_batches=" << batches.size() << " (W=" << W << ")");
+
+    // As in coordinate_put(), remote batches go out before the local applies.
+    // Batch latency grows with its size, so batches get the longest deadline.
+    const std::chrono::milliseconds batch_timeout(config_.replica_timeout_max_ms);
+    for (auto& [replica_id, batch] : batches) {
+        LOG_DEBUG("[node=" << config_.node_id << "] forwarding MULTI_PUT to " << replica_id
+                  << " (keys=" << batch.keys.size() << ")");
+        if (config_.hinted_handoff) {
+            complete_batch(multi_put_replica(replica_id, std::move(batch.request)),
+                           std::move(batch.keys));
+        } else {
+            complete_batch(forward_multi_put_async(replica_id, std::move(batch.request), batch_timeout),
+                           std::move(batch.keys));
+        }
     }
 
-    LOG_DEBUG("[node=" << config_.node_id << "] READ_REPAIR winner key=" << key
-              << " write_created_at_us=" << best->version.write_created_at_us
-              << " writer=" << best->version.writer_id);
+    for (size_t i = 0; i < n; ++i) {
+        if (write_local[i]) {
+            acks[i]->add(apply_put_local(items[i].first, ValueRef(std::move(items[i].second)), version));
+        }
+    }
 
-    for (const auto& read : reads) {
-        if (!read.entry || is_newer(best->version, read.entry->version)) {
-            bool ok = false;
+    std::vector<bool> results(n);
+    for (size_t i = 0; i < n; ++i) {
+        auto key_acks = co_await acks[i]->wait();
+        results[i] = std::count(key_acks.begin(), key_acks.end(), true) >= W;
+    }
+    co_return results;
+}
 
-            if (read.node_id == config_.node_id) {
-                ok = apply_put_local(key, best->value, best->version);
-            } else {
-                ok = forward_put(
-                    read.node_id,
-                    key,
-                    best->value,
-                    best->version,
-                    std::chrono::milliseconds(50)
-                );
+coro::Task<std::vector<std::optional<StoreEntry>>> Node::coordinate_multi_get(
+        std::vector<std::string> keys) {
+    const size_t n = keys.size();
+    read_count_.fetch_add(n, std::memory_order_relaxed);
+    const size_t RF = config_.replication_factor;
+    const size_t R = static_cast<size_t>(config_.read_quorum);
+
+    // One quorum per key, as in coordinate_get().
+    std::vector<std::shared_ptr<coro::Quorum<ReplicaRead>>> replies(n);
+
+    struct ReplicaBatch {
+        std::shared_ptr<kvstore::MultiGetRequest> request;
+        std::vector<std::shared_ptr<coro::Quorum<ReplicaRead>>> keys;
+    };
+    std::unordered_map<std::string, ReplicaBatch> batches;
+    std::vector<size_t> local_keys;
+
+    for (size_t i = 0; i < n; ++i) {
+        replies[i] = std::make_shared<coro::Quorum<ReplicaRead>>(
+            R, [](const ReplicaRead& read) { return read.ok; });
+        for (auto& replica_id : cluster_.get_replica_set_for_key(keys[i], RF)) {
+            if (replica_id == config_.node_id) {
+                local_keys.push_back(i);
+                continue;
+            }
+            auto& batch = batches[replica_id];
+            if (!batch.request) {
+                batch.request = std::make_shared<kvstore::MultiGetRequest>();
+                batch.request->set_is_internal(true);
             }
+            batch.request->add_keys(keys[i]);
+            batch.keys.push_back(replies[i]);
+            replies[i]->expect();
+        }
+    }
 
-            read_repair_count_.fetch_add(1, std::memory_order_relaxed);
-            LOG_DEBUG("[node=" << config_.node_id
-                      << "] READ_REPAIR sent to "
-                      << read.node_id
-                      << " ok=" << (ok ? "true" : "false"));
+    LOG_DEBUG("[node=" << config_.node_id << "] MULTI_GET keys=" << n
+              << " replica_batches=" << batches.size() << " (R=" << R << ")");
+
+    // As for MULTI_PUT, batches get the longest deadline.
+    const std::chrono::milliseconds batch_timeout(config_.replica_timeout_max_ms);
+    for (auto& [replica_id, batch] : batches) {
+        LOG_DEBUG("[node=" << config_.node_id << "] MULTI_GET contacting replica " << replica_id
+                  << " (keys=" << batch.keys.size() << ")");
+        complete_batch(forward_multi_get_async(replica_id, std::move(batch.request), batch_timeout),
+                       std::move(batch.keys));
+    }
+
+    for (size_t i : local_keys) {
+        replies[i]->add(local_read(keys[i]));
+    }
+
+    std::vector<std::optional<StoreEntry>> results(n);
+    for (size_t i = 0; i < n; ++i) {
+        auto reads = co_await replies[i]->wait();
+        results[i] = resolve_reads(keys[i], reads);
+        if (results[i]) {
+            replies[i]->on_late([this, key = keys[i], winner = *results[i]](ReplicaRead read) {
+                if (read.ok && (!read.entry || is_newer(winner.version, read.entry->version))) {
+                    enqueue_read_repair(read.node_id, key, winner);
+                }
+            });
         }
     }
+    co_return results;
+}
 
-    return best;
+std::shared_ptr<Node::Fallbacks> Node::fallbacks_for(const std::string& key, size_t replicas) {
+    auto fallbacks = std::make_shared<Fallbacks>();
+    // Every replica but the coordinator could fail, so look that far past
+    // the preference list.
+    auto ring = cluster_.get_replica_set_for_key(key, 2 * replicas);
+    if (ring.size() > replicas) {
+        fallbacks->nodes.assign(std::make_move_iterator(ring.begin() + static_cast<std::ptrdiff_t>(replicas)),
+                                std::make_move_iterator(ring.end()));
+    }
+    return fallbacks;
 }
 
-kvstore::KeyValue::Stub* Node::get_or_create_stub(const std::string& node_id) {
-    // Fast path: check if stub already exists
-    {
-        std::lock_guard<std::mutex> lock(stub_mu_);
-        auto it = stub_cache_.find(node_id);
-        if (it != stub_cache_.end()) {
-            return it->second.get();
+coro::Task<bool> Node::put_replica(std::string replica_id,
+                                   std::shared_ptr<const kvstore::PutRequest> request,
+                                   std::shared_ptr<Fallbacks> fallbacks) {
+    if (co_await forward_put_async(replica_id, request, write_timeout(replica_id))) {
+        co_return true;
+    }
+
+    const ValueRef value(std::shared_ptr<const std::string>(request, &request->value()));
+    const Version version{request->version().write_created_at_us(), request->version().writer()};
+
+    auto hinted = std::make_shared<kvstore::PutRequest>(*request);
+    hinted->set_hint_for(replica_id);
+    for (size_t i = fallbacks->next++; i < fallbacks->nodes.size(); i = fallbacks->next++) {
+        const std::string& fallback = fallbacks->nodes[i];
+        bool ok = false;
+        if (fallback == config_.node_id) {
+            ok = co_await hint_writers_.run(
+                [&] { return store_hint(replica_id, request->key(), value, version); });
+        } else if (!config_.failure_detection || health_.allow(fallback)) {
+            ok = co_await forward_put_async(fallback, hinted, write_timeout(fallback));
+        }
+        if (ok) {
+            LOG_DEBUG("[node=" << config_.node_id << "] PUT for " << replica_id
+                      << " handed to " << fallback << " (key=" << request->key() << ")");
+            hinted_write_count_.fetch_add(1, std::memory_order_relaxed);
+            co_return true;
         }
     }
 
-    // Slow path: create channel and stub outside the lock
-    auto address = cluster_.get_node_address(node_id);
-    if (!address) {
-        return nullptr;
+    // No fallback took it. Keeping the hint here still gets the write to the
+    // replica, but a hint on the coordinator is not an extra copy.
+    co_await hint_writers_.run(
+        [&] { return store_hint(replica_id, request->key(), value, version); });
+    co_return false;
+}
+
+coro::Task<std::vector<bool>> Node::multi_put_replica(
+        std::string replica_id,
+        std::shared_ptr<const kvstore::MultiPutRequest> request) {
+    auto acks = co_await forward_multi_put_async(
+        replica_id, request, std::chrono::milliseconds(config_.replica_timeout_max_ms));
+    // One batch keeps it to a single log sync however many entries missed.
+    std::vector<Hint> missed;
+    for (size_t j = 0; j < acks.size(); ++j) {
+        if (!acks[j]) {
+            const auto& entry = request->entries(static_cast<int>(j));
+            missed.push_back(Hint{
+                entry.key(),
+                ValueRef(std::shared_ptr<const std::string>(request, &entry.value())),
+                Version{entry.version().write_created_at_us(), entry.version().writer()}});
+        }
+    }
+    if (!missed.empty()) {
+        const size_t count = missed.size();
+        const size_t stored = co_await hint_writers_.run(
+            [&] { return hints_.add(replica_id, std::move(missed)); });
+        LOG_DEBUG("[node=" << config_.node_id << "] HINT for " << replica_id << ": "
+                  << stored << " of " << count << " MULTI_PUT entries stored");
     }
+    co_return acks;
+}
 
-    auto channel = grpc::CreateChannel(
-        *address,
-        grpc::InsecureChannelCredentials()
-    );
+bool Node::store_hint(const std::string& replica, const std::string& key,
+                      const ValueRef& value, const Version& version) {
+    const bool ok = hints_.add(replica, key, value, version);
+    LOG_DEBUG("[node=" << config_.node_id << "] HINT for " << replica
+              << " (key=" << key << ") " << (ok ? "stored" : "dropped"));
+    return ok;
+}
 
-    auto stub = kvstore::KeyValue::NewStub(channel);
+void Node::handoff_loop() {
+    const auto interval = std::chrono::milliseconds(config_.handoff_interval_ms);
+    std::unique_lock<std::mutex> lock(handoff_stop_mu_);
+    while (!handoff_stop_cv_.wait_for(lock, interval, [this] { return handoff_stopping_; })) {
+        lock.unlock();
+        deliver_hints();
+        lock.lock();
+    }
+}
 
-    // Double-checked locking: re-check if another thread created it
-    std::lock_guard<std::mutex> lock(stub_mu_);
-    auto it = stub_cache_.find(node_id);
-    if (it != stub_cache_.end()) {
-        // Another thread created it, use theirs
-        return it->second.get();
+void Node::deliver_hints() {
+    for (const auto& replica : hints_.targets()) {
+        if (config_.failure_detection && !health_.allow(replica)) {
+            continue;
+        }
+        for (;;) {
+            auto batch = hints_.peek(replica, config_.handoff_batch_size);
+            if (batch.empty() || !push_entries(replica, batch)) {
+                break;
+            }
+            hints_.remove(replica, batch.size());
+            hints_delivered_count_.fetch_add(batch.size(), std::memory_order_relaxed);
+            LOG_DEBUG("[node=" << config_.node_id << "] HANDOFF delivered "
+                      << batch.size() << " hints to " << replica);
+        }
+    }
+}
+
+bool Node::push_entries(const std::string& peer, const std::vector<Hint>& entries) {
+    auto lease = channels_.acquire(peer);
+    if (!lease) {
+        return false;
     }
 
-    // We're first, insert our new stub and channel
-    kvstore::KeyValue::Stub* stub_ptr = stub.get();
-    stub_cache_[node_id] = std::move(stub);
-    channel_cache_[node_id] = std::move(channel);
-    return stub_ptr;
+    kvstore::MultiPutRequest req;
+    req.set_is_internal(true);
+    for (const auto& hint : entries) {
+        auto* entry = req.add_entries();
+        entry->set_key(hint.key);
+        entry->set_value(hint.value.str());
+        entry->mutable_version()->set_write_created_at_us(hint.version.write_created_at_us);
+        entry->mutable_version()->set_writer(hint.version.writer);
+    }
+    kvstore::MultiPutResponse resp;
+    grpc::ClientContext ctx;
+    ctx.set_deadline(std::chrono::system_clock::now() +
+                     std::chrono::milliseconds(config_.replica_timeout_max_ms));
+
+    auto status = lease.stub()->MultiPut(&ctx, req, &resp);
+    if (!status.ok()) {
+        count_forward_failure(peer, status);
+        return false;
+    }
+    health_.record_success(peer);
+    if (resp.results_size() != req.entries_size()) {
+        return false;
+    }
+    return std::all_of(resp.results().begin(), resp.results().end(),
+                       [](const kvstore::PutResponse& result) { return result.success(); });
+}
+
+void Node::anti_entropy_loop() {
+    const auto interval = std::chrono::milliseconds(config_.anti_entropy_interval_ms);
+    // Build the trees up front so the first comparison is one interval away.
+    refresh_merkle_trees();
+    std::unique_lock<std::mutex> lock(anti_entropy_stop_mu_);
+    while (!anti_entropy_stop_cv_.wait_for(lock, interval, [this] { return anti_entropy_stopping_; })) {
+        lock.unlock();
+        anti_entropy_round();
+        lock.lock();
+    }
+}
+
+bool Node::anti_entropy_pause(std::chrono::milliseconds pause) {
+    std::unique_lock<std::mutex> lock(anti_entropy_stop_mu_);
+    return !anti_entropy_stop_cv_.wait_for(lock, pause, [this] { return anti_entropy_stopping_; });
+}
+
+void Node::refresh_merkle_trees() {
+    auto ranges = cluster_.get_token_ranges_for_node(config_.node_id, config_.replication_factor);
+    MerkleRanges* current = merkle_.load(std::memory_order_acquire);
+    if (current && current->ranges() == ranges) {
+        return;
+    }
+
+    // Published before the scan, so writes from here on reach the new trees
+    // as well as the scan. A key written while the scan passes it can be
+    // counted twice or not at all; its leaf then differs from the peers',
+    // and push_merkle_diff() recomputes it.
+    auto* trees = new MerkleRanges(std::move(ranges), config_.merkle_tree_depth);
+    if (MerkleRanges* old = merkle_.exchange(trees, std::memory_order_acq_rel)) {
+        kv::storage::epoch::retire(old);
+    }
+    auto started = std::chrono::steady_clock::now();
+    size_t scanned = 0;
+    try {
+        engine_->for_each([trees, &scanned](const std::string& key, const StoreEntry& entry) {
+            trees->update(kv::ring::ConsistentHashRing::token(key), std::nullopt, entry.version);
+            scanned++;
+        });
+    } catch (const kv::storage::StorageError& e) {
+        // The trees miss what the scan did not reach; peers see those leaves
+        // differ and push their copies.
+        LOG_INFO("[node=" << config_.node_id << "] Merkle tree scan stopped: " << e.what());
+    }
+    if (trees->ranges().empty()) {
+        return;
+    }
+    LOG_INFO("[node=" << config_.node_id << "] built Merkle trees for "
+             << trees->ranges().size() << " token ranges from " << scanned << " keys in "
+             << std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - started).count() << " ms");
+}
+
+void Node::anti_entropy_round() {
+    refresh_merkle_trees();
+    // Only this thread replaces the trees, so no epoch guard is needed here.
+    MerkleRanges* trees = merkle_.load(std::memory_order_acquire);
+
+    std::vector<std::string> peers;
+    for (const auto& range : trees->ranges()) {
+        for (const auto& replica : range.replicas) {
+            if (replica != config_.node_id) {
+                peers.push_back(replica);
+            }
+        }
+    }
+    std::sort(peers.begin(), peers.end());
+    peers.erase(std::unique(peers.begin(), peers.end()), peers.end());
+    if (peers.empty()) {
+        return;
+    }
+    const std::string& peer = peers[anti_entropy_next_peer_++ % peers.size()];
+    if (config_.failure_detection && !health_.allow(peer)) {
+        return;
+    }
+
+    auto diff = diff_merkle_trees(*trees, peer);
+    if (!diff) {
+        return;
+    }
+    anti_entropy_round_count_.fetch_add(1, std::memory_order_relaxed);
+    if (diff->empty()) {
+        return;
+    }
+    size_t leaves = 0;
+    for (const auto& [range, range_leaves] : *diff) {
+        leaves += range_leaves.size();
+    }
+    anti_entropy_diff_count_.fetch_add(leaves, std::memory_order_relaxed);
+    LOG_DEBUG("[node=" << config_.node_id << "] ANTI_ENTROPY " << leaves
+              << " leaves in " << diff->size() << " ranges differ from " << peer);
+    push_merkle_diff(*trees, peer, *diff);
+}
+
+std::optional<Node::MerkleDiff> Node::diff_merkle_trees(const MerkleRanges& trees,
+                                                        const std::string& peer) {
+    struct Pending {
+        size_t range;
+        uint32_t level;
+        std::vector<uint32_t> indexes;
+    };
+    std::vector<Pending> frontier;
+    for (size_t i = 0; i < trees.ranges().size(); ++i) {
+        const auto& replicas = trees.ranges()[i].replicas;
+        if (std::find(replicas.begin(), replicas.end(), peer) != replicas.end()) {
+            frontier.push_back(Pending{i, 0, {0}});
+        }
+    }
+
+    MerkleDiff diff;
+    while (!frontier.empty()) {
+        auto lease = channels_.acquire(peer);
+        if (!lease) {
+            return std::nullopt;
+        }
+        kvstore::MerkleLevelRequest req;
+        req.set_node_id(config_.node_id);
+        req.set_depth(trees.depth());
+        for (const auto& pending : frontier) {
+            auto* nodes = req.add_ranges();
+            nodes->set_range_start(trees.ranges()[pending.range].start);
+            nodes->set_range_end(trees.ranges()[pending.range].end);
+            nodes->set_level(pending.level);
+            for (uint32_t index : pending.indexes) {
+                nodes->add_indexes(index);
+            }
+        }
+        kvstore::MerkleLevelResponse resp;
+        grpc::ClientContext ctx;
+        ctx.set_deadline(std::chrono::system_clock::now() +
+                         std::chrono::milliseconds(config_.replica_timeout_max_ms));
+        auto status = lease.stub()->MerkleLevel(&ctx, req, &resp);
+        if (!status.ok()) {
+            count_forward_failure(peer, status);
+            return std::nullopt;
+        }
+        health_.record_success(peer);
+        if (resp.ranges_size() != req.ranges_size()) {
+            return std::nullopt;
+        }
+
+        std::vector<Pending> next;
+        size_t budget = MERKLE_NODES_PER_EXCHANGE;
+        for (size_t f = 0; f < frontier.size(); ++f) {
+            const Pending& pending = frontier[f];
+            const auto& remote = resp.ranges(static_cast<int>(f));
+            // A range the peer has no matching tree for is compared once
+            // both sides see the same ring.
+            if (!remote.found() ||
+                static_cast<size_t>(remote.hashes_size()) != pending.indexes.size()) {
+                continue;
+            }
+            const auto local = trees.tree(pending.range).level(pending.level);
+            Pending children{pending.range, pending.level + 1, {}};
+            for (size_t k = 0; k < pending.indexes.size(); ++k) {
+                const uint32_t index = pending.indexes[k];
+                if (local[index] == remote.hashes(static_cast<int>(k))) {
+                    continue;
+                }
+                if (pending.level == trees.depth()) {
+                    diff[pending.range].push_back(index);
+                } else if (budget >= 2) {
+                    children.indexes.push_back(2 * index);
+                    children.indexes.push_back(2 * index + 1);
+                    budget -= 2;
+                }
+            }
+            if (!children.indexes.empty()) {
+                next.push_back(std::move(children));
+            }
+        }
+        frontier = std::move(next);
+    }
+    return diff;
+}
+
+void Node::push_merkle_diff(MerkleRanges& trees, const std::string& peer, const MerkleDiff& diff) {
+    // One round pushes about an interval's worth of entries; leaves it
+    // does not finish still differ next time.
+    const uint64_t rate = config_.anti_entropy_keys_per_sec;
+    const size_t limit = std::max<size_t>(
+        ANTI_ENTROPY_BATCH,
+        static_cast<size_t>(rate * config_.anti_entropy_interval_ms / 1000));
+
+    std::map<std::pair<size_t, size_t>, uint64_t> recomputed;
+    for (const auto& [range, leaves] : diff) {
+        for (size_t leaf : leaves) {
+            recomputed[{range, leaf}] = 0;
+        }
+    }
+    std::vector<Hint> entries;
+    try {
+        engine_->for_each([&](const std::string& key, const StoreEntry& entry) {
+            const uint64_t token = kv::ring::ConsistentHashRing::token(key);
+            auto range = trees.find(token);
+            if (!range) {
+                return;
+            }
+            auto it = recomputed.find({*range, trees.leaf_for(*range, token)});
+            if (it == recomputed.end()) {
+                return;
+            }
+            it->second ^= MerkleTree::entry_hash(token, entry.version);
+            if (entries.size() < limit) {
+                entries.push_back(Hint{key, entry.value, entry.version});
+            }
+        });
+    } catch (const kv::storage::StorageError& e) {
+        // Partial hashes must not replace the leaves; they differ next round.
+        LOG_INFO("[node=" << config_.node_id << "] ANTI_ENTROPY scan for " << peer
+                 << " stopped: " << e.what());
+        return;
+    }
+    for (const auto& [leaf, hash] : recomputed) {
+        trees.tree(leaf.first).set_leaf(leaf.second, hash);
+    }
+
+    for (size_t i = 0; i < entries.size(); i += ANTI_ENTROPY_BATCH) {
+        const size_t end = std::min(entries.size(), i + ANTI_ENTROPY_BATCH);
+        std::vector<Hint> batch(entries.begin() + static_cast<std::ptrdiff_t>(i),
+                                entries.begin() + static_cast<std::ptrdiff_t>(end));
+        if (!push_entries(peer, batch)) {
+            return;  // the leaves still differ next round
+        }
+        anti_entropy_push_count_.fetch_add(batch.size(), std::memory_order_relaxed);
+        LOG_DEBUG("[node=" << config_.node_id << "] ANTI_ENTROPY pushed "
+                  << batch.size() << " entries to " << peer);
+        // Paced to the configured rate so the pushes stay in the background.
+        if (!anti_entropy_pause(std::chrono::milliseconds(batch.size() * 1000 / rate))) {
+            return;
+        }
+    }
+}
+
+std::chrono::microseconds Node::hedge_delay(const std::vector<const std::string*>& remotes,
+                                            size_t contacted) const {
+    // Wait as long as the slowest contacted replica usually takes.
+    const std::chrono::microseconds fallback = std::chrono::milliseconds(config_.hedge_delay_ms);
+    std::chrono::microseconds delay{0};
+    for (size_t i = 0; i < contacted; ++i) {
+        delay = std::max(delay, latency_.quantile(*remotes[i], 0.95).value_or(fallback));
+    }
+    return delay > std::chrono::microseconds{0} ? delay : fallback;
+}
+
+std::chrono::milliseconds Node::replica_timeout(const std::string& peer,
+                                                std::chrono::milliseconds fallback) const {
+    auto p99 = latency_.quantile(peer, 0.99);
+    if (!p99) {
+        return fallback;
+    }
+    const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(*p99 * TIMEOUT_P99_MULTIPLE);
+    return std::clamp(timeout,
+                      std::chrono::milliseconds(config_.replica_timeout_min_ms),
+                      std::chrono::milliseconds(config_.replica_timeout_max_ms));
+}
+
+std::chrono::milliseconds Node::read_timeout(const std::string& peer) const {
+    return replica_timeout(peer, std::chrono::milliseconds(config_.replica_timeout_ms));
+}
+
+std::chrono::milliseconds Node::write_timeout(const std::string& peer) const {
+    // A write that times out is left to read repair, so without history it
+    // gets the most patience.
+    return replica_timeout(peer, std::chrono::milliseconds(config_.replica_timeout_max_ms));
+}
+
+void Node::order_for_contact(std::vector<const std::string*>& remotes) {
+    if (remotes.size() < 2) {
+        return;
+    }
+    struct Keyed {
+        bool down;
+        std::chrono::microseconds latency;
+        const std::string* remote;
+    };
+    std::vector<Keyed> keyed;
+    keyed.reserve(remotes.size());
+    for (const std::string* remote : remotes) {
+        keyed.push_back(Keyed{
+            config_.failure_detection && !health_.allow(*remote),
+            latency_.quantile(*remote, 0.5).value_or(std::chrono::microseconds{0}),
+            remote});
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const Keyed& a, const Keyed& b) {
+        return std::tie(a.down, a.latency) < std::tie(b.down, b.latency);
+    });
+    for (size_t i = 0; i < keyed.size(); ++i) {
+        remotes[i] = keyed[i].remote;
+    }
+}
+
+bool Node::peer_available(const std::string& peer) {
+    if (!config_.failure_detection || health_.allow(peer)) {
+        return true;
+    }
+    peer_skip_count_.fetch_add(1, std::memory_order_relaxed);
+    forward_failure_count_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void Node::count_forward_failure(const std::string& peer, const grpc::Status& status) {
+    forward_failure_count_.fetch_add(1, std::memory_order_relaxed);
+    switch (status.error_code()) {
+    case grpc::StatusCode::DEADLINE_EXCEEDED:
+        replica_timeout_count_.fetch_add(1, std::memory_order_relaxed);
+        health_.record_failure(peer);
+        break;
+    case grpc::StatusCode::UNAVAILABLE:
+        health_.record_failure(peer);
+        break;
+    default:
+        break;
+    }
+}
+
+void Node::heartbeat_loop() {
+    const auto interval = std::chrono::milliseconds(config_.heartbeat_interval_ms);
+    std::unique_lock<std::mutex> lock(heartbeat_stop_mu_);
+    while (!heartbeat_stop_cv_.wait_for(lock, interval, [this] { return heartbeat_stopping_; })) {
+        lock.unlock();
+        for (auto& id : cluster_.get_node_ids()) {
+            // A peer that has not answered the last ping is not pinged again.
+            if (id != config_.node_id && health_.begin_ping(id)) {
+                coro::spawn(ping_peer(std::move(id)));
+            }
+        }
+        lock.lock();
+    }
+}
+
+coro::Task<void> Node::ping_peer(std::string peer) {
+    kvstore::PingRequest request;
+    request.set_node_id(config_.node_id);
+    // A ping slower than the interval is a missed heartbeat anyway, and the
+    // short deadline keeps shutdown from waiting on pings to a dead peer.
+    auto result = co_await coro::unary_call(
+        channels_.acquire(peer), &kvstore::KeyValue::Stub::PrepareAsyncPing, request, &cq_,
+        std::chrono::milliseconds(config_.heartbeat_interval_ms));
+    if (result.status.ok()) {
+        health_.ping_succeeded(peer);
+    } else if (result.status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
+        health_.ping_missed(peer);
+    } else {
+        health_.ping_failed(peer);
+    }
+}
+
+void Node::earn_hedge_credit() {
+    int64_t credit = hedge_credit_.load(std::memory_order_relaxed);
+    int64_t next;
+    do {
+        next = std::min<int64_t>(credit + config_.hedge_budget_percent, HEDGE_COST * HEDGE_BURST);
+    } while (next != credit &&
+             !hedge_credit_.compare_exchange_weak(credit, next, std::memory_order_relaxed));
+}
+
+bool Node::spend_hedge_credit() {
+    int64_t credit = hedge_credit_.load(std::memory_order_relaxed);
+    while (credit >= HEDGE_COST) {
+        if (hedge_credit_.compare_exchange_weak(credit, credit - HEDGE_COST,
+                                                std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::optional<StoreEntry> Node::resolve_reads(const std::string& key,
+                                              const std::vector<ReplicaRead>& reads) {
+    std::optional<StoreEntry> best;
+    for (const auto& read : reads) {
+        if (!read.ok) {
+            continue;
+        }
+        if (!read.entry) {
+            LOG_DEBUG("[node=" << config_.node_id
+                      << "] GET miss from " << read.node_id);
+            continue;
+        }
+        LOG_DEBUG("[node=" << config_.node_id << "] GET candidate (key=" << key
+                  << ") from " << read.node_id
+                  << " write_created_at_us=" << read.entry->version.write_created_at_us
+                  << " writer=" << read.entry->version.writer);
+        if (!best || is_newer(read.entry->version, best->version)) {
+            best = read.entry;
+        }
+    }
+
+    if (best) {
+        LOG_DEBUG("[node=" << config_.node_id << "] READ_REPAIR winner key=" << key
+                  << " write_created_at_us=" << best->version.write_created_at_us
+                  << " writer=" << best->version.writer);
+
+        for (const auto& read : reads) {
+            if (read.ok && (!read.entry || is_newer(best->version, read.entry->version))) {
+                enqueue_read_repair(read.node_id, key, *best);
+            }
+        }
+    }
+    return best;
+}
+
+void Node::enqueue_read_repair(const std::string& replica_id,
+                               const std::string& key,
+                               const StoreEntry& winner) {
+    auto result = repair_queue_.enqueue(RepairTask{replica_id, key, winner});
+    LOG_DEBUG("[node=" << config_.node_id
+              << "] READ_REPAIR queued for " << replica_id
+              << " (key=" << key << ") result="
+              << (result == ReadRepairQueue::EnqueueResult::Queued ? "queued"
+                  : result == ReadRepairQueue::EnqueueResult::Coalesced ? "coalesced"
+                  : "dropped"));
+}
+
+void Node::apply_read_repair(const RepairTask& task) {
+    bool ok = false;
+
+    if (task.replica_id == config_.node_id) {
+        ok = apply_put_local(task.key, task.entry.value, task.entry.version);
+    } else {
+        ok = forward_put(
+            task.replica_id,
+            task.key,
+            task.entry.value,
+            task.entry.version,
+            write_timeout(task.replica_id)
+        );
+    }
+
+    read_repair_count_.fetch_add(1, std::memory_order_relaxed);
+    LOG_DEBUG("[node=" << config_.node_id
+              << "] READ_REPAIR sent to "
+              << task.replica_id
+              << " ok=" << (ok ? "true" : "false"));
 }
 
 bool Node::forward_put(
     const std::string& owner_id,
     const std::string& key,
-    const std::string& value,
+    const ValueRef& value,
     const Version& version,
     std::optional<std::chrono::milliseconds> deadline
 ) {
-    auto* stub = get_or_create_stub(owner_id);
-    if (!stub) {
+    if (!peer_available(owner_id)) {
+        return false;
+    }
+    auto lease = channels_.acquire(owner_id);
+    if (!lease) {
         forward_failure_count_.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
 
-    kvstore::PutRequest req;
+    auto req = make_internal_put_request(key, value.str(), version);
     kvstore::PutResponse resp;
     grpc::ClientContext ctx;
 
@@ -228,27 +1185,97 @@ bool Node::forward_put(
         ctx.set_deadline(std::chrono::system_clock::now() + *deadline);
     }
 
-    req.set_key(key);
-    req.set_value(value);
-    req.set_is_internal(true);
-    req.mutable_version()->set_write_created_at_us(version.write_created_at_us);
-    req.mutable_version()->set_writer_id(version.writer_id);
-
-    auto status = stub->Put(&ctx, req, &resp);
+    auto status = lease.stub()->Put(&ctx, *req, &resp);
     if (!status.ok() || !resp.success()) {
-        forward_failure_count_.fetch_add(1, std::memory_order_relaxed);
+        count_forward_failure(owner_id, status);
         return false;
     }
+    health_.record_success(owner_id);
     return true;
 }
 
+coro::Task<bool> Node::forward_put_async(
+    std::string owner_id,
+    std::shared_ptr<const kvstore::PutRequest> request,
+    std::optional<std::chrono::milliseconds> deadline
+) {
+    if (!peer_available(owner_id)) {
+        co_return false;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    auto result = co_await coro::unary_call(
+        channels_.acquire(owner_id), &kvstore::KeyValue::Stub::PrepareAsyncPut, *request, &cq_, deadline);
+    if (result.status.ok()) {
+        latency_.record(owner_id, std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start));
+        health_.record_success(owner_id);
+    }
+    const bool ok = result.status.ok() && result.response.success();
+    if (!ok) {
+        count_forward_failure(owner_id, result.status);
+    }
+    co_return ok;
+}
+
+coro::Task<std::vector<bool>> Node::forward_multi_put_async(
+    std::string owner_id,
+    std::shared_ptr<const kvstore::MultiPutRequest> request,
+    std::optional<std::chrono::milliseconds> deadline
+) {
+    std::vector<bool> acks(static_cast<size_t>(request->entries_size()), false);
+    if (!peer_available(owner_id)) {
+        co_return acks;
+    }
+    auto result = co_await coro::unary_call(
+        channels_.acquire(owner_id), &kvstore::KeyValue::Stub::PrepareAsyncMultiPut, *request, &cq_, deadline);
+    if (!result.status.ok()) {
+        count_forward_failure(owner_id, result.status);
+        co_return acks;
+    }
+    health_.record_success(owner_id);
+    const int count = std::min(request->entries_size(), result.response.results_size());
+    for (int j = 0; j < count; ++j) {
+        acks[static_cast<size_t>(j)] = result.response.results(j).success();
+    }
+    co_return acks;
+}
+
+void Node::poll_completion_queue() {
+    void* tag = nullptr;
+    bool ok = false;
+    // Unary Finish() always completes with ok=true; failures surface
+    // through the call's grpc::Status.
+    while (cq_.Next(&tag, &ok)) {
+        auto* call = static_cast<coro::AsyncCall*>(tag);
+        call->on_complete();
+        delete call;
+    }
+}
+
+std::shared_ptr<kvstore::PutRequest> Node::make_internal_put_request(
+    const std::string& key,
+    std::string value,
+    const Version& version
+) {
+    auto req = std::make_shared<kvstore::PutRequest>();
+    req->set_key(key);
+    req->set_value(std::move(value));
+    req->set_is_internal(true);
+    req->mutable_version()->set_write_created_at_us(version.write_created_at_us);
+    req->mutable_version()->set_writer(version.writer);
+    return req;
+}
+
 std::optional<StoreEntry> Node::forward_get(
     const std::string& owner_id,
     const std::string& key,
     std::optional<std::chrono::milliseconds> deadline
 ) {
-    auto* stub = get_or_create_stub(owner_id);
-    if (!stub) {
+    if (!peer_available(owner_id)) {
+        return std::nullopt;
+    }
+    auto lease = channels_.acquire(owner_id);
+    if (!lease) {
         forward_failure_count_.fetch_add(1, std::memory_order_relaxed);
         return std::nullopt;
     }
@@ -264,70 +1291,135 @@ std::optional<StoreEntry> Node::forward_get(
         ctx.set_deadline(std::chrono::system_clock::now() + *deadline);
     }
 
-    auto status = stub->Get(&ctx, req, &resp);
+    auto status = lease.stub()->Get(&ctx, req, &resp);
     if (!status.ok()) {
-        forward_failure_count_.fetch_add(1, std::memory_order_relaxed);
-        return std::nullopt;
-    }
-    if (!resp.found()) {
+        count_forward_failure(owner_id, status);
         return std::nullopt;
     }
+    health_.record_success(owner_id);
+    return entry_from_response(resp);
+}
 
-    Version version{
-        resp.version().write_created_at_us(),
-        resp.version().writer_id()
-    };
+coro::Task<ReplicaRead> Node::forward_get_async(
+    std::string owner_id,
+    std::shared_ptr<const kvstore::GetRequest> request,
+    std::optional<std::chrono::milliseconds> deadline
+) {
+    if (!peer_available(owner_id)) {
+        co_return ReplicaRead{std::move(owner_id), false, std::nullopt};
+    }
+    const auto start = std::chrono::steady_clock::now();
+    auto result = co_await coro::unary_call(
+        channels_.acquire(owner_id), &kvstore::KeyValue::Stub::PrepareAsyncGet, *request, &cq_, deadline);
+    if (!result.status.ok()) {
+        count_forward_failure(owner_id, result.status);
+        co_return ReplicaRead{std::move(owner_id), false, std::nullopt};
+    }
+    latency_.record(owner_id, std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start));
+    health_.record_success(owner_id);
+    co_return ReplicaRead{std::move(owner_id), true, entry_from_response(result.response)};
+}
 
-    return StoreEntry{resp.value(), version};
+coro::Task<std::vector<ReplicaRead>> Node::forward_multi_get_async(
+    std::string owner_id,
+    std::shared_ptr<const kvstore::MultiGetRequest> request,
+    std::optional<std::chrono::milliseconds> deadline
+) {
+    std::vector<ReplicaRead> reads(static_cast<size_t>(request->keys_size()),
+                                   ReplicaRead{owner_id, false, std::nullopt});
+    if (!peer_available(owner_id)) {
+        co_return reads;
+    }
+    auto result = co_await coro::unary_call(
+        channels_.acquire(owner_id), &kvstore::KeyValue::Stub::PrepareAsyncMultiGet, *request, &cq_, deadline);
+    if (!result.status.ok()) {
+        count_forward_failure(owner_id, result.status);
+        co_return reads;
+    }
+    health_.record_success(owner_id);
+    const int count = std::min(request->keys_size(), result.response.results_size());
+    for (int j = 0; j < count; ++j) {
+        auto& read = reads[static_cast<size_t>(j)];
+        read.ok = true;
+        read.entry = entry_from_response(*result.response.mutable_results(j));
+    }
+    co_return reads;
 }
 
 std::optional<StoreEntry> Node::local_get(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mu_);
-    auto it = store_.find(key);
-    if (it == store_.end()) {
+    return engine_->get(key);
+}
+
+ReplicaRead Node::local_read(const std::string& key) {
+    try {
+        return ReplicaRead{config_.node_id, true, engine_->get(key)};
+    } catch (const kv::storage::StorageError& e) {
+        LOG_INFO("[node=" << config_.node_id << "] local read failed (key=" << key
+                 << "): " << e.what());
+        return ReplicaRead{config_.node_id, false, std::nullopt};
+    }
+}
+
+std::optional<std::vector<uint64_t>> Node::merkle_level(uint64_t start, uint64_t end,
+                                                        uint32_t depth, uint32_t level) const {
+    kv::storage::epoch::Guard guard;
+    const MerkleRanges* trees = merkle_.load(std::memory_order_acquire);
+    if (!trees || trees->depth() != depth || level > depth) {
         return std::nullopt;
     }
-    return it->second;
+    auto range = trees->find(start, end);
+    if (!range) {
+        return std::nullopt;
+    }
+    return trees->tree(*range).level(level);
 }
 
 bool Node::apply_put_local(
     const std::string& key,
-    const std::string& value,
+    ValueRef value,
     const Version& version
 ) {
-    std::lock_guard<std::mutex> lock(mu_);
-    auto it = store_.find(key);
+    kv::storage::PutResult result{};
+    try {
+        result = engine_->put_if_newer(key, value, version);
+    } catch (const kv::storage::StorageError& e) {
+        // The LWW check could not read the current version.
+        LOG_INFO("[node=" << config_.node_id << "] PUT failed (key=" << key << "): " << e.what());
+        return false;
+    }
+    if (result.io_error) {
+        LOG_INFO("[node=" << config_.node_id << "] WAL append failed (key=" << key << ")");
+        return false;
+    }
+
+    if (result.overwritten && config_.anti_entropy) {
+        kv::storage::epoch::Guard guard;
+        if (MerkleRanges* trees = merkle_.load(std::memory_order_acquire)) {
+            trees->update(kv::ring::ConsistentHashRing::token(key), result.previous, version);
+        }
+    }
 
-    if (it == store_.end()) {
-        store_[key] = StoreEntry{value, version};
+    if (!result.previous) {
         LOG_DEBUG("[node=" << config_.node_id << "] apply PUT (key=" << key
                   << ") incoming write_created_at_us=" << version.write_created_at_us
-                  << " writer=" << version.writer_id
+                  << " writer=" << version.writer
                   << " existing=none overwrite=true");
         return true;
     }
 
-    Version existing = it->second.version;
-    bool overwrite = false;
-    if (is_newer(version, existing)) {
-        it->second = StoreEntry{value, version};
-        overwrite = true;
-    }
     LOG_DEBUG("[node=" << config_.node_id << "] apply PUT (key=" << key
               << ") incoming write_created_at_us=" << version.write_created_at_us
-              << " writer=" << version.writer_id
-              << " existing write_created_at_us=" << existing.write_created_at_us
-              << " writer=" << existing.writer_id
-              << " overwrite=" << (overwrite ? "true" : "false"));
+              << " writer=" << version.writer
+              << " existing write_created_at_us=" << result.previous->write_created_at_us
+              << " writer=" << result.previous->writer
+              << " overwrite=" << (result.overwritten ? "true" : "false"));
 
     return true;
 }
 
-bool Node::is_newer(const Version& a, const Version& b) {
-    if (a.write_created_at_us != b.write_created_at_us) {
-        return a.write_created_at_us > b.write_created_at_us;
-    }
-    return a.writer_id > b.writer_id;
+std::string Node::writer_name(WriterId writer) const {
+    return cluster_.writer_name(writer).value_or("");
 }
 
 NodeMetrics Node::metrics() const {
@@ -335,7 +1427,35 @@ NodeMetrics Node::metrics() const {
     m.reads = read_count_.load(std::memory_order_relaxed);
     m.writes = write_count_.load(std::memory_order_relaxed);
     m.read_repairs = read_repair_count_.load(std::memory_order_relaxed);
+    m.read_repairs_coalesced = repair_queue_.coalesced();
+    m.read_repairs_dropped = repair_queue_.dropped();
+    m.read_repair_queue_depth = repair_queue_.depth();
     m.forward_failures = forward_failure_count_.load(std::memory_order_relaxed);
+    m.hedged_reads = hedge_count_.load(std::memory_order_relaxed);
+    m.hedged_reads_won = hedge_won_count_.load(std::memory_order_relaxed);
+    m.replica_timeouts = replica_timeout_count_.load(std::memory_order_relaxed);
+    m.peer_skips = peer_skip_count_.load(std::memory_order_relaxed);
+    m.hinted_writes = hinted_write_count_.load(std::memory_order_relaxed);
+    m.hints_pending = hints_.pending();
+    m.hints_delivered = hints_delivered_count_.load(std::memory_order_relaxed);
+    m.hints_dropped = hints_.dropped();
+    m.anti_entropy_rounds = anti_entropy_round_count_.load(std::memory_order_relaxed);
+    m.anti_entropy_diffs = anti_entropy_diff_count_.load(std::memory_order_relaxed);
+    m.anti_entropy_pushes = anti_entropy_push_count_.load(std::memory_order_relaxed);
+    if (config_.failure_detection) {
+        m.down_peers = health_.down_peers();
+    }
+    for (auto& peer : latency_.peers()) {
+        PeerLatencyMetrics p;
+        p.p50 = latency_.quantile(peer, 0.5).value_or(std::chrono::microseconds{0});
+        p.p99 = latency_.quantile(peer, 0.99).value_or(std::chrono::microseconds{0});
+        p.read_timeout = read_timeout(peer);
+        p.write_timeout = write_timeout(peer);
+        p.node_id = std::move(peer);
+        m.peers.push_back(std::move(p));
+    }
+    std::sort(m.peers.begin(), m.peers.end(),
+              [](const auto& a, const auto& b) { return a.node_id < b.node_id; });
     return m;
 }
 
@@ -6,47 +6,130 @@
 #include <optional>
 #include <chrono>
 #include <mutex>
+#include <functional>
+#include <map>
 #include <memory>
 #include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <utility>
+#include <vector>
 
 #include "cluster/cluster_view.h"
+#include "node/channel_pool.h"
+#include "node/coro.h"
+#include "node/failure_detector.h"
+#include "node/hint_store.h"
+#include "node/merkle_tree.h"
 #include "node/node_config.h"
+#include "node/peer_latency.h"
+#include "node/read_repair_queue.h"
+#include "node/version.h"
+#include "storage/storage_engine.h"
 #include "kv.grpc.pb.h"
 
 namespace kv::node {
 
-struct Version {
-    uint64_t write_created_at_us; // write creation time (microseconds since epoch)
-    std::string writer_id;  // who wrote the current version?
-};
-
-struct StoreEntry {
-    std::string value;
-    Version version;
+// A peer's recent replica RPC latency and the deadlines derived from it.
+// Zero quantiles mean the peer does not have enough history yet.
+struct PeerLatencyMetrics {
+    std::string node_id;
+    std::chrono::microseconds p50{0};
+    std::chrono::microseconds p99{0};
+    std::chrono::milliseconds read_timeout{0};
+    std::chrono::milliseconds write_timeout{0};
 };
 
 struct NodeMetrics {
     uint64_t reads = 0;
     uint64_t writes = 0;
-    uint64_t read_repairs = 0;
+    uint64_t read_repairs = 0;           // repair writes sent by the repair worker
+    uint64_t read_repairs_coalesced = 0; // merged into an already-pending repair
+    uint64_t read_repairs_dropped = 0;   // discarded because the queue was full
+    uint64_t read_repair_queue_depth = 0;
     uint64_t forward_failures = 0;
+    uint64_t hedged_reads = 0;           // extra replica reads sent after the hedge delay
+    uint64_t hedged_reads_won = 0;       // hedges whose reply was part of the answer
+    uint64_t replica_timeouts = 0;       // replica RPCs that ran out their deadline
+    uint64_t peer_skips = 0;             // replica RPCs not sent because the peer was down
+    uint64_t hinted_writes = 0;          // replica writes a fallback node acked on its behalf
+    uint64_t hints_pending = 0;          // hints held here for other replicas
+    uint64_t hints_delivered = 0;
+    uint64_t hints_dropped = 0;          // discarded because the hint store was full
+    uint64_t anti_entropy_rounds = 0;    // Merkle tree comparisons completed with a peer
+    uint64_t anti_entropy_diffs = 0;     // tree leaves found to differ from the peer's
+    uint64_t anti_entropy_pushes = 0;    // entries pushed to a peer to repair them
+    std::vector<std::string> down_peers;
+    std::vector<PeerLatencyMetrics> peers;
+};
+
+// One replica's answer to an internal read. ok=false means the RPC failed;
+// ok with no entry means the replica does not hold the key.
+struct ReplicaRead {
+    std::string node_id;
+    bool ok = false;
+    std::optional<StoreEntry> entry;
 };
 
 class Node {
 public:
+    // Builds the configured storage engine, which recovers from
+    // config.data_dir when set; throws std::runtime_error on I/O failure.
+    // Starts connecting to the peers already in `cluster`.
     Node(const kv::NodeConfig& config, kv::cluster::ClusterView& cluster);
 
-    bool put(const std::string& key, const std::string& value);
+    // Drains outstanding async replica RPCs before tearing down channels.
+    ~Node();
+
+    // Takes the value by value: it is moved into the outgoing replica request
+    // and the local store shares that same buffer.
+    bool put(const std::string& key, std::string value);
     std::optional<StoreEntry> get(const std::string& key);
 
+    // Batched put/get with the same quorum and LWW rules as put()/get().
+    // Keys are grouped by replica so each remote replica receives one batch
+    // RPC; result[i] is the outcome for items[i] / keys[i]. All puts in a
+    // batch share one write version.
+    std::vector<bool> multi_put(std::vector<std::pair<std::string, std::string>> items);
+    std::vector<std::optional<StoreEntry>> multi_get(const std::vector<std::string>& keys);
+
+    // Non-blocking coordinator forms of the four calls above, which wrap
+    // them. Each runs the coordinator coroutine, which is suspended rather
+    // than holding a thread while replica RPCs are outstanding. `done` runs
+    // exactly once with the same result the blocking call would return,
+    // either on the calling thread (when no replica RPC is needed) or on the
+    // completion-queue thread. `done` must not block.
+    void put_async(const std::string& key, std::string value, std::function<void(bool)> done);
+    void get_async(const std::string& key, std::function<void(std::optional<StoreEntry>)> done);
+    void multi_put_async(std::vector<std::pair<std::string, std::string>> items,
+                         std::function<void(std::vector<bool>)> done);
+    void multi_get_async(const std::vector<std::string>& keys,
+                         std::function<void(std::vector<std::optional<StoreEntry>>)> done);
+
     const std::string& node_id() const { return config_.node_id; }
+    WriterId writer() const { return writer_; }
+
+    // Writer id <-> node id translation via the cluster's intern table.
+    std::optional<WriterId> find_writer(const std::string& name) const { return cluster_.find_writer(name); }
+    std::string writer_name(WriterId writer) const;
     size_t replication_factor() const { return config_.replication_factor; }
     int write_quorum() const { return config_.write_quorum; }
+    int read_quorum() const { return config_.read_quorum; }
+
+    // When enabled (default), put() returns as soon as W replicas have acked
+    // and the remaining replica writes finish in the background. When
+    // disabled, put() waits for every replica RPC to complete.
+    void set_early_write_return(bool enabled) {
+        early_write_return_.store(enabled, std::memory_order_relaxed);
+    }
+    bool early_write_return() const {
+        return early_write_return_.load(std::memory_order_relaxed);
+    }
 
     bool forward_put(
         const std::string& owner_id,
         const std::string& key,
-        const std::string& value,
+        const ValueRef& value,
         const Version& version,
         std::optional<std::chrono::milliseconds> deadline = std::nullopt
     );
@@ -57,33 +140,265 @@ public:
         std::optional<std::chrono::milliseconds> deadline = std::nullopt
     );
 
+    // Awaitable forms of forward_put/forward_get, issued on the node's
+    // completion queue; the awaiting coroutine resumes on the
+    // completion-queue thread. Failures count toward forward_failures.
+    // With failure detection on, every forward_* call to a peer that is down
+    // fails at once without an RPC.
+    coro::Task<bool> forward_put_async(
+        std::string owner_id,
+        std::shared_ptr<const kvstore::PutRequest> request,
+        std::optional<std::chrono::milliseconds> deadline
+    );
+
+    coro::Task<ReplicaRead> forward_get_async(
+        std::string owner_id,
+        std::shared_ptr<const kvstore::GetRequest> request,
+        std::optional<std::chrono::milliseconds> deadline
+    );
+
+    // Batch forms. Results are per request entry/key; a failed RPC or a
+    // short response fails the entries it does not cover.
+    coro::Task<std::vector<bool>> forward_multi_put_async(
+        std::string owner_id,
+        std::shared_ptr<const kvstore::MultiPutRequest> request,
+        std::optional<std::chrono::milliseconds> deadline
+    );
+
+    coro::Task<std::vector<ReplicaRead>> forward_multi_get_async(
+        std::string owner_id,
+        std::shared_ptr<const kvstore::MultiGetRequest> request,
+        std::optional<std::chrono::milliseconds> deadline
+    );
+
+    // Throws kv::storage::StorageError if the engine cannot read the key.
     std::optional<StoreEntry> local_get(const std::string& key);
+    // The local replica's answer for a coordinated read; an unreadable key is
+    // a failed read, not a miss.
+    ReplicaRead local_read(const std::string& key);
+
+    // Holds a write for `replica` until the handoff worker can deliver it.
+    // False if the hint store is full or cannot log it.
+    bool store_hint(const std::string& replica, const std::string& key,
+                    const ValueRef& value, const Version& version);
+
+    // Hashes of one level of this node's Merkle tree for the token range
+    // (start, end], for a peer's anti-entropy exchange. Nothing if there is
+    // no such tree of `depth`: anti-entropy is off, or the ring differs here.
+    std::optional<std::vector<uint64_t>> merkle_level(uint64_t start, uint64_t end,
+                                                      uint32_t depth, uint32_t level) const;
 
     bool apply_put_local(
         const std::string& key,
-        const std::string& value,
+        ValueRef value,
         const Version& version
     );
 
     NodeMetrics metrics() const;
 
+    // Checkpoints the storage engine (a snapshot for the memory engine, a
+    // memtable flush for lsm) so the WAL can be truncated. Returns false
+    // without a data_dir. Runs periodically when checkpoint_interval_s is set.
+    bool checkpoint();
+
+    kv::storage::StorageEngineKind storage_engine() const { return engine_->kind(); }
+
+    // Blocks until every queued read repair has been applied. Intended for tests.
+    void wait_for_read_repairs() { repair_queue_.wait_idle(); }
+
 private:
-    static bool is_newer(const Version& a, const Version& b);
-    kvstore::KeyValue::Stub* get_or_create_stub(const std::string& node_id);
+    // Coordinator coroutines behind the public put/get calls. Arguments are
+    // taken by value: they live in the coroutine frame across suspensions.
+    coro::Task<bool> coordinate_put(std::string key, std::string value);
+    coro::Task<std::optional<StoreEntry>> coordinate_get(std::string key);
+    coro::Task<std::vector<bool>> coordinate_multi_put(
+        std::vector<std::pair<std::string, std::string>> items);
+    coro::Task<std::vector<std::optional<StoreEntry>>> coordinate_multi_get(
+        std::vector<std::string> keys);
+
+    // Nodes past a key's preference list, in ring order, that can stand in
+    // for a replica whose write failed. Shared by one PUT's replica writes,
+    // so each fallback is claimed by at most one of them.
+    struct Fallbacks {
+        std::vector<std::string> nodes;
+        std::atomic<size_t> next{0};
+    };
+    std::shared_ptr<Fallbacks> fallbacks_for(const std::string& key, size_t replicas);
+
+    // One replica's share of a PUT. With hinted handoff, a failed write is
+    // handed to the next fallback as a hint (which counts as an ack), or
+    // kept here as a hint if no fallback takes it (which does not).
+    coro::Task<bool> put_replica(std::string replica_id,
+                                 std::shared_ptr<const kvstore::PutRequest> request,
+                                 std::shared_ptr<Fallbacks> fallbacks);
+
+    // One replica's MULTI_PUT batch; with hinted handoff, the entries it
+    // fails are kept here as hints.
+    coro::Task<std::vector<bool>> multi_put_replica(
+        std::string replica_id,
+        std::shared_ptr<const kvstore::MultiPutRequest> request);
+
+    // Replays pending hints to every replica that is up, handoff_batch_size
+    // at a time, every handoff_interval_ms.
+    void handoff_loop();
+    void deliver_hints();
+
+    // Sends `entries` to `peer` as one internal MULTI_PUT. True if the peer
+    // applied every one of them.
+    bool push_entries(const std::string& peer, const std::vector<Hint>& entries);
+
+    // Anti-entropy. Each round rebuilds the Merkle trees if this node's
+    // ranges have changed, compares them with the next peer in turn and
+    // pushes it the entries in the leaves that differ.
+    void anti_entropy_loop();
+    void anti_entropy_round();
+    void refresh_merkle_trees();
+
+    // Leaves that differ from `peer`'s, by range index, in leaf order. Found
+    // by descending from the roots one level per MERKLE_LEVEL exchange, and
+    // only into subtrees whose hashes differ. Nothing if an exchange failed.
+    using MerkleDiff = std::map<size_t, std::vector<size_t>>;
+    std::optional<MerkleDiff> diff_merkle_trees(const MerkleRanges& trees, const std::string& peer);
+
+    // Pushes `peer` this node's entries in the leaves of `diff`, paced to
+    // anti_entropy_keys_per_sec. The scan that finds them also recomputes
+    // those leaves, correcting any drift from writes during a rebuild.
+    void push_merkle_diff(MerkleRanges& trees, const std::string& peer, const MerkleDiff& diff);
+
+    // Waits `pause` unless the node is shutting down; false if it is.
+    bool anti_entropy_pause(std::chrono::milliseconds pause);
+
+    // Entries per anti-entropy push, and tree nodes compared per exchange;
+    // subtrees past that limit wait for a later round.
+    static constexpr size_t ANTI_ENTROPY_BATCH = 128;
+    static constexpr size_t MERKLE_NODES_PER_EXCHANGE = 8192;
+
+    // Returns the newest entry among `reads` and queues repairs for the
+    // replicas that answered with something older or nothing.
+    std::optional<StoreEntry> resolve_reads(const std::string& key,
+                                            const std::vector<ReplicaRead>& reads);
+
+    // How long a hedged read waits on the first `contacted` remotes before
+    // trying the next replica: the largest of their recent p95 latencies.
+    std::chrono::microseconds hedge_delay(const std::vector<const std::string*>& remotes,
+                                          size_t contacted) const;
+
+    // Deadline for one replica RPC to `peer`: TIMEOUT_P99_MULTIPLE times its
+    // recent p99, within [replica_timeout_min_ms, replica_timeout_max_ms], or
+    // `fallback` until the peer has enough history.
+    static constexpr int64_t TIMEOUT_P99_MULTIPLE = 3;
+    std::chrono::milliseconds replica_timeout(const std::string& peer,
+                                              std::chrono::milliseconds fallback) const;
+    std::chrono::milliseconds read_timeout(const std::string& peer) const;
+    std::chrono::milliseconds write_timeout(const std::string& peer) const;
+
+    // Stable-sorts `remotes` into contact order: peers that are down last,
+    // the rest by recent median latency, with peers that have too little
+    // history first so they get sampled.
+    void order_for_contact(std::vector<const std::string*>& remotes);
+
+    // False, counting a skipped call, if failure detection has `peer` down.
+    bool peer_available(const std::string& peer);
+
+    // Counts a failed replica RPC, and a timeout if it ran out its deadline;
+    // transport failures also count against the peer's circuit.
+    void count_forward_failure(const std::string& peer, const grpc::Status& status);
+
+    // Pings every peer each heartbeat_interval_ms for the failure detector.
+    void heartbeat_loop();
+    coro::Task<void> ping_peer(std::string peer);
+
+    // Hedge budget, in hundredths of a hedge: every read earns
+    // hedge_budget_percent, a hedge costs HEDGE_COST, and at most
+    // HEDGE_BURST hedges can be banked.
+    static constexpr int64_t HEDGE_COST = 100;
+    static constexpr int64_t HEDGE_BURST = 10;
+
+    // Threads that log hints for replica calls that failed; concurrent hints
+    // share a log sync, so a few threads keep an outage from serializing
+    // writes behind one fsync each.
+    static constexpr size_t HINT_WRITERS = 4;
+    void earn_hedge_credit();
+    bool spend_hedge_credit();
+
+    void checkpoint_loop();
+    static std::shared_ptr<kvstore::PutRequest> make_internal_put_request(
+        const std::string& key,
+        std::string value,
+        const Version& version
+    );
+    void poll_completion_queue();
+    void enqueue_read_repair(const std::string& replica_id,
+                             const std::string& key,
+                             const StoreEntry& winner);
+    void apply_read_repair(const RepairTask& task);
 
     kv::NodeConfig config_;
     kv::cluster::ClusterView& cluster_;
-    std::unordered_map<std::string, StoreEntry> store_;
-    std::mutex mu_;
-    std::mutex stub_mu_;
-    std::unordered_map<std::string, std::shared_ptr<grpc::Channel>> channel_cache_;
-    std::unordered_map<std::string, std::unique_ptr<kvstore::KeyValue::Stub>> stub_cache_;
+    WriterId writer_;
+    std::unique_ptr<kv::storage::StorageEngine> engine_;
+    ChannelPool channels_;
+    FailureDetector health_;
+    HintStore hints_;
 
     std::atomic<uint64_t> read_count_{0};
     std::atomic<uint64_t> write_count_{0};
     std::atomic<uint64_t> read_repair_count_{0};
     std::atomic<uint64_t> forward_failure_count_{0};
+    std::atomic<uint64_t> replica_timeout_count_{0};
+    std::atomic<uint64_t> peer_skip_count_{0};
+    std::atomic<uint64_t> hinted_write_count_{0};
+    std::atomic<uint64_t> hints_delivered_count_{0};
+    std::atomic<uint64_t> anti_entropy_round_count_{0};
+    std::atomic<uint64_t> anti_entropy_diff_count_{0};
+    std::atomic<uint64_t> anti_entropy_push_count_{0};
+    std::atomic<uint64_t> hedge_count_{0};
+    std::atomic<uint64_t> hedge_won_count_{0};
+    std::atomic<int64_t> hedge_credit_{0};
+
+    // Latency of single-key replica RPCs per peer, which drives hedging,
+    // deadlines and contact order; batch calls scale with their size and are
+    // not recorded.
+    PeerLatency latency_;
+
+    std::atomic<bool> early_write_return_{true};
+
+    // Merkle trees over the ranges this node replicates; null until the
+    // anti-entropy thread first builds them. Writers and MERKLE_LEVEL
+    // readers load it under an epoch guard; only the anti-entropy thread
+    // replaces it, and it retires the old trees.
+    std::atomic<MerkleRanges*> merkle_{nullptr};
+    size_t anti_entropy_next_peer_ = 0;  // anti-entropy thread only
+
+    // Completion queue for async replica RPCs, drained by cq_thread_.
+    grpc::CompletionQueue cq_;
+    std::thread cq_thread_;
+
+    // Hints are logged here rather than on cq_thread_, which every
+    // coordinator shares. Without hinted handoff it has no threads.
+    coro::WorkerPool hint_writers_;
+
+    ReadRepairQueue repair_queue_;
+
+    std::mutex checkpoint_stop_mu_;
+    std::condition_variable checkpoint_stop_cv_;
+    bool checkpoint_stopping_ = false;
+    std::thread checkpoint_thread_;
+
+    std::mutex heartbeat_stop_mu_;
+    std::condition_variable heartbeat_stop_cv_;
+    bool heartbeat_stopping_ = false;
+    std::thread heartbeat_thread_;
+
+    std::mutex handoff_stop_mu_;
+    std::condition_variable handoff_stop_cv_;
+    bool handoff_stopping_ = false;
+    std::thread handoff_thread_;
 
+    std::mutex anti_entropy_stop_mu_;
+    std::condition_variable anti_entropy_stop_cv_;
+    bool anti_entropy_stopping_ = false;
+    std::thread anti_entropy_thread_;
 };
 
 }
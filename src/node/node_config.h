@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "node/channel_pool.h"
+#include "storage/storage_engine.h"
+#include "storage/wal.h"
+
 namespace kv {
 
 struct NodeConfig {
@@ -14,6 +19,83 @@ struct NodeConfig {
     // Replication configuration
     size_t replication_factor = 3;  // RF: number of replicas
     int write_quorum = 1;            // W: writes needed for success
+    int read_quorum = 1;             // R: replica replies a read waits for
+
+    // Number of independently locked store shards; must be a power of two.
+    size_t store_shards = 16;
+
+    // Upper bound on pending background read repairs.
+    size_t read_repair_queue_limit = 10000;
+
+    // Hedged reads: a GET first contacts R replicas and, if they have not
+    // all answered within the slowest one's recent p95 latency (or
+    // hedge_delay_ms before there is enough history), sends the same read to
+    // the next replica in the preference list. Failed replicas are replaced
+    // immediately. Hedges are capped at hedge_budget_percent of reads.
+    // When disabled, every replica is contacted up front.
+    bool read_hedging = false;
+    uint32_t hedge_delay_ms = 10;
+    uint32_t hedge_budget_percent = 10;
+
+    // Replica RPC deadlines follow each peer's latency: a few times its
+    // recent p99, clamped to [replica_timeout_min_ms, replica_timeout_max_ms].
+    // Until a peer has enough history, reads wait replica_timeout_ms and
+    // writes wait replica_timeout_max_ms. Batch RPCs always get the maximum.
+    uint32_t replica_timeout_ms = 50;
+    uint32_t replica_timeout_min_ms = 5;
+    uint32_t replica_timeout_max_ms = 1000;
+
+    // Peer failure detection: every peer is pinged each heartbeat_interval_ms.
+    // A peer is marked down when phi accrual over its heartbeats passes
+    // phi_threshold, or after failure_threshold transport failures in a row.
+    // Replica RPCs to a down peer fail at once without being sent, until a
+    // ping succeeds at least circuit_open_ms after it went down.
+    bool failure_detection = true;
+    uint32_t heartbeat_interval_ms = 100;
+    double phi_threshold = 8.0;
+    uint32_t failure_threshold = 3;
+    uint32_t circuit_open_ms = 1000;
+
+    // Hinted handoff (sloppy quorum): a replica write that fails goes to the
+    // next healthy node past the key's preference list, which acks it
+    // toward W and holds it as a hint for the replica. Without such a node
+    // the coordinator keeps the hint, without counting it toward W. Hints
+    // are bounded by hint_limit_bytes, logged under data_dir/hints when
+    // data_dir is set, and replayed to their replica every
+    // handoff_interval_ms in batches of handoff_batch_size once it is up.
+    bool hinted_handoff = true;
+    size_t hint_limit_bytes = 64u << 20;
+    uint32_t handoff_interval_ms = 1000;
+    size_t handoff_batch_size = 128;
+
+    // Anti-entropy: the node keeps a Merkle tree of 2^merkle_tree_depth
+    // leaves per token range it replicates. Every anti_entropy_interval_ms
+    // it compares them with the next peer in turn and pushes that peer its
+    // entries in the leaves that differ, at most anti_entropy_keys_per_sec
+    // of them, so replicas converge on keys no read ever repairs.
+    bool anti_entropy = true;
+    uint32_t anti_entropy_interval_ms = 10000;
+    uint32_t anti_entropy_keys_per_sec = 1000;
+    uint32_t merkle_tree_depth = 8;
+
+    // Connections kept to each peer, and how a call picks one of them.
+    size_t peer_channels = 2;
+    kv::node::ChannelSelection peer_channel_selection = kv::node::ChannelSelection::LeastInflight;
+
+    // Storage engine: "memory" (default) or "lsm" for datasets larger than RAM.
+    kv::storage::StorageEngineKind storage_engine = kv::storage::StorageEngineKind::Memory;
+    size_t lsm_memtable_bytes = 64u << 20;  // lsm: memtable size that triggers a flush
+    size_t lsm_compaction_trigger = 4;      // lsm: similar-sized tables merged at once
+
+    // Durability. An empty data_dir keeps the memory engine purely in memory;
+    // otherwise applied puts go to a write-ahead log there and are replayed
+    // on startup.
+    std::string data_dir;
+    kv::storage::WalSyncMode wal_sync_mode = kv::storage::WalSyncMode::Batch;
+    uint32_t wal_sync_interval_ms = 10;  // periodic mode only
+    // Seconds between engine checkpoints (snapshot or memtable flush, which
+    // let the WAL be truncated); 0 disables.
+    uint32_t checkpoint_interval_s = 0;
 
     // Returns an error message if invalid, otherwise std::nullopt.
     std::optional<std::string> validate() const {
@@ -26,6 +108,86 @@ struct NodeConfig {
         if (write_quorum > static_cast<int>(replication_factor)) {
             return "write_quorum cannot exceed replication_factor";
         }
+        if (read_quorum <= 0) {
+            return "read_quorum must be >= 1";
+        }
+        if (read_quorum > static_cast<int>(replication_factor)) {
+            return "read_quorum cannot exceed replication_factor";
+        }
+        if (store_shards == 0 || (store_shards & (store_shards - 1)) != 0) {
+            return "store_shards must be a power of two";
+        }
+        if (read_repair_queue_limit == 0) {
+            return "read_repair_queue_limit must be >= 1";
+        }
+        if (read_hedging && hedge_delay_ms == 0) {
+            return "hedge_delay_ms must be >= 1";
+        }
+        if (hedge_budget_percent > 100) {
+            return "hedge_budget_percent must be <= 100";
+        }
+        if (replica_timeout_min_ms == 0) {
+            return "replica_timeout_min_ms must be >= 1";
+        }
+        if (replica_timeout_max_ms < replica_timeout_min_ms) {
+            return "replica_timeout_max_ms cannot be below replica_timeout_min_ms";
+        }
+        if (replica_timeout_ms < replica_timeout_min_ms || replica_timeout_ms > replica_timeout_max_ms) {
+            return "replica_timeout_ms must be within [replica_timeout_min_ms, replica_timeout_max_ms]";
+        }
+        if (failure_detection) {
+            if (heartbeat_interval_ms == 0) {
+                return "heartbeat_interval_ms must be >= 1";
+            }
+            if (!(phi_threshold > 0)) {
+                return "phi_threshold must be > 0";
+            }
+            if (failure_threshold == 0) {
+                return "failure_threshold must be >= 1";
+            }
+        }
+        if (hinted_handoff) {
+            if (hint_limit_bytes == 0) {
+                return "hint_limit_bytes must be >= 1";
+            }
+            if (handoff_interval_ms == 0) {
+                return "handoff_interval_ms must be >= 1";
+            }
+            if (handoff_batch_size == 0) {
+                return "handoff_batch_size must be >= 1";
+            }
+        }
+        if (anti_entropy) {
+            if (anti_entropy_interval_ms == 0) {
+                return "anti_entropy_interval_ms must be >= 1";
+            }
+            if (anti_entropy_keys_per_sec == 0) {
+                return "anti_entropy_keys_per_sec must be >= 1";
+            }
+            if (merkle_tree_depth == 0 || merkle_tree_depth > 16) {
+                return "merkle_tree_depth must be within [1, 16]";
+            }
+        }
+        if (peer_channels == 0) {
+            return "peer_channels must be >= 1";
+        }
+        if (checkpoint_interval_s > 0 && data_dir.empty()) {
+            return "checkpoint_interval_s requires data_dir";
+        }
+        if (storage_engine == kv::storage::StorageEngineKind::Lsm) {
+            if (data_dir.empty()) {
+                return "the lsm storage engine requires data_dir";
+            }
+            if (lsm_memtable_bytes == 0) {
+                return "lsm_memtable_bytes must be >= 1";
+            }
+            if (lsm_compaction_trigger < 2) {
+                return "lsm_compaction_trigger must be >= 2";
+            }
+        }
+        if (wal_sync_mode == kv::storage::WalSyncMode::Periodic && wal_sync_interval_ms == 0) {
+            return "wal_sync_interval_ms must be >= 1 in periodic mode";
+        }
         if (port <= 0) {
             return "port must be > 0";
         }
@@ -1,5 +1,9 @@
 #include "node/node_rpc_service.h"
 
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
 #include "utils/logging.h"
 namespace kv {
 namespace {
@@ -11,9 +15,151 @@ void fill_get_response(const std::optional<kv::node::StoreEntry>& entry,
         return;
     }
     response->set_found(true);
-    response->set_value(entry->value);
+    // Protobuf owns its string fields, so this is the one copy on the read path.
+    response->set_value(entry->value.str());
     response->mutable_version()->set_write_created_at_us(entry->version.write_created_at_us);
-    response->mutable_version()->set_writer_id(entry->version.writer_id);
+    response->mutable_version()->set_writer(entry->version.writer);
+}
+
+// Client-facing form: also names the writer, which peers do not need.
+void fill_client_get_response(kv::node::Node& node,
+                              const std::optional<kv::node::StoreEntry>& entry,
+                              kvstore::GetResponse* response) {
+    fill_get_response(entry, response);
+    if (entry) {
+        response->mutable_version()->set_writer_id(node.writer_name(entry->version.writer));
+    }
+}
+
+// Peers send only the compact id. A bare writer_id string is accepted only
+// if it names a known writer, so requests cannot grow the intern table.
+std::optional<kv::node::Version> version_from_request(const kv::node::Node& node,
+                                                      const kvstore::Version& version) {
+    kv::node::WriterId writer = version.writer();
+    if (writer == 0 && !version.writer_id().empty()) {
+        auto known = node.find_writer(version.writer_id());
+        if (!known) {
+            return std::nullopt;
+        }
+        writer = *known;
+    }
+    return kv::node::Version{version.write_created_at_us(), writer};
+}
+
+grpc::Status unknown_writer(const std::string& name) {
+    return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "unknown writer_id '" + name + "'");
+}
+
+// Replica-side handlers shared by the sync and async servers.
+grpc::Status apply_internal_put(kv::node::Node& node,
+                                const kvstore::PutRequest& request,
+                                kvstore::PutResponse* response) {
+    LOG_DEBUG("[node=" << node.node_id()
+              << "] internal PUT (key=" << request.key() << ")");
+    auto version = version_from_request(node, request.version());
+    if (!version) {
+        return unknown_writer(request.version().writer_id());
+    }
+    // A fallback holds a hinted write for its replica instead of applying it.
+    if (!request.hint_for().empty() && request.hint_for() != node.node_id()) {
+        response->set_success(node.store_hint(request.hint_for(), request.key(), request.value(), *version));
+        return grpc::Status::OK;
+    }
+    response->set_success(node.apply_put_local(request.key(), request.value(), *version));
+    return grpc::Status::OK;
+}
+
+grpc::Status unreadable(const kv::storage::StorageError& e) {
+    return grpc::Status(grpc::StatusCode::DATA_LOSS, e.what());
+}
+
+// A key the engine cannot read fails the RPC, so the coordinator counts this
+// replica as failed instead of as a miss.
+grpc::Status read_internal_get(kv::node::Node& node,
+                               const kvstore::GetRequest& request,
+                               kvstore::GetResponse* response) {
+    LOG_DEBUG("[node=" << node.node_id()
+              << "] internal GET (key=" << request.key() << ")");
+    try {
+        fill_get_response(node.local_get(request.key()), response);
+    } catch (const kv::storage::StorageError& e) {
+        return unreadable(e);
+    }
+    return grpc::Status::OK;
+}
+
+// The batch is rejected whole if any entry names an unknown writer, so
+// nothing is applied from it.
+grpc::Status apply_internal_multi_put(kv::node::Node& node,
+                                      const kvstore::MultiPutRequest& request,
+                                      kvstore::MultiPutResponse* response) {
+    LOG_DEBUG("[node=" << node.node_id()
+              << "] internal MULTI_PUT (keys=" << request.entries_size() << ")");
+    std::vector<kv::node::Version> versions;
+    versions.reserve(static_cast<size_t>(request.entries_size()));
+    for (const auto& entry : request.entries()) {
+        auto version = version_from_request(node, entry.version());
+        if (!version) {
+            return unknown_writer(entry.version().writer_id());
+        }
+        versions.push_back(*version);
+    }
+    for (int i = 0; i < request.entries_size(); ++i) {
+        const auto& entry = request.entries(i);
+        bool ok = node.apply_put_local(entry.key(), entry.value(), versions[static_cast<size_t>(i)]);
+        response->add_results()->set_success(ok);
+    }
+    return grpc::Status::OK;
+}
+
+grpc::Status read_internal_multi_get(kv::node::Node& node,
+                                    const kvstore::MultiGetRequest& request,
+                                    kvstore::MultiGetResponse* response) {
+    LOG_DEBUG("[node=" << node.node_id()
+              << "] internal MULTI_GET (keys=" << request.keys_size() << ")");
+    try {
+        for (const auto& key : request.keys()) {
+            fill_get_response(node.local_get(key), response->add_results());
+        }
+    } catch (const kv::storage::StorageError& e) {
+        return unreadable(e);
+    }
+    return grpc::Status::OK;
+}
+
+void read_merkle_level(kv::node::Node& node,
+                       const kvstore::MerkleLevelRequest& request,
+                       kvstore::MerkleLevelResponse* response) {
+    LOG_DEBUG("[node=" << node.node_id() << "] MERKLE_LEVEL from " << request.node_id()
+              << " (ranges=" << request.ranges_size() << ")");
+    for (const auto& nodes : request.ranges()) {
+        auto* out = response->add_ranges();
+        auto level = node.merkle_level(nodes.range_start(), nodes.range_end(),
+                                       request.depth(), nodes.level());
+        if (!level) {
+            out->set_found(false);
+            continue;
+        }
+        out->set_found(true);
+        for (uint32_t index : nodes.indexes()) {
+            if (index >= level->size()) {
+                out->set_found(false);
+                out->clear_hashes();
+                break;
+            }
+            out->add_hashes((*level)[index]);
+        }
+    }
+}
+
+std::vector<std::pair<std::string, std::string>> items_from_request(
+        const kvstore::MultiPutRequest& request) {
+    std::vector<std::pair<std::string, std::string>> items;
+    items.reserve(static_cast<size_t>(request.entries_size()));
+    for (const auto& entry : request.entries()) {
+        items.emplace_back(entry.key(), entry.value());
+    }
+    return items;
 }
 } 
 
@@ -28,15 +174,7 @@ grpc::Status NodeRpcService::Put(
     kvstore::PutResponse* response) {
 
     if (request->is_internal()) {
-        LOG_DEBUG("[node=" << node_ref_.node_id()
-                  << "] internal PUT (key=" << request->key() << ")");
-        kv::node::Version version{
-            request->version().write_created_at_us(),
-            request->version().writer_id()
-        };
-        bool ok = node_ref_.apply_put_local(request->key(), request->value(), version);
-        response->set_success(ok);
-        return grpc::Status::OK;
+        return apply_internal_put(node_ref_, *request, response);
     }
 
     bool ok = node_ref_.put(request->key(), request->value());
@@ -53,17 +191,317 @@ grpc::Status NodeRpcService::Get(
 
     // INTERNAL REPLICA GET: do NOT forward
     if (request->is_internal()) {
-        LOG_DEBUG("[node=" << node_ref_.node_id()
-                  << "] internal GET (key=" << request->key() << ")");
-        auto entry = node_ref_.local_get(request->key());
-        fill_get_response(entry, response);
-        return grpc::Status::OK;
+        return read_internal_get(node_ref_, *request, response);
     }
 
     // CLIENT GET: coordinator path (may forward)
-    auto entry = node_ref_.get(request->key());
-    fill_get_response(entry, response);
+    fill_client_get_response(node_ref_, node_ref_.get(request->key()), response);
+    return grpc::Status::OK;
+}
+
+// Handle MultiPut RPCs; results are positional. Internal batches apply each
+// entry locally, client batches coordinate replication per replica group.
+grpc::Status NodeRpcService::MultiPut(
+    grpc::ServerContext* /*context*/,
+    const kvstore::MultiPutRequest* request,
+    kvstore::MultiPutResponse* response) {
+
+    if (request->is_internal()) {
+        return apply_internal_multi_put(node_ref_, *request, response);
+    }
+
+    for (bool ok : node_ref_.multi_put(items_from_request(*request))) {
+        response->add_results()->set_success(ok);
+    }
     return grpc::Status::OK;
 }
 
+// Handle MultiGet RPCs; results are positional.
+grpc::Status NodeRpcService::MultiGet(
+    grpc::ServerContext* /*context*/,
+    const kvstore::MultiGetRequest* request,
+    kvstore::MultiGetResponse* response) {
+
+    if (request->is_internal()) {
+        return read_internal_multi_get(node_ref_, *request, response);
+    }
+
+    std::vector<std::string> keys(request->keys().begin(), request->keys().end());
+    for (const auto& entry : node_ref_.multi_get(keys)) {
+        fill_client_get_response(node_ref_, entry, response->add_results());
+    }
+    return grpc::Status::OK;
+}
+
+// Answer a peer's heartbeat.
+grpc::Status NodeRpcService::Ping(
+    grpc::ServerContext* /*context*/,
+    const kvstore::PingRequest* /*request*/,
+    kvstore::PingResponse* response) {
+
+    response->set_node_id(node_ref_.node_id());
+    return grpc::Status::OK;
+}
+
+// Answer a peer's anti-entropy comparison from this node's Merkle trees.
+grpc::Status NodeRpcService::MerkleLevel(
+    grpc::ServerContext* /*context*/,
+    const kvstore::MerkleLevelRequest* request,
+    kvstore::MerkleLevelResponse* response) {
+
+    read_merkle_level(node_ref_, *request, response);
+    return grpc::Status::OK;
+}
+
+// ---------------------------------------------------------------------------
+// AsyncNodeServer
+// ---------------------------------------------------------------------------
+namespace {
+
+using AsyncService = kvstore::KeyValue::AsyncService;
+
+// Tag for the server completion queues, like Node's AsyncCall: the queue
+// thread calls proceed() with the event's ok flag.
+class ServerCall {
+public:
+    virtual ~ServerCall() = default;
+    virtual void proceed(bool ok) = 0;
+};
+
+// One unary request from arrival to reply. Arrival re-arms the method on the
+// same queue and runs the handler, which fills `response` and calls finish()
+// exactly once, from any thread. The Finish event then deletes the call.
+template <typename Request, typename Response>
+class UnaryCall final : public ServerCall {
+public:
+    using Requester = void (AsyncService::*)(
+        grpc::ServerContext*, Request*, grpc::ServerAsyncResponseWriter<Response>*,
+        grpc::CompletionQueue*, grpc::ServerCompletionQueue*, void*);
+    using Handler = void (*)(kv::node::Node&, UnaryCall&);
+
+    struct Env {
+        AsyncService* service;
+        grpc::ServerCompletionQueue* cq;
+        kv::node::Node* node;
+        AsyncNodeServer::Inflight* inflight;
+    };
+
+    static void listen(const Env& env, Requester requester, Handler handler) {
+        auto* call = new UnaryCall(env, requester, handler);
+        (env.service->*requester)(&call->ctx_, &call->request, &call->writer_,
+                                  env.cq, env.cq, call);
+    }
+
+    void proceed(bool ok) override {
+        if (finishing_) {
+            env_.inflight->remove();
+            delete this;
+            return;
+        }
+        if (!ok) {
+            delete this;  // queue shutting down; no request arrived
+            return;
+        }
+        env_.inflight->add();
+        listen(env_, requester_, handler_);
+        handler_(*env_.node, *this);
+    }
+
+    void finish(const grpc::Status& status = grpc::Status::OK) {
+        finishing_ = true;
+        writer_.Finish(response, status, this);
+    }
+
+    Request request;
+    Response response;
+
+private:
+    UnaryCall(const Env& env, Requester requester, Handler handler)
+        : env_(env), requester_(requester), handler_(handler), writer_(&ctx_) {}
+
+    Env env_;
+    Requester requester_;
+    Handler handler_;
+    grpc::ServerContext ctx_;
+    grpc::ServerAsyncResponseWriter<Response> writer_;
+    bool finishing_ = false;
+};
+
+using PutCall = UnaryCall<kvstore::PutRequest, kvstore::PutResponse>;
+using GetCall = UnaryCall<kvstore::GetRequest, kvstore::GetResponse>;
+using MultiPutCall = UnaryCall<kvstore::MultiPutRequest, kvstore::MultiPutResponse>;
+using MultiGetCall = UnaryCall<kvstore::MultiGetRequest, kvstore::MultiGetResponse>;
+using PingCall = UnaryCall<kvstore::PingRequest, kvstore::PingResponse>;
+using MerkleLevelCall = UnaryCall<kvstore::MerkleLevelRequest, kvstore::MerkleLevelResponse>;
+
+void handle_put(kv::node::Node& node, PutCall& call) {
+    if (call.request.is_internal()) {
+        call.finish(apply_internal_put(node, call.request, &call.response));
+        return;
+    }
+    node.put_async(call.request.key(), std::move(*call.request.mutable_value()),
+        [&call](bool ok) {
+            call.response.set_success(ok);
+            call.finish();
+        });
+}
+
+void handle_get(kv::node::Node& node, GetCall& call) {
+    if (call.request.is_internal()) {
+        call.finish(read_internal_get(node, call.request, &call.response));
+        return;
+    }
+    node.get_async(call.request.key(),
+        [&node, &call](std::optional<kv::node::StoreEntry> entry) {
+            fill_client_get_response(node, entry, &call.response);
+            call.finish();
+        });
+}
+
+void handle_multi_put(kv::node::Node& node, MultiPutCall& call) {
+    if (call.request.is_internal()) {
+        call.finish(apply_internal_multi_put(node, call.request, &call.response));
+        return;
+    }
+    node.multi_put_async(items_from_request(call.request),
+        [&call](std::vector<bool> oks) {
+            for (bool ok : oks) {
+                call.response.add_results()->set_success(ok);
+            }
+            call.finish();
+        });
+}
+
+void handle_multi_get(kv::node::Node& node, MultiGetCall& call) {
+    if (call.request.is_internal()) {
+        call.finish(read_internal_multi_get(node, call.request, &call.response));
+        return;
+    }
+    std::vector<std::string> keys(call.request.keys().begin(), call.request.keys().end());
+    node.multi_get_async(keys,
+        [&node, &call](std::vector<std::optional<kv::node::StoreEntry>> entries) {
+            for (const auto& entry : entries) {
+                fill_client_get_response(node, entry, call.response.add_results());
+            }
+            call.finish();
+        });
+}
+
+void handle_ping(kv::node::Node& node, PingCall& call) {
+    call.response.set_node_id(node.node_id());
+    call.finish();
+}
+
+void handle_merkle_level(kv::node::Node& node, MerkleLevelCall& call) {
+    read_merkle_level(node, call.request, &call.response);
+    call.finish();
+}
+
+} 
+
+void AsyncNodeServer::Inflight::add() {
+    std::lock_guard<std::mutex> lock(mu);
+    count++;
+}
+
+void AsyncNodeServer::Inflight::remove() {
+    std::lock_guard<std::mutex> lock(mu);
+    if (--count == 0) {
+        cv.notify_all();
+    }
+}
+
+AsyncNodeServer::AsyncNodeServer(kv::node::Node& node,
+                                 const std::string& listen_address,
+                                 const AsyncServerOptions& options)
+    : node_(node) {
+    if (auto err = options.validate()) {
+        throw std::invalid_argument(*err);
+    }
+
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort(listen_address, grpc::InsecureServerCredentials(), &port_);
+    builder.RegisterService(&service_);
+    for (size_t i = 0; i < options.completion_queues; ++i) {
+        cqs_.push_back(builder.AddCompletionQueue());
+    }
+    server_ = builder.BuildAndStart();
+    if (!server_ || port_ == 0) {
+        throw std::runtime_error("cannot listen on " + listen_address);
+    }
+
+    // One armed request per method per queue thread, so every thread can
+    // pick up a new arrival without waiting for another to re-arm.
+    const size_t per_queue = options.threads / options.completion_queues;
+    for (auto& cq : cqs_) {
+        for (size_t i = 0; i < per_queue; ++i) {
+            PutCall::listen({&service_, cq.get(), &node_, &inflight_},
+                            &AsyncService::RequestPut, handle_put);
+            GetCall::listen({&service_, cq.get(), &node_, &inflight_},
+                            &AsyncService::RequestGet, handle_get);
+            MultiPutCall::listen({&service_, cq.get(), &node_, &inflight_},
+                                 &AsyncService::RequestMultiPut, handle_multi_put);
+            MultiGetCall::listen({&service_, cq.get(), &node_, &inflight_},
+                                 &AsyncService::RequestMultiGet, handle_multi_get);
+            PingCall::listen({&service_, cq.get(), &node_, &inflight_},
+                             &AsyncService::RequestPing, handle_ping);
+            MerkleLevelCall::listen({&service_, cq.get(), &node_, &inflight_},
+                                    &AsyncService::RequestMerkleLevel, handle_merkle_level);
+        }
+    }
+
+    for (size_t t = 0; t < options.threads; ++t) {
+        grpc::ServerCompletionQueue* cq = cqs_[t % cqs_.size()].get();
+        threads_.emplace_back([this, cq] { serve(cq); });
+    }
+}
+
+AsyncNodeServer::~AsyncNodeServer() {
+    shutdown();
+}
+
+void AsyncNodeServer::serve(grpc::ServerCompletionQueue* cq) {
+    void* tag = nullptr;
+    bool ok = false;
+    while (cq->Next(&tag, &ok)) {
+        static_cast<ServerCall*>(tag)->proceed(ok);
+    }
+}
+
+void AsyncNodeServer::wait() {
+    std::unique_lock<std::mutex> lock(shutdown_mu_);
+    shutdown_cv_.wait(lock, [this] { return shut_down_; });
+}
+
+void AsyncNodeServer::shutdown() {
+    std::unique_lock<std::mutex> lock(shutdown_mu_);
+    if (shut_down_ || threads_.empty()) {
+        return;
+    }
+
+    // Accepted client requests finish on the node's completion-queue thread
+    // and reply through our queues, so those must keep running until every
+    // reply has been sent.
+    server_->Shutdown(std::chrono::system_clock::now() + std::chrono::seconds(5));
+    {
+        std::unique_lock<std::mutex> inflight_lock(inflight_.mu);
+        inflight_.cv.wait(inflight_lock, [this] { return inflight_.count == 0; });
+    }
+    for (auto& cq : cqs_) {
+        cq->Shutdown();
+    }
+    for (auto& t : threads_) {
+        t.join();
+    }
+    threads_.clear();
+
+    shut_down_ = true;
+    shutdown_cv_.notify_all();
+}
+
+size_t AsyncNodeServer::inflight() const {
+    std::lock_guard<std::mutex> lock(inflight_.mu);
+    return inflight_.count;
+}
+
 } 
@@ -1,10 +1,21 @@
 #pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "kv.pb.h"
 #include "kv.grpc.pb.h"
 #include "node/node.h"
 
 namespace kv {
 
+// Synchronous service: gRPC runs each request on a thread of its own pool,
+// and a coordinator request holds that thread until its quorum is in.
 class NodeRpcService final : public kvstore::KeyValue::Service {
 public:
     explicit NodeRpcService(kv::node::Node& node);
@@ -19,8 +30,102 @@ public:
         const kvstore::PutRequest* request,
         kvstore::PutResponse* response) override;
 
+    grpc::Status MultiGet(
+        grpc::ServerContext* context,
+        const kvstore::MultiGetRequest* request,
+        kvstore::MultiGetResponse* response) override;
+
+    grpc::Status MultiPut(
+        grpc::ServerContext* context,
+        const kvstore::MultiPutRequest* request,
+        kvstore::MultiPutResponse* response) override;
+
+    grpc::Status Ping(
+        grpc::ServerContext* context,
+        const kvstore::PingRequest* request,
+        kvstore::PingResponse* response) override;
+
+    grpc::Status MerkleLevel(
+        grpc::ServerContext* context,
+        const kvstore::MerkleLevelRequest* request,
+        kvstore::MerkleLevelResponse* response) override;
+
 private:
     kv::node::Node& node_ref_;
 };
 
+struct AsyncServerOptions {
+    size_t completion_queues = 2;
+    size_t threads = 4;  // spread evenly over the completion queues
+
+    // Returns an error message if invalid, otherwise std::nullopt.
+    std::optional<std::string> validate() const {
+        if (completion_queues == 0) {
+            return "completion_queues must be >= 1";
+        }
+        if (threads < completion_queues) {
+            return "threads must be >= completion_queues";
+        }
+        return std::nullopt;
+    }
+};
+
+// Completion-queue server with the same behaviour as NodeRpcService. Internal
+// (replica) requests are answered inline on a queue thread; client requests
+// start the node's async coordinator and release the thread, and the reply is
+// sent from whichever thread sees the quorum complete. A node can therefore
+// hold far more concurrent client requests than it has server threads.
+class AsyncNodeServer {
+public:
+    // Binds `listen_address` (port 0 picks a free port) and starts serving.
+    // Throws std::invalid_argument for bad options, std::runtime_error if the
+    // address cannot be bound.
+    AsyncNodeServer(kv::node::Node& node,
+                    const std::string& listen_address,
+                    const AsyncServerOptions& options);
+
+    // Calls shutdown().
+    ~AsyncNodeServer();
+
+    AsyncNodeServer(const AsyncNodeServer&) = delete;
+    AsyncNodeServer& operator=(const AsyncNodeServer&) = delete;
+
+    int port() const { return port_; }
+
+    // Blocks until shutdown() has completed.
+    void wait();
+
+    // Stops accepting requests, lets accepted ones finish, then stops the
+    // queue threads. Idempotent.
+    void shutdown();
+
+    // Requests accepted and not yet answered.
+    size_t inflight() const;
+
+    // Accepted-but-unanswered request count, shared with the per-call state.
+    struct Inflight {
+        mutable std::mutex mu;
+        std::condition_variable cv;
+        size_t count = 0;
+
+        void add();
+        void remove();
+    };
+
+private:
+    void serve(grpc::ServerCompletionQueue* cq);
+
+    kv::node::Node& node_;
+    kvstore::KeyValue::AsyncService service_;
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> cqs_;
+    std::unique_ptr<grpc::Server> server_;
+    std::vector<std::thread> threads_;
+    Inflight inflight_;
+    int port_ = 0;
+
+    std::mutex shutdown_mu_;
+    std::condition_variable shutdown_cv_;
+    bool shut_down_ = false;
+};
+
 } 
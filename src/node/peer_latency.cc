@@ -0,0 +1,99 @@
+#include "node/peer_latency.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace kv::node {
+
+PeerLatency::PeerLatency(uint32_t window, uint32_t min_samples)
+    : window_(std::max<uint32_t>(window, 1)), min_samples_(std::max<uint32_t>(min_samples, 1)) {}
+
+size_t PeerLatency::bucket_of(uint64_t us) {
+    if (us < 4) {
+        return static_cast<size_t>(us);
+    }
+    // Top three significant bits: the power of two and which quarter of it.
+    const auto exponent = static_cast<size_t>(std::bit_width(us)) - 1;
+    const auto quarter = static_cast<size_t>((us >> (exponent - 2)) & 3);
+    return std::min(4 * (exponent - 1) + quarter, BUCKETS - 1);
+}
+
+uint64_t PeerLatency::upper_bound_of(size_t bucket) {
+    if (bucket < 4) {
+        return bucket;
+    }
+    const size_t exponent = bucket / 4 + 1;
+    const uint64_t quarter = bucket % 4;
+    return ((4 + quarter + 1) << (exponent - 2)) - 1;
+}
+
+PeerLatency::Stats& PeerLatency::stats_for(const std::string& peer) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        auto it = peers_.find(peer);
+        if (it != peers_.end()) {
+            return *it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mu_);
+    auto& stats = peers_[peer];
+    if (!stats) {
+        stats = std::make_unique<Stats>();
+    }
+    return *stats;
+}
+
+void PeerLatency::record(const std::string& peer, Micros latency) {
+    const auto us = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+    Stats& stats = stats_for(peer);
+    std::lock_guard<std::mutex> lock(stats.mu);
+    stats.counts[bucket_of(us)]++;
+    stats.total++;
+    if (++stats.since_decay >= window_) {
+        stats.since_decay = 0;
+        stats.total = 0;
+        for (auto& count : stats.counts) {
+            count /= 2;
+            stats.total += count;
+        }
+    }
+}
+
+std::optional<PeerLatency::Micros> PeerLatency::quantile(const std::string& peer, double q) const {
+    const Stats* stats = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        auto it = peers_.find(peer);
+        if (it == peers_.end()) {
+            return std::nullopt;
+        }
+        stats = it->second.get();  // entries are never removed
+    }
+    std::lock_guard<std::mutex> lock(stats->mu);
+    if (stats->total < min_samples_) {
+        return std::nullopt;
+    }
+    const auto target = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * stats->total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += stats->counts[i];
+        if (seen >= target) {
+            return Micros(static_cast<int64_t>(upper_bound_of(i)));
+        }
+    }
+    return Micros(static_cast<int64_t>(upper_bound_of(BUCKETS - 1)));
+}
+
+std::vector<std::string> PeerLatency::peers() const {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    std::vector<std::string> names;
+    names.reserve(peers_.size());
+    for (const auto& [name, stats] : peers_) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+- Per-peer latency of replica RPCs, as a decaying log-linear histogram
+  (4 buckets per power of two of microseconds, so quantiles are within
+  ~19%). Every `window` samples all counts are halved, so estimates follow
+  the peer's recent behaviour rather than its whole history.
+- Quantiles are only reported once a peer has `min_samples` recent samples;
+  callers fall back to their configured defaults until then.
+*/
+namespace kv::node {
+
+class PeerLatency {
+public:
+    using Micros = std::chrono::microseconds;
+
+    explicit PeerLatency(uint32_t window = 512, uint32_t min_samples = 16);
+
+    PeerLatency(const PeerLatency&) = delete;
+    PeerLatency& operator=(const PeerLatency&) = delete;
+
+    // Records one successful call to `peer`.
+    void record(const std::string& peer, Micros latency);
+
+    // Latency that fraction `q` of `peer`'s recent calls finished within,
+    // or nullopt with too few samples.
+    std::optional<Micros> quantile(const std::string& peer, double q) const;
+
+    // Every peer that has recorded at least one call.
+    std::vector<std::string> peers() const;
+
+private:
+    static constexpr size_t BUCKETS = 4 * 40;  // up to 2^40 us
+
+    struct Stats {
+        mutable std::mutex mu;
+        uint32_t counts[BUCKETS] = {};
+        uint32_t total = 0;    // decayed sample count
+        uint32_t since_decay = 0;
+    };
+
+    static size_t bucket_of(uint64_t us);
+    static uint64_t upper_bound_of(size_t bucket);
+
+    Stats& stats_for(const std::string& peer);
+
+    const uint32_t window_;
+    const uint32_t min_samples_;
+
+    mutable std::shared_mutex mu_;
+    std::unordered_map<std::string, std::unique_ptr<Stats>> peers_;
+};
+
+}
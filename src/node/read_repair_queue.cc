@@ -0,0 +1,121 @@
+#include "node/read_repair_queue.h"
+
+#include <utility>
+
+namespace kv::node {
+
+namespace {
+// Replica ids never contain NUL, so this is an unambiguous (replica, key) id.
+std::string repair_id(const RepairTask& task) {
+    std::string id;
+    id.reserve(task.replica_id.size() + 1 + task.key.size());
+    id.append(task.replica_id);
+    id.push_back('\0');
+    id.append(task.key);
+    return id;
+}
+}
+
+ReadRepairQueue::ReadRepairQueue(size_t max_pending,
+                                 std::function<void(const RepairTask&)> repair)
+    : max_pending_(max_pending),
+      repair_(std::move(repair)),
+      worker_([this] { run(); }) {}
+
+ReadRepairQueue::~ReadRepairQueue() {
+    stop();
+}
+
+ReadRepairQueue::EnqueueResult ReadRepairQueue::enqueue(RepairTask task) {
+    std::string id = repair_id(task);
+
+    std::lock_guard<std::mutex> lock(mu_);
+    if (stopping_) {
+        dropped_++;
+        return EnqueueResult::Dropped;
+    }
+
+    auto it = pending_.find(id);
+    if (it != pending_.end()) {
+        if (is_newer(task.entry.version, it->second.entry.version)) {
+            it->second = std::move(task);
+        }
+        coalesced_++;
+        return EnqueueResult::Coalesced;
+    }
+
+    if (pending_.size() >= max_pending_) {
+        dropped_++;
+        return EnqueueResult::Dropped;
+    }
+
+    pending_.emplace(id, std::move(task));
+    order_.push_back(std::move(id));
+    work_cv_.notify_one();
+    return EnqueueResult::Queued;
+}
+
+void ReadRepairQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (stopping_ && !worker_.joinable()) {
+            return;
+        }
+        stopping_ = true;
+        order_.clear();
+        pending_.clear();
+    }
+    work_cv_.notify_all();
+    idle_cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void ReadRepairQueue::wait_idle() {
+    std::unique_lock<std::mutex> lock(mu_);
+    idle_cv_.wait(lock, [this] {
+        return stopping_ || (order_.empty() && !running_);
+    });
+}
+
+size_t ReadRepairQueue::depth() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return pending_.size();
+}
+
+uint64_t ReadRepairQueue::coalesced() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return coalesced_;
+}
+
+uint64_t ReadRepairQueue::dropped() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return dropped_;
+}
+
+void ReadRepairQueue::run() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (true) {
+        work_cv_.wait(lock, [this] { return stopping_ || !order_.empty(); });
+        if (stopping_) {
+            return;
+        }
+
+        auto handle = pending_.extract(order_.front());
+        order_.pop_front();
+        running_ = true;
+
+        // Repair writes go over the network; never hold the lock across them.
+        lock.unlock();
+        repair_(handle.mapped());
+        lock.lock();
+
+        running_ = false;
+        if (order_.empty()) {
+            idle_cv_.notify_all();
+        }
+    }
+}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "node/version.h"
+
+/*
+- Background queue for read repairs, so GETs do not wait on repair writes.
+- Repairs are keyed by (replica, key): a repair enqueued while an older one
+  for the same pair is still pending replaces it if newer, otherwise is dropped.
+- Bounded by max_pending; repairs beyond the bound are dropped and will be
+  retried by the next read that observes the stale replica.
+*/
+namespace kv::node {
+
+struct RepairTask {
+    std::string replica_id;
+    std::string key;
+    StoreEntry entry;
+};
+
+class ReadRepairQueue {
+public:
+    enum class EnqueueResult { Queued, Coalesced, Dropped };
+
+    // `repair` runs on the queue's worker thread, one task at a time.
+    ReadRepairQueue(size_t max_pending, std::function<void(const RepairTask&)> repair);
+    ~ReadRepairQueue();
+
+    ReadRepairQueue(const ReadRepairQueue&) = delete;
+    ReadRepairQueue& operator=(const ReadRepairQueue&) = delete;
+
+    EnqueueResult enqueue(RepairTask task);
+
+    // Stops the worker; pending repairs are discarded. Idempotent.
+    void stop();
+
+    // Blocks until no repair is pending or running. Intended for tests.
+    void wait_idle();
+
+    size_t depth() const;
+    uint64_t coalesced() const;
+    uint64_t dropped() const;
+
+private:
+    void run();
+
+    const size_t max_pending_;
+    std::function<void(const RepairTask&)> repair_;
+
+    mutable std::mutex mu_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::string> order_;                       // FIFO of pending ids
+    std::unordered_map<std::string, RepairTask> pending_; // id -> newest repair
+    bool running_ = false;
+    bool stopping_ = false;
+    uint64_t coalesced_ = 0;
+    uint64_t dropped_ = 0;
+
+    std::thread worker_;
+};
+
+}
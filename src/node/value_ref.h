@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace kv::node {
+
+// Immutable, reference-counted value buffer. Copies share the same bytes, so
+// a value is held once no matter how many store entries, repair tasks and
+// outgoing requests refer to it.
+class ValueRef {
+public:
+    ValueRef() = default;
+    ValueRef(std::string value)
+        : data_(std::make_shared<const std::string>(std::move(value))) {}
+    ValueRef(const char* value) : ValueRef(std::string(value)) {}
+
+    // Shares an existing buffer, e.g. a string owned by an in-flight request
+    // via shared_ptr's aliasing constructor.
+    explicit ValueRef(std::shared_ptr<const std::string> data)
+        : data_(std::move(data)) {}
+
+    const std::string& str() const { return data_ ? *data_ : empty_string(); }
+    std::string_view view() const { return str(); }
+    size_t size() const { return str().size(); }
+    bool empty() const { return str().empty(); }
+
+    // True when both refer to the same underlying buffer.
+    bool shares_buffer_with(const ValueRef& other) const {
+        return data_ == other.data_;
+    }
+
+    friend bool operator==(const ValueRef& a, const ValueRef& b) {
+        return a.view() == b.view();
+    }
+    friend bool operator==(const ValueRef& a, std::string_view b) {
+        return a.view() == b;
+    }
+    friend bool operator==(const ValueRef& a, const std::string& b) {
+        return a.view() == b;
+    }
+    friend bool operator==(const ValueRef& a, const char* b) {
+        return a.view() == b;
+    }
+    friend std::ostream& operator<<(std::ostream& os, const ValueRef& v) {
+        return os << v.view();
+    }
+
+private:
+    static const std::string& empty_string() {
+        static const std::string kEmpty;
+        return kEmpty;
+    }
+
+    std::shared_ptr<const std::string> data_;
+};
+
+}
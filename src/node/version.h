@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "node/value_ref.h"
+
+namespace kv::node {
+
+// Compact writer id, interned from the node id by ClusterView. 0 means unset.
+using WriterId = uint32_t;
+
+struct Version {
+    uint64_t write_created_at_us; // write creation time (microseconds since epoch)
+    WriterId writer;              // who wrote the current version?
+};
+
+static_assert(sizeof(Version) == 16, "Version should stay a packed 16-byte pair");
+
+struct StoreEntry {
+    ValueRef value;
+    Version version;
+};
+
+// Last-write-wins ordering: later timestamp wins, ties broken by writer id.
+inline bool is_newer(const Version& a, const Version& b) {
+    if (a.write_created_at_us != b.write_created_at_us) {
+        return a.write_created_at_us > b.write_created_at_us;
+    }
+    return a.writer > b.writer;
+}
+
+}
@@ -1,85 +1,208 @@
 #include "ring/consistent_hash_ring.h"
 #include "hash/murmur3.h"
 
-#include <unordered_set>
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
 
 namespace kv::ring {
 
     static constexpr uint64_t DEFAULT_SEED = 0xdeadbeef;
 
-    ConsistentHashRing::ConsistentHashRing(size_t vnodes)
-        : vnodes_(vnodes) {}
+    ConsistentHashRing::ConsistentHashRing(size_t vnodes, size_t replicas)
+        : vnodes_(vnodes), replicas_(replicas) {}
 
     void ConsistentHashRing::add_node(const std::string& node_id) {
+        if (std::find(node_ids_.begin(), node_ids_.end(), node_id) != node_ids_.end()) {
+            return;  // same vnodes, same tokens
+        }
+        const auto slot = static_cast<uint32_t>(node_ids_.size());
+        node_ids_.push_back(node_id);
+
+        std::vector<std::pair<uint64_t, uint32_t>> entries;
+        entries.reserve(tokens_.size() + vnodes_);
+        for (size_t i = 0; i < tokens_.size(); ++i) {
+            entries.emplace_back(tokens_[i], owners_[i]);
+        }
+        const auto existing = static_cast<std::ptrdiff_t>(entries.size());
         for (size_t i = 0; i < vnodes_; ++i) {
             std::string vnode_key = node_id + "#" + std::to_string(i);
-            uint64_t h = hash(vnode_key);
-            ring_[h] = node_id;
+            entries.emplace_back(token(vnode_key), slot);
+        }
+        auto by_token = [](const auto& a, const auto& b) { return a.first < b.first; };
+        std::sort(entries.begin() + existing, entries.end(), by_token);
+        std::inplace_merge(entries.begin(), entries.begin() + existing, entries.end(), by_token);
+
+        // On a token collision the newest node wins, as it did when the ring
+        // was a map assigned in insertion order.
+        tokens_.clear();
+        owners_.clear();
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (i + 1 < entries.size() && entries[i + 1].first == entries[i].first) {
+                continue;
+            }
+            tokens_.push_back(entries[i].first);
+            owners_.push_back(entries[i].second);
         }
+        rebuild_preferences();
     }
 
     void ConsistentHashRing::remove_node(const std::string& node_id) {
-        for (auto it = ring_.begin(); it != ring_.end();) {
-            if (it->second == node_id) {
-                it = ring_.erase(it);
-            } else {
-                ++it;
+        auto it = std::find(node_ids_.begin(), node_ids_.end(), node_id);
+        if (it == node_ids_.end()) {
+            return;
+        }
+        const auto slot = static_cast<uint32_t>(it - node_ids_.begin());
+        node_ids_.erase(it);
+
+        size_t out = 0;
+        for (size_t i = 0; i < tokens_.size(); ++i) {
+            if (owners_[i] == slot) {
+                continue;
             }
+            tokens_[out] = tokens_[i];
+            owners_[out] = owners_[i] > slot ? owners_[i] - 1 : owners_[i];
+            ++out;
         }
+        tokens_.resize(out);
+        owners_.resize(out);
+        rebuild_preferences();
     }
 
     std::string ConsistentHashRing::get_owner_node(const std::string& key) const {
-        if (ring_.empty()) {
+        if (tokens_.empty()) {
             throw std::runtime_error("hash ring is empty");
         }
-
-        uint64_t h = hash(key);
-        auto it = ring_.lower_bound(h);
-
-        if (it == ring_.end()) {
-            return ring_.begin()->second; 
-        }
-        return it->second;
+        return node_ids_[owners_[successor(token(key))]];
     }
 
     std::vector<std::string>
     ConsistentHashRing::get_preference_list(const std::string& key,
                                             size_t num_replicas) const {
         std::vector<std::string> result;
-        if (ring_.empty() || num_replicas == 0) return result;
+        if (tokens_.empty() || num_replicas == 0) return result;
 
-        std::unordered_set<std::string> seen;
-        const uint64_t key_hash = hash(key);
+        const size_t wanted = std::min(num_replicas, node_ids_.size());
+        result.reserve(wanted);
+        if (wanted <= width_) {
+            for (uint32_t slot : preference_slots(key, wanted)) {
+                result.push_back(node_ids_[slot]);
+            }
+            return result;
+        }
 
-        auto it = ring_.lower_bound(key_hash);
-        if (it == ring_.end()) it = ring_.begin();
+        // Wider than the precomputed table: walk the ring.
+        std::vector<uint32_t> picked;
+        picked.reserve(wanted);
+
+        size_t i = successor(token(key));
+        for (size_t steps = 0; steps < tokens_.size() && picked.size() < wanted; ++steps) {
+            const uint32_t owner = owners_[i];
+            if (std::find(picked.begin(), picked.end(), owner) == picked.end()) {
+                picked.push_back(owner);
+                result.push_back(node_ids_[owner]);
+            }
+            if (++i == tokens_.size()) i = 0;
+        }
+
+        return result;
+    }
 
-        auto start = it;
+    std::span<const uint32_t>
+    ConsistentHashRing::preference_slots(const std::string& key, size_t num_replicas) const {
+        if (tokens_.empty()) return {};
+        const size_t i = successor(token(key));
+        return {preferences_.data() + i * width_, std::min(num_replicas, width_)};
+    }
 
-        do {
-            const std::string& node = it->second;
+    size_t ConsistentHashRing::size() const {
+        return tokens_.size();
+    }
 
-            if (seen.insert(node).second) {
-                result.push_back(node);
-                if (result.size() == num_replicas) {
-                    break;
+    std::vector<TokenRange>
+    ConsistentHashRing::ranges_for(const std::string& node_id, size_t num_replicas) const {
+        std::vector<TokenRange> ranges;
+        if (tokens_.empty() || num_replicas == 0) return ranges;
+
+        // Walk each token's owners once, as get_preference_list() would.
+        const size_t wanted = std::min(num_replicas, node_ids_.size());
+        std::vector<uint32_t> picked;
+        picked.reserve(wanted);
+        for (size_t t = 0; t < tokens_.size(); ++t) {
+            picked.clear();
+            if (wanted <= width_) {
+                const uint32_t* row = preferences_.data() + t * width_;
+                picked.assign(row, row + wanted);
+            } else {
+                size_t i = t;
+                for (size_t steps = 0; steps < tokens_.size() && picked.size() < wanted; ++steps) {
+                    if (std::find(picked.begin(), picked.end(), owners_[i]) == picked.end()) {
+                        picked.push_back(owners_[i]);
+                    }
+                    if (++i == tokens_.size()) i = 0;
                 }
             }
+            bool replica = false;
+            for (uint32_t slot : picked) {
+                replica = replica || node_ids_[slot] == node_id;
+            }
+            if (!replica) continue;
 
-            ++it;
-            if (it == ring_.end()) it = ring_.begin();
-
-        } while (it != start && seen.size() < ring_.size());
+            TokenRange range;
+            range.start = tokens_[t == 0 ? tokens_.size() - 1 : t - 1];
+            range.end = tokens_[t];
+            for (uint32_t slot : picked) {
+                range.replicas.push_back(node_ids_[slot]);
+            }
+            ranges.push_back(std::move(range));
+        }
+        return ranges;
+    }
 
-        return result;
+    uint64_t ConsistentHashRing::token(const std::string& key) {
+        return kv::hash::murmur3_64(key, DEFAULT_SEED);
     }
 
-    size_t ConsistentHashRing::size() const {
-        return ring_.size();
+    size_t ConsistentHashRing::successor(uint64_t h) const {
+        // Branchless lower_bound: the answer stays within [first, first + len].
+        const uint64_t* first = tokens_.data();
+        size_t len = tokens_.size();
+        while (len > 1) {
+            const size_t half = len / 2;
+            first += (first[half - 1] < h) ? half : 0;
+            len -= half;
+        }
+        const size_t index = static_cast<size_t>(first - tokens_.data()) + (*first < h ? 1 : 0);
+        return index == tokens_.size() ? 0 : index;
     }
 
-    uint64_t ConsistentHashRing::hash(const std::string& key) const {
-        return kv::hash::murmur3_64(key, DEFAULT_SEED);
+    void ConsistentHashRing::rebuild_preferences() {
+        // Count owners still on the ring (a node can lose tokens to
+        // collisions) so every row fills with distinct nodes.
+        std::vector<bool> present(node_ids_.size(), false);
+        size_t distinct = 0;
+        for (uint32_t owner : owners_) {
+            if (!present[owner]) {
+                present[owner] = true;
+                ++distinct;
+            }
+        }
+        width_ = std::min(replicas_, distinct);
+        preferences_.assign(tokens_.size() * width_, 0);
+        if (width_ == 0) return;
+
+        // Few replicas: a linear scan of the picked slots beats a hash set.
+        for (size_t t = 0; t < tokens_.size(); ++t) {
+            uint32_t* row = preferences_.data() + t * width_;
+            size_t picked = 0;
+            size_t i = t;
+            while (picked < width_) {
+                const uint32_t owner = owners_[i];
+                if (std::find(row, row + picked, owner) == row + picked) {
+                    row[picked++] = owner;
+                }
+                if (++i == tokens_.size()) i = 0;
+            }
+        }
     }
-} 
\ No newline at end of file
+} 
@@ -2,18 +2,38 @@
 #include <cstdint>
 #include <string>
 #include <vector>
-#include <map>
 #include <cstddef>
+#include <span>
 
 /* 
 - This module is internally not thread-safe, requires external synchronization if used from multiple threads.
 - Called by ClusterView, which itself is thread-safe, so this isn't a real concern for current usage.
+- The ring is a flat sorted token array with a parallel array of small owner
+  slots into node_ids_, rebuilt on membership change. Lookups are a branchless
+  binary search over contiguous memory instead of a std::map tree walk, and
+  each vnode costs 12 bytes instead of a map node plus a copy of the node id.
+- The first `replicas` distinct owners clockwise of every token are also
+  precomputed at rebuild, so a preference list of up to that many nodes is one
+  binary search and a span into the table, with no walk and no allocation.
+- A key's token is its murmur3 hash; the vnode token t_i owns the keys with
+  tokens in (t_{i-1}, t_i], wrapping around past the largest token.
 */
 namespace kv::ring {
 
+    // Keys with tokens in (start, end], wrapping past 2^64 - 1 when
+    // end <= start; start == end is the whole ring. `replicas` is the
+    // range's preference list.
+    struct TokenRange {
+        uint64_t start;
+        uint64_t end;
+        std::vector<std::string> replicas;
+
+        bool operator==(const TokenRange&) const = default;
+    };
+
     class ConsistentHashRing {
     public:
-        explicit ConsistentHashRing(size_t vnodes = 100);
+        explicit ConsistentHashRing(size_t vnodes = 100, size_t replicas = 3);
 
         // API for handling adding/removing/accessing nodes
         void add_node(const std::string& node_id);
@@ -22,11 +42,34 @@ namespace kv::ring {
 
         std::vector<std::string> get_preference_list(const std::string& key, size_t num_replicas) const;
 
+        // Owner slots of the first min(num_replicas, precomputed_replicas())
+        // distinct nodes for `key`; resolve them with node_id(). Valid until
+        // the next membership change. Empty if the ring is empty.
+        std::span<const uint32_t> preference_slots(const std::string& key, size_t num_replicas) const;
+        const std::string& node_id(uint32_t slot) const { return node_ids_[slot]; }
+        // Width of the precomputed table: min(replicas, nodes on the ring).
+        size_t precomputed_replicas() const { return width_; }
+
+        // The ranges whose first `num_replicas` owners include `node_id`,
+        // ordered by end token.
+        std::vector<TokenRange> ranges_for(const std::string& node_id, size_t num_replicas) const;
+
+        static uint64_t token(const std::string& key);
+
        size_t size() const;
 
     private:
         size_t vnodes_;
-        std::map<uint64_t, std::string> ring_;
-        uint64_t hash(const std::string& key) const;
+        std::vector<uint64_t> tokens_;       // sorted vnode hashes
+        std::vector<uint32_t> owners_;       // owners_[i] owns tokens_[i]; index into node_ids_
+        std::vector<std::string> node_ids_;
+        size_t replicas_;
+        size_t width_ = 0;
+        // width_ owner slots per token: the preference list for keys hashing
+        // into (tokens_[i-1], tokens_[i]] starts at preferences_[i * width_].
+        std::vector<uint32_t> preferences_;
+        // Index of the first token >= h, wrapping to 0 past the last one.
+        size_t successor(uint64_t h) const;
+        void rebuild_preferences();
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "hash/murmur3.h"
+
+namespace kv::storage {
+
+// Fixed-size bloom filter over 64-bit key hashes, using double hashing to
+// derive the probe positions. ~10 bits per key gives about a 1% false
+// positive rate with 7 probes.
+class BloomFilter {
+public:
+    static constexpr size_t BITS_PER_KEY = 10;
+    static constexpr uint32_t PROBES = 7;
+
+    static uint64_t hash(std::string_view key) {
+        return kv::hash::murmur3_64(key, 0xb10f11e7);
+    }
+
+    // Builds an empty filter sized for `keys` entries.
+    explicit BloomFilter(size_t keys)
+        : bits_((std::max<size_t>(keys * BITS_PER_KEY, 64) + 7) / 8, '\0') {}
+
+    // Wraps bits previously produced by data().
+    static BloomFilter from_bytes(std::string bits) {
+        BloomFilter filter(0);
+        filter.bits_ = std::move(bits);
+        return filter;
+    }
+
+    void add(uint64_t h) {
+        const uint64_t n = bit_count();
+        uint64_t delta = (h >> 32) | 1;
+        for (uint32_t i = 0; i < PROBES; ++i, h += delta) {
+            bits_[(h % n) / 8] = static_cast<char>(bits_[(h % n) / 8] | (1 << ((h % n) % 8)));
+        }
+    }
+
+    bool may_contain(uint64_t h) const {
+        const uint64_t n = bit_count();
+        if (n == 0) {
+            return true;
+        }
+        uint64_t delta = (h >> 32) | 1;
+        for (uint32_t i = 0; i < PROBES; ++i, h += delta) {
+            if ((bits_[(h % n) / 8] & (1 << ((h % n) % 8))) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const std::string& data() const { return bits_; }
+
+private:
+    uint64_t bit_count() const { return static_cast<uint64_t>(bits_.size()) * 8; }
+
+    std::string bits_;
+};
+
+}
@@ -0,0 +1,162 @@
+#include "storage/epoch.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace kv::storage::epoch {
+
+namespace {
+
+// Retire lists are scanned every this many retire() calls on a thread.
+constexpr size_t RECLAIM_INTERVAL = 64;
+
+struct Retired {
+    void* ptr;
+    void (*deleter)(void*);
+    uint64_t epoch;
+};
+
+// One record per thread that has ever pinned. Records are never freed; a
+// record released by an exiting thread is reused by the next new thread.
+struct Participant {
+    // (epoch << 1) | 1 while pinned, 0 while not pinned.
+    std::atomic<uint64_t> state{0};
+    std::atomic<bool> in_use{false};
+    Participant* next = nullptr;
+};
+
+std::atomic<uint64_t> g_epoch{1};
+std::atomic<Participant*> g_participants{nullptr};
+
+// Objects left behind by exited threads, freed by later reclaim() calls.
+std::mutex g_orphans_mu;
+std::vector<Retired> g_orphans;
+
+Participant* acquire_participant() {
+    for (Participant* p = g_participants.load(std::memory_order_acquire); p; p = p->next) {
+        bool expected = false;
+        if (!p->in_use.load(std::memory_order_relaxed) &&
+            p->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return p;
+        }
+    }
+    auto* p = new Participant();
+    p->in_use.store(true, std::memory_order_relaxed);
+    Participant* head = g_participants.load(std::memory_order_relaxed);
+    do {
+        p->next = head;
+    } while (!g_participants.compare_exchange_weak(
+        head, p, std::memory_order_release, std::memory_order_relaxed));
+    return p;
+}
+
+struct ThreadState {
+    Participant* participant = nullptr;
+    size_t depth = 0;
+    size_t retires_since_reclaim = 0;
+    std::vector<Retired> retired;
+
+    Participant* self() {
+        if (!participant) {
+            participant = acquire_participant();
+        }
+        return participant;
+    }
+
+    ~ThreadState() {
+        if (!retired.empty()) {
+            std::lock_guard<std::mutex> lock(g_orphans_mu);
+            for (auto& r : retired) {
+                g_orphans.push_back(r);
+            }
+        }
+        if (participant) {
+            participant->state.store(0, std::memory_order_release);
+            participant->in_use.store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadState t_state;
+
+// Advances the global epoch if every pinned thread has observed it.
+uint64_t try_advance() {
+    // Pairs with the fence in Guard(): either this scan sees a reader's pin,
+    // or that reader's protected loads see every unlink that happened before
+    // this point.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t current = g_epoch.load(std::memory_order_seq_cst);
+    for (Participant* p = g_participants.load(std::memory_order_acquire); p; p = p->next) {
+        uint64_t state = p->state.load(std::memory_order_seq_cst);
+        if ((state & 1) && (state >> 1) != current) {
+            return current;
+        }
+    }
+    g_epoch.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+    return g_epoch.load(std::memory_order_seq_cst);
+}
+
+// Frees entries retired at least two epochs before `epoch`; keeps the rest.
+size_t free_reclaimable(std::vector<Retired>& list, uint64_t epoch) {
+    size_t freed = 0;
+    size_t kept = 0;
+    for (auto& r : list) {
+        if (r.epoch + 2 <= epoch) {
+            r.deleter(r.ptr);
+            freed++;
+        } else {
+            list[kept++] = r;
+        }
+    }
+    list.resize(kept);
+    return freed;
+}
+
+}
+
+Guard::Guard() {
+    ThreadState& ts = t_state;
+    if (ts.depth++ == 0) {
+        uint64_t e = g_epoch.load(std::memory_order_seq_cst);
+        ts.self()->state.store((e << 1) | 1, std::memory_order_relaxed);
+        // Publish the pin before any protected load in this critical section.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+Guard::~Guard() {
+    ThreadState& ts = t_state;
+    if (--ts.depth == 0) {
+        ts.participant->state.store(0, std::memory_order_release);
+    }
+}
+
+void retire(void* ptr, void (*deleter)(void*)) {
+    ThreadState& ts = t_state;
+    // Orders the caller's unlink before the epoch read: any reader pinned in
+    // a later epoch is guaranteed to no longer see ptr.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    ts.retired.push_back(Retired{ptr, deleter, g_epoch.load(std::memory_order_seq_cst)});
+    if (++ts.retires_since_reclaim >= RECLAIM_INTERVAL) {
+        reclaim();
+    }
+}
+
+size_t reclaim() {
+    ThreadState& ts = t_state;
+    ts.retires_since_reclaim = 0;
+
+    uint64_t epoch = try_advance();
+    size_t freed = free_reclaimable(ts.retired, epoch);
+
+    std::unique_lock<std::mutex> lock(g_orphans_mu, std::try_to_lock);
+    if (lock.owns_lock() && !g_orphans.empty()) {
+        freed += free_reclaimable(g_orphans, epoch);
+    }
+    return freed;
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+- Process-wide epoch-based reclamation (EBR) for lock-free readers.
+- Readers hold an epoch::Guard while dereferencing shared pointers; writers
+  unlink an object and hand it to retire() instead of deleting it. A retired
+  object is freed only once every guard that could have observed it has been
+  released (two epoch advances later).
+- Guards are cheap (two thread-local stores and a fence) and may nest.
+*/
+namespace kv::storage::epoch {
+
+class Guard {
+public:
+    Guard();
+    ~Guard();
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+};
+
+// Defers deleter(ptr) until no guard can still reference ptr. Call only after
+// ptr has been unlinked, so no new reader can reach it.
+void retire(void* ptr, void (*deleter)(void*));
+
+template <typename T>
+void retire(T* ptr) {
+    retire(const_cast<void*>(static_cast<const void*>(ptr)),
+           [](void* p) { delete static_cast<T*>(p); });
+}
+
+// Tries to advance the global epoch and frees whatever the calling thread has
+// retired that is now unreachable. Returns the number of objects freed.
+// retire() calls this periodically; exposed for tests and shutdown paths.
+size_t reclaim();
+
+}
@@ -0,0 +1,18 @@
+#include "storage/file_util.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace kv::storage {
+
+bool sync_dir(const std::filesystem::path& dir) {
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+}
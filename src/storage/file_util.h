@@ -0,0 +1,14 @@
+#pragma once
+
+#include <filesystem>
+
+/*
+- Filesystem helpers shared by the storage engines' on-disk formats.
+*/
+namespace kv::storage {
+
+// fsyncs a directory so file creations, renames and removals in it survive
+// a crash. False if the directory cannot be opened or synced.
+bool sync_dir(const std::filesystem::path& dir);
+
+}
@@ -0,0 +1,516 @@
+#include "storage/lsm_engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+#include "storage/file_util.h"
+#include "utils/logging.h"
+
+namespace kv::storage {
+
+namespace fs = std::filesystem;
+
+namespace {
+// Rough per-entry cost of a std::map node beyond the key and value bytes.
+constexpr size_t ENTRY_OVERHEAD = 64;
+
+long long elapsed_ms(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - since).count();
+}
+}
+
+LsmEngine::LsmEngine(const StorageEngineOptions& options)
+    : options_(options),
+      mem_(std::make_shared<Memtable>()),
+      tables_(std::make_shared<const TableList>()) {
+    if (options_.data_dir.empty()) {
+        throw std::invalid_argument("lsm storage engine requires a data_dir");
+    }
+    recover();
+    background_ = std::thread([this] { background_loop(); });
+    // A long WAL tail may have replayed into an oversized memtable.
+    switch_memtable(false);
+}
+
+LsmEngine::~LsmEngine() {
+    {
+        std::lock_guard<std::mutex> lock(flush_mu_);
+        stopping_ = true;
+    }
+    flush_cv_.notify_all();
+    background_.join();
+}
+
+std::string LsmEngine::table_path(uint64_t id) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "sst-%016" PRIu64 ".sst", id);
+    return (fs::path(options_.data_dir) / name).string();
+}
+
+void LsmEngine::recover() {
+    auto started = std::chrono::steady_clock::now();
+    fs::create_directories(options_.data_dir);
+
+    std::vector<std::pair<uint64_t, fs::path>> found;
+    for (const auto& file : fs::directory_iterator(options_.data_dir)) {
+        if (file.path().extension() == ".tmp") {
+            // Half-written flush or compaction output.
+            std::error_code ec;
+            fs::remove(file.path(), ec);
+            continue;
+        }
+        uint64_t id = 0;
+        if (std::sscanf(file.path().filename().c_str(), "sst-%" SCNu64 ".sst", &id) == 1 &&
+            file.path().extension() == ".sst") {
+            found.emplace_back(id, file.path());
+        }
+    }
+    std::sort(found.begin(), found.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    auto list = std::make_shared<TableList>();
+    uint64_t table_records = 0;
+    for (const auto& [id, path] : found) {
+        list->push_back(SSTable::open(path.string(), id));
+        table_records += list->back()->records();
+        next_table_id_ = std::max(next_table_id_, id + 1);
+    }
+    tables_ = std::move(list);
+
+    WriteAheadLog::Options wal_options;
+    wal_options.dir = options_.data_dir;
+    wal_options.sync_mode = options_.wal_sync_mode;
+    wal_options.sync_interval = options_.wal_sync_interval;
+
+    // Segments that were flushed but not yet deleted before a crash replay
+    // again; the LWW check makes that harmless.
+    wal_ = std::make_unique<WriteAheadLog>(
+        wal_options,
+        [this](const std::string& key, ValueRef value, const Version& version) {
+            auto current = get(key);
+            if (!current || is_newer(version, current->version)) {
+                insert(*mem_, key, std::move(value), version);
+            }
+        });
+
+    LOG_INFO(options_.log_prefix << "recovered lsm store from " << options_.data_dir
+             << " in " << elapsed_ms(started) << " ms (" << found.size() << " tables, "
+             << table_records << " records; WAL tail: " << wal_->replayed_records()
+             << " records; sync=" << to_string(wal_options.sync_mode) << ")");
+}
+
+std::shared_ptr<const LsmEngine::TableList> LsmEngine::tables() const {
+    std::lock_guard<std::mutex> lock(tables_mu_);
+    return tables_;
+}
+
+size_t LsmEngine::table_count() const {
+    return tables()->size();
+}
+
+std::optional<StoreEntry> LsmEngine::get(const std::string& key) const {
+    {
+        std::shared_lock<std::shared_mutex> lock(mem_mu_);
+        if (auto it = mem_->entries.find(key); it != mem_->entries.end()) {
+            return it->second;
+        }
+        if (imm_) {
+            if (auto it = imm_->entries.find(key); it != imm_->entries.end()) {
+                return it->second;
+            }
+        }
+    }
+    // A flush publishes its table before dropping imm_, so a key leaving the
+    // memtables is already visible here.
+    auto list = tables();
+    for (const auto& table : *list) {
+        if (auto entry = table->get(key)) {
+            return entry;
+        }
+    }
+    return std::nullopt;
+}
+
+LsmEngine::InsertResult LsmEngine::insert(Memtable& table,
+                                          const std::string& key,
+                                          ValueRef value,
+                                          const Version& version) {
+    std::unique_lock<std::shared_mutex> lock(mem_mu_);
+    auto it = table.entries.find(key);
+    if (it == table.entries.end()) {
+        table.bytes += key.size() + value.size() + ENTRY_OVERHEAD;
+        table.entries.emplace(key, StoreEntry{std::move(value), version});
+    } else if (is_newer(version, it->second.version)) {
+        table.bytes = table.bytes - it->second.value.size() + value.size();
+        it->second = StoreEntry{std::move(value), version};
+    } else {
+        return InsertResult{false, table.bytes >= options_.lsm_memtable_bytes};
+    }
+    return InsertResult{true, table.bytes >= options_.lsm_memtable_bytes};
+}
+
+PutResult LsmEngine::put_if_newer(const std::string& key,
+                                  ValueRef value,
+                                  const Version& version) {
+    // A write is logged before it becomes visible, and only if it would win
+    // LWW. The key lock covers the check and the enqueue only; the fsync is
+    // waited for outside it, so writers to one key stripe share a group
+    // commit.
+    std::unique_lock<std::mutex> key_lock(key_locks_[BloomFilter::hash(key) % KEY_LOCKS]);
+    std::optional<Version> previous;
+    std::shared_ptr<Memtable> target;
+    uint64_t seq = 0;
+    while (true) {
+        const uint64_t switches = switches_.load();
+        auto current = get(key);
+        if (current && !is_newer(version, current->version)) {
+            return PutResult{false, current->version};
+        }
+        previous = current ? std::optional<Version>(current->version) : std::nullopt;
+
+        std::lock_guard<std::mutex> append_lock(append_mu_);
+        if (switches_.load() != switches) {
+            // The switch drained writes the check above may have missed.
+            continue;
+        }
+        // A failed log refuses the write before anything becomes visible.
+        seq = wal_->enqueue(key, value.view(), version);
+        if (seq == 0) {
+            PutResult failed{false, previous};
+            failed.io_error = true;
+            return failed;
+        }
+        // The record lands in the segment current now, so it must go into
+        // the memtable current now; switch_memtable() waits for it.
+        target = mem_;
+        unapplied_.fetch_add(1);
+        break;
+    }
+    key_lock.unlock();
+
+    PutResult result{false, previous};
+    InsertResult inserted{false, false};
+    if (wal_->wait(seq)) {
+        // insert() re-checks LWW against writes applied while we waited.
+        inserted = insert(*target, key, std::move(value), version);
+        result.overwritten = inserted.applied;
+    } else {
+        result.io_error = true;
+    }
+    if (unapplied_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(drain_mu_);
+        drain_cv_.notify_all();
+    }
+    if (inserted.full) {
+        switch_memtable(false);
+    }
+    return result;
+}
+
+void LsmEngine::for_each(
+    const std::function<void(const std::string&, const StoreEntry&)>& fn) const {
+    std::vector<std::pair<std::string, StoreEntry>> mem;
+    std::shared_ptr<const Memtable> imm;
+    {
+        std::shared_lock<std::shared_mutex> lock(mem_mu_);
+        mem.assign(mem_->entries.begin(), mem_->entries.end());
+        imm = imm_;
+    }
+    // Taken after imm_: a flush publishes its table before dropping imm_.
+    auto list = tables();
+
+    auto mem_it = mem.cbegin();
+    decltype(Memtable::entries)::const_iterator imm_it;
+    if (imm) {
+        imm_it = imm->entries.cbegin();
+    }
+    std::vector<std::unique_ptr<SSTable::Cursor>> cursors;
+    for (const auto& table : *list) {
+        cursors.push_back(std::make_unique<SSTable::Cursor>(*table));
+    }
+
+    std::string key;
+    while (true) {
+        const std::string* smallest = nullptr;
+        auto consider = [&smallest](const std::string& k) {
+            if (!smallest || k < *smallest) {
+                smallest = &k;
+            }
+        };
+        if (mem_it != mem.cend()) {
+            consider(mem_it->first);
+        }
+        if (imm && imm_it != imm->entries.cend()) {
+            consider(imm_it->first);
+        }
+        for (const auto& cursor : cursors) {
+            if (cursor->valid()) {
+                consider(cursor->key());
+            }
+        }
+        if (!smallest) {
+            break;
+        }
+        key = *smallest;
+
+        std::optional<StoreEntry> winner;
+        auto offer = [&winner](const StoreEntry& entry) {
+            if (!winner || is_newer(entry.version, winner->version)) {
+                winner = entry;
+            }
+        };
+        if (mem_it != mem.cend() && mem_it->first == key) {
+            offer((mem_it++)->second);
+        }
+        if (imm && imm_it != imm->entries.cend() && imm_it->first == key) {
+            offer((imm_it++)->second);
+        }
+        for (const auto& cursor : cursors) {
+            if (cursor->valid() && cursor->key() == key) {
+                offer(cursor->entry());
+                cursor->next();
+            }
+        }
+        fn(key, *winner);
+    }
+}
+
+size_t LsmEngine::size() const {
+    size_t total = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mem_mu_);
+        total += mem_->entries.size();
+        if (imm_) {
+            total += imm_->entries.size();
+        }
+    }
+    for (const auto& table : *tables()) {
+        total += table->records();
+    }
+    return total;
+}
+
+bool LsmEngine::switch_memtable(bool force) {
+    std::unique_lock<std::mutex> lock(flush_mu_);
+    // One immutable memtable at a time: writers stall here while the
+    // previous one is still being flushed.
+    flush_cv_.wait(lock, [this] { return !imm_pending_ || stopping_; });
+    if (stopping_) {
+        return false;
+    }
+    {
+        std::shared_lock<std::shared_mutex> mem_lock(mem_mu_);
+        if (mem_->entries.empty() ||
+            (!force && mem_->bytes < options_.lsm_memtable_bytes)) {
+            return true;  // nothing to do, or another writer already switched
+        }
+    }
+
+    uint64_t segment = 0;
+    {
+        // Holding append_mu_ keeps new writes out of the segment being
+        // retired. Writes already logged there are waited for so they land
+        // in the memtable being retired before it is swapped out.
+        std::lock_guard<std::mutex> append_lock(append_mu_);
+        segment = wal_->rotate();
+        if (segment == 0) {
+            LOG_INFO(options_.log_prefix << "memtable switch failed: cannot rotate WAL");
+            return false;
+        }
+        {
+            std::unique_lock<std::mutex> drain_lock(drain_mu_);
+            drain_cv_.wait(drain_lock, [this] { return unapplied_.load() == 0; });
+        }
+        std::unique_lock<std::shared_mutex> mem_lock(mem_mu_);
+        imm_ = std::move(mem_);
+        mem_ = std::make_shared<Memtable>();
+        switches_.fetch_add(1);
+    }
+    imm_segment_ = segment;
+    imm_pending_ = true;
+    flush_failed_ = false;
+    flush_cv_.notify_all();
+    return true;
+}
+
+void LsmEngine::background_loop() {
+    std::unique_lock<std::mutex> lock(flush_mu_);
+    while (true) {
+        flush_cv_.wait(lock, [this] { return imm_pending_ || stopping_; });
+        if (stopping_) {
+            return;
+        }
+        uint64_t segment = imm_segment_;
+        lock.unlock();
+
+        std::shared_ptr<const Memtable> imm;
+        {
+            std::shared_lock<std::shared_mutex> mem_lock(mem_mu_);
+            imm = imm_;
+        }
+        bool ok = flush(imm, segment);
+
+        lock.lock();
+        if (!ok) {
+            flush_failed_ = true;
+            flush_cv_.notify_all();
+            flush_cv_.wait_for(lock, std::chrono::seconds(1), [this] { return stopping_; });
+            continue;
+        }
+        imm_pending_ = false;
+        flush_cv_.notify_all();
+
+        if (table_count() >= options_.lsm_compaction_trigger) {
+            lock.unlock();
+            compact();
+            lock.lock();
+        }
+    }
+}
+
+bool LsmEngine::flush(const std::shared_ptr<const Memtable>& imm, uint64_t wal_segment) {
+    auto started = std::chrono::steady_clock::now();
+    uint64_t id = next_table_id_++;
+    const std::string path = table_path(id);
+    try {
+        SSTableBuilder builder(path, imm->entries.size());
+        for (const auto& [key, entry] : imm->entries) {
+            builder.add(key, entry);
+        }
+        builder.finish();
+        sync_dir(options_.data_dir);
+
+        auto table = SSTable::open(path, id);
+        std::lock_guard<std::mutex> lock(tables_mu_);
+        auto list = std::make_shared<TableList>();
+        list->push_back(std::move(table));
+        list->insert(list->end(), tables_->begin(), tables_->end());
+        tables_ = std::move(list);
+    } catch (const std::exception& e) {
+        LOG_INFO(options_.log_prefix << "memtable flush failed: " << e.what());
+        return false;
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> mem_lock(mem_mu_);
+        imm_.reset();
+    }
+    wal_->remove_segments_before(wal_segment);
+
+    LOG_INFO(options_.log_prefix << "flushed " << imm->entries.size() << " records to "
+             << path << " in " << elapsed_ms(started) << " ms");
+    return true;
+}
+
+void LsmEngine::compact() {
+    auto started = std::chrono::steady_clock::now();
+    auto list = tables();
+
+    // Size-tiered: starting from the newest table, take each older one that
+    // is no bigger than the run taken so far, and merge once the run holds
+    // lsm_compaction_trigger tables. A table of n bytes then joins a merge
+    // only when as many newer bytes have piled up in front of it, so data is
+    // rewritten O(log(dataset / memtable)) times rather than on every
+    // compaction. The run must be the newest tables, contiguous in age, for
+    // the output to shadow everything it replaces.
+    size_t run = 0;
+    uint64_t run_bytes = 0;
+    while (run < list->size() && (run == 0 || (*list)[run]->bytes() <= run_bytes)) {
+        run_bytes += (*list)[run]->bytes();
+        run++;
+    }
+    if (run < std::max<size_t>(options_.lsm_compaction_trigger, 2)) {
+        return;
+    }
+    const TableList inputs(list->begin(), list->begin() + static_cast<std::ptrdiff_t>(run));
+
+    // The output takes over the newest input's id so that, if we crash before
+    // the other inputs are deleted, it still shadows them; older tables keep
+    // lower ids.
+    const uint64_t id = inputs.front()->id();
+    const std::string path = table_path(id);
+
+    size_t expected = 0;
+    for (const auto& table : inputs) {
+        expected += table->records();
+    }
+
+    // A corrupt input block aborts the merge before finish(), so the output
+    // never replaces the newest input and every input is kept.
+    uint64_t written = 0;
+    try {
+        std::vector<std::unique_ptr<SSTable::Cursor>> cursors;
+        for (const auto& table : inputs) {
+            cursors.push_back(std::make_unique<SSTable::Cursor>(*table));
+        }
+        SSTableBuilder builder(path, expected);
+        std::string key;
+        while (true) {
+            // Few inputs, so a linear scan for the smallest key is enough.
+            const std::string* smallest = nullptr;
+            for (const auto& cursor : cursors) {
+                if (cursor->valid() && (!smallest || cursor->key() < *smallest)) {
+                    smallest = &cursor->key();
+                }
+            }
+            if (!smallest) {
+                break;
+            }
+            key = *smallest;
+
+            std::optional<StoreEntry> winner;
+            for (const auto& cursor : cursors) {
+                if (cursor->valid() && cursor->key() == key) {
+                    if (!winner || is_newer(cursor->entry().version, winner->version)) {
+                        winner = cursor->entry();
+                    }
+                    cursor->next();
+                }
+            }
+            builder.add(key, *winner);
+            written++;
+        }
+        builder.finish();
+        sync_dir(options_.data_dir);
+
+        auto table = SSTable::open(path, id);
+        auto merged = std::make_shared<TableList>(TableList{std::move(table)});
+        merged->insert(merged->end(), list->begin() + static_cast<std::ptrdiff_t>(run),
+                       list->end());
+        std::lock_guard<std::mutex> lock(tables_mu_);
+        // Only this thread adds tables, so tables_ still equals `list`.
+        tables_ = std::move(merged);
+    } catch (const std::exception& e) {
+        LOG_INFO(options_.log_prefix << "compaction failed: " << e.what());
+        return;
+    }
+
+    // Readers holding the old list keep the unlinked files open until done.
+    for (const auto& table : inputs) {
+        if (table->id() != id) {
+            std::error_code ec;
+            fs::remove(table->path(), ec);
+        }
+    }
+    LOG_INFO(options_.log_prefix << "compacted " << inputs.size() << " of " << list->size()
+             << " tables into " << path << " (" << written << " records) in "
+             << elapsed_ms(started) << " ms");
+}
+
+bool LsmEngine::checkpoint() {
+    std::lock_guard<std::mutex> lock(checkpoint_mu_);
+    if (!switch_memtable(true)) {
+        return false;
+    }
+    std::unique_lock<std::mutex> flush_lock(flush_mu_);
+    flush_cv_.wait(flush_lock, [this] { return !imm_pending_ || flush_failed_ || stopping_; });
+    return !imm_pending_;
+}
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "storage/sstable.h"
+#include "storage/storage_engine.h"
+#include "storage/wal.h"
+
+/*
+- Log-structured merge tree for datasets that do not fit in memory.
+- Writes go to the WAL and then a sorted memtable. Once the memtable reaches
+  lsm_memtable_bytes it becomes immutable, the WAL rotates, and a background
+  thread writes it out as an SSTable (sst-<id>.sst, higher id = newer) and
+  drops the WAL segments it covered.
+- Reads check the memtable, the immutable memtable, then the tables newest
+  first; the first hit is the newest version because puts are only applied
+  when they win LWW against what is already visible.
+- Compaction is size-tiered: the background thread merges the newest run
+  of tables once it holds lsm_compaction_trigger tables, each no bigger
+  than the newer tables before it, so a record is rewritten about
+  log(dataset / memtable) times.
+*/
+namespace kv::storage {
+
+class LsmEngine final : public StorageEngine {
+public:
+    // Opens the tables in options.data_dir and replays the WAL into the
+    // memtable. Throws std::runtime_error on I/O failure.
+    explicit LsmEngine(const StorageEngineOptions& options);
+
+    // Stops the background thread; an unflushed memtable stays in the WAL.
+    ~LsmEngine() override;
+
+    std::optional<StoreEntry> get(const std::string& key) const override;
+    PutResult put_if_newer(const std::string& key,
+                           ValueRef value,
+                           const Version& version) override;
+    // Merges the memtables and tables like a compaction. The memtable is
+    // copied first, so writers wait only for that copy.
+    void for_each(
+        const std::function<void(const std::string&, const StoreEntry&)>& fn) const override;
+    size_t size() const override;
+
+    // Flushes the memtable to a table and waits for it to land.
+    bool checkpoint() override;
+
+    StorageEngineKind kind() const override { return StorageEngineKind::Lsm; }
+
+    size_t table_count() const;
+
+private:
+    struct Memtable {
+        std::map<std::string, StoreEntry, std::less<>> entries;
+        size_t bytes = 0;
+    };
+    using TableList = std::vector<std::shared_ptr<SSTable>>;  // newest first
+
+    struct InsertResult {
+        bool applied;  // the entry won LWW within the memtable
+        bool full;     // the memtable has reached its flush threshold
+    };
+
+    static constexpr size_t KEY_LOCKS = 64;
+
+    void recover();
+    InsertResult insert(Memtable& table,
+                        const std::string& key,
+                        ValueRef value,
+                        const Version& version);
+    std::shared_ptr<const TableList> tables() const;
+    bool switch_memtable(bool force);
+    void background_loop();
+    bool flush(const std::shared_ptr<const Memtable>& imm, uint64_t wal_segment);
+    void compact();
+    std::string table_path(uint64_t id) const;
+
+    StorageEngineOptions options_;
+    std::unique_ptr<WriteAheadLog> wal_;
+
+    // Serializes the LWW check and WAL enqueue per key.
+    std::array<std::mutex, KEY_LOCKS> key_locks_;
+
+    // Held to enqueue a write and pick its memtable, and by switch_memtable()
+    // across the WAL rotation and memtable swap.
+    std::mutex append_mu_;
+    std::atomic<uint64_t> switches_{0};   // memtable switches so far
+    std::atomic<size_t> unapplied_{0};    // enqueued writes not yet in a memtable
+    std::mutex drain_mu_;
+    std::condition_variable drain_cv_;    // unapplied_ reached 0
+
+    mutable std::shared_mutex mem_mu_;  // guards mem_, imm_ and their contents
+    std::shared_ptr<Memtable> mem_;
+    std::shared_ptr<const Memtable> imm_;
+
+    mutable std::mutex tables_mu_;
+    std::shared_ptr<const TableList> tables_;
+    uint64_t next_table_id_ = 1;  // background thread only after recovery
+
+    std::mutex checkpoint_mu_;
+    std::mutex flush_mu_;
+    std::condition_variable flush_cv_;  // imm_ handed off, flushed, or stopping
+    bool imm_pending_ = false;
+    uint64_t imm_segment_ = 0;          // WAL segments below this are in imm_
+    bool flush_failed_ = false;
+    bool stopping_ = false;
+    std::thread background_;
+};
+
+}
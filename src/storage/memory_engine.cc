@@ -0,0 +1,203 @@
+#include "storage/memory_engine.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "storage/snapshot.h"
+#include "utils/logging.h"
+
+namespace kv::storage {
+
+namespace fs = std::filesystem;
+
+namespace {
+long long elapsed_ms(std::chrono::steady_clock::time_point since,
+                     std::chrono::steady_clock::time_point until) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(until - since).count();
+}
+}
+
+MemoryEngine::MemoryEngine(const StorageEngineOptions& options)
+    : options_(options),
+      store_(options.memory_shards),
+      write_locks_(new std::mutex[store_.shard_count()]) {
+    if (!options_.data_dir.empty()) {
+        recover();
+    }
+}
+
+void MemoryEngine::recover() {
+    auto started = std::chrono::steady_clock::now();
+    fs::create_directories(options_.data_dir);
+
+    // Newest snapshot wins; its name carries the first WAL segment it does
+    // not cover.
+    std::optional<fs::path> snapshot_path;
+    uint64_t snapshot_segment = 0;
+    for (const auto& file : fs::directory_iterator(options_.data_dir)) {
+        uint64_t segment = 0;
+        if (std::sscanf(file.path().filename().c_str(), "snapshot-%" SCNu64 ".bin",
+                        &segment) == 1 &&
+            file.path().extension() == ".bin" && segment >= snapshot_segment) {
+            snapshot_path = file.path();
+            snapshot_segment = segment;
+        }
+    }
+
+    SnapshotInfo snapshot;
+    if (snapshot_path) {
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        auto loaded = load_snapshot(snapshot_path->string(), store_, threads);
+        if (!loaded) {
+            // The WAL segments it covers are gone, so starting without it
+            // would drop acknowledged writes.
+            throw std::runtime_error("snapshot " + snapshot_path->string() +
+                                     " is unreadable or corrupt");
+        }
+        snapshot = *loaded;
+    }
+    auto snapshot_done = std::chrono::steady_clock::now();
+
+    WriteAheadLog::Options wal_options;
+    wal_options.dir = options_.data_dir;
+    wal_options.sync_mode = options_.wal_sync_mode;
+    wal_options.sync_interval = options_.wal_sync_interval;
+    wal_options.first_segment = snapshot.wal_segment;
+
+    wal_ = std::make_unique<WriteAheadLog>(
+        wal_options,
+        [this](const std::string& key, ValueRef value, const Version& version) {
+            store_.put_if_newer(key, std::move(value), version);
+        });
+
+    auto finished = std::chrono::steady_clock::now();
+    LOG_INFO(options_.log_prefix << "recovered " << store_.size()
+             << " keys from " << options_.data_dir << " in "
+             << elapsed_ms(started, finished) << " ms"
+             << " (snapshot: " << snapshot.records << " records, "
+             << elapsed_ms(started, snapshot_done) << " ms; WAL tail: "
+             << wal_->replayed_records() << " records, "
+             << elapsed_ms(snapshot_done, finished)
+             << " ms; sync=" << to_string(wal_options.sync_mode) << ")");
+}
+
+std::optional<StoreEntry> MemoryEngine::get(const std::string& key) const {
+    return store_.get(key);
+}
+
+void MemoryEngine::for_each(
+    const std::function<void(const std::string&, const StoreEntry&)>& fn) const {
+    for (size_t shard = 0; shard < store_.shard_count(); ++shard) {
+        store_.for_each_in_shard(shard, fn);
+    }
+}
+
+PutResult MemoryEngine::put_if_newer(const std::string& key,
+                                     ValueRef value,
+                                     const Version& version) {
+    if (!wal_) {
+        return store_.put_if_newer(key, std::move(value), version);
+    }
+
+    // A write is logged before it becomes visible, and only if it would win
+    // LWW. The shard lock covers the check and the enqueue only; the fsync is
+    // waited for outside it, so writers to one shard share a group commit.
+    uint64_t seq = 0;
+    size_t generation = 0;
+    std::optional<Version> previous;
+    {
+        std::lock_guard<std::mutex> lock(write_locks_[store_.shard_index(key)]);
+        auto current = store_.get(key);
+        if (current && !is_newer(version, current->version)) {
+            return PutResult{false, current->version};
+        }
+        if (current) {
+            previous = current->version;
+        }
+        seq = wal_->enqueue(key, value.view(), version);
+        if (seq == 0) {
+            PutResult failed{false, previous};
+            failed.io_error = true;
+            return failed;
+        }
+        generation = generation_ & 1;
+        pending_[generation].fetch_add(1);
+    }
+
+    PutResult result{false, previous};
+    if (wal_->wait(seq)) {
+        // put_if_newer re-checks LWW against writes applied while we waited.
+        result = store_.put_if_newer(key, std::move(value), version);
+    } else {
+        result.io_error = true;
+    }
+    if (pending_[generation].fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(pending_mu_);
+        pending_cv_.notify_all();
+    }
+    return result;
+}
+
+bool MemoryEngine::checkpoint() {
+    if (!wal_) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(checkpoint_mu_);
+    auto started = std::chrono::steady_clock::now();
+
+    // With every write lock held, each write enqueued so far lands below
+    // `segment` and is counted in the generation ending here. Once those
+    // writes have applied, the snapshot below covers the older segments.
+    uint64_t segment = 0;
+    size_t drained = 0;
+    {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(store_.shard_count());
+        for (size_t shard = 0; shard < store_.shard_count(); ++shard) {
+            locks.emplace_back(write_locks_[shard]);
+        }
+        segment = wal_->rotate();
+        if (segment == 0) {
+            return false;
+        }
+        drained = generation_ & 1;
+        generation_++;
+    }
+    {
+        std::unique_lock<std::mutex> pending_lock(pending_mu_);
+        pending_cv_.wait(pending_lock, [&] { return pending_[drained].load() == 0; });
+    }
+
+    char name[40];
+    std::snprintf(name, sizeof(name), "snapshot-%016" PRIu64 ".bin", segment);
+    fs::path path = fs::path(options_.data_dir) / name;
+
+    SnapshotInfo info;
+    try {
+        info = write_snapshot(path.string(), store_, segment);
+    } catch (const std::exception& e) {
+        LOG_INFO(options_.log_prefix << "snapshot failed: " << e.what());
+        return false;
+    }
+
+    for (const auto& file : fs::directory_iterator(options_.data_dir)) {
+        const auto filename = file.path().filename().string();
+        if (filename.rfind("snapshot-", 0) == 0 && file.path() != path) {
+            std::error_code ec;
+            fs::remove(file.path(), ec);
+        }
+    }
+    wal_->remove_segments_before(segment);
+
+    LOG_INFO(options_.log_prefix << "snapshot " << path.string()
+             << ": " << info.records << " records in "
+             << elapsed_ms(started, std::chrono::steady_clock::now()) << " ms");
+    return true;
+}
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "storage/sharded_store.h"
+#include "storage/storage_engine.h"
+#include "storage/wal.h"
+
+/*
+- The default engine: every key lives in a lock-free-read ShardedStore.
+- With a data_dir, winning writes are appended to a WAL before they become
+  visible, and checkpoint() writes a snapshot; recovery loads the newest
+  snapshot and replays only the WAL segments written after it.
+*/
+namespace kv::storage {
+
+class MemoryEngine final : public StorageEngine {
+public:
+    // Recovers from options.data_dir when set; throws std::runtime_error on
+    // I/O failure.
+    explicit MemoryEngine(const StorageEngineOptions& options);
+
+    std::optional<StoreEntry> get(const std::string& key) const override;
+    PutResult put_if_newer(const std::string& key,
+                           ValueRef value,
+                           const Version& version) override;
+    void for_each(
+        const std::function<void(const std::string&, const StoreEntry&)>& fn) const override;
+    size_t size() const override { return store_.size(); }
+
+    // Writes a point-in-time snapshot and drops the WAL segments it covers.
+    bool checkpoint() override;
+
+    StorageEngineKind kind() const override { return StorageEngineKind::Memory; }
+
+private:
+    void recover();
+
+    StorageEngineOptions options_;
+    ShardedStore store_;
+    std::unique_ptr<WriteAheadLog> wal_;  // null without a data_dir
+    // One per shard; with a WAL, serializes a key's LWW check and enqueue.
+    std::unique_ptr<std::mutex[]> write_locks_;
+    // Writes enqueued but not yet applied, by the parity of the checkpoint
+    // generation they were enqueued in. generation_ changes only with every
+    // write lock held.
+    uint64_t generation_ = 0;
+    std::array<std::atomic<size_t>, 2> pending_{};
+    std::mutex pending_mu_;
+    std::condition_variable pending_cv_;  // a generation's pending_ reached 0
+    std::mutex checkpoint_mu_;
+};
+
+}
@@ -0,0 +1,176 @@
+#include "storage/sharded_store.h"
+
+#include "hash/murmur3.h"
+#include "storage/epoch.h"
+
+namespace kv::storage {
+
+namespace {
+// Distinct from the ring seed so shard choice is independent of ring position.
+constexpr uint64_t SHARD_SEED = 0x5bd1e995;
+
+constexpr size_t INITIAL_BUCKETS = 16;
+
+size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+// The low bits pick the shard, so buckets are indexed from the high half.
+size_t bucket_of(uint64_t hash, size_t mask) {
+    return static_cast<size_t>(hash >> 32) & mask;
+}
+}
+
+ShardedStore::Table::Table(size_t bucket_count)
+    : mask(bucket_count - 1),
+      buckets(std::make_unique<std::atomic<Node*>[]>(bucket_count)) {
+    for (size_t i = 0; i < bucket_count; ++i) {
+        buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+ShardedStore::ShardedStore(size_t shard_count)
+    : mask_(round_up_pow2(shard_count) - 1),
+      shards_(std::make_unique<Shard[]>(mask_ + 1)) {
+    for (size_t i = 0; i <= mask_; ++i) {
+        shards_[i].table.store(new Table(INITIAL_BUCKETS), std::memory_order_release);
+    }
+}
+
+ShardedStore::~ShardedStore() {
+    // No readers or writers remain; entries retired earlier are still owned
+    // by the epoch domain and freed there.
+    for (size_t i = 0; i <= mask_; ++i) {
+        Table* table = shards_[i].table.load(std::memory_order_relaxed);
+        for (size_t b = 0; b <= table->mask; ++b) {
+            Node* node = table->buckets[b].load(std::memory_order_relaxed);
+            while (node) {
+                Node* next = node->next;
+                delete node->entry.load(std::memory_order_relaxed);
+                delete node;
+                node = next;
+            }
+        }
+        delete table;
+    }
+}
+
+size_t ShardedStore::shard_index(std::string_view key) const {
+    return static_cast<size_t>(kv::hash::murmur3_64(key, SHARD_SEED)) & mask_;
+}
+
+ShardedStore::Node* ShardedStore::find(const Table* table,
+                                       const std::string& key,
+                                       uint64_t hash) {
+    Node* node = table->buckets[bucket_of(hash, table->mask)].load(std::memory_order_acquire);
+    while (node && (node->hash != hash || node->key != key)) {
+        node = node->next;
+    }
+    return node;
+}
+
+std::optional<StoreEntry> ShardedStore::get(const std::string& key) const {
+    uint64_t hash = kv::hash::murmur3_64(key, SHARD_SEED);
+    const Shard& shard = shards_[static_cast<size_t>(hash) & mask_];
+
+    epoch::Guard guard;
+    const Table* table = shard.table.load(std::memory_order_acquire);
+    const Node* node = find(table, key, hash);
+    if (!node) {
+        return std::nullopt;
+    }
+    return *node->entry.load(std::memory_order_acquire);
+}
+
+ShardedStore::PutResult ShardedStore::put_if_newer(const std::string& key,
+                                                   ValueRef value,
+                                                   const Version& version) {
+    uint64_t hash = kv::hash::murmur3_64(key, SHARD_SEED);
+    Shard& shard = shards_[static_cast<size_t>(hash) & mask_];
+    std::lock_guard<std::mutex> lock(shard.write_mu);
+
+    // Writers hold write_mu, so the table and entries they see here cannot be
+    // retired underneath them.
+    Table* table = shard.table.load(std::memory_order_relaxed);
+    Node* node = find(table, key, hash);
+
+    if (!node) {
+        auto& head = table->buckets[bucket_of(hash, table->mask)];
+        node = new Node{key, hash, {new StoreEntry{std::move(value), version}},
+                        head.load(std::memory_order_relaxed)};
+        head.store(node, std::memory_order_release);
+        if (shard.count.fetch_add(1, std::memory_order_relaxed) + 1 > table->mask + 1) {
+            grow(shard);
+        }
+        return PutResult{true, std::nullopt};
+    }
+
+    const StoreEntry* current = node->entry.load(std::memory_order_relaxed);
+    Version previous = current->version;
+    if (!kv::node::is_newer(version, previous)) {
+        return PutResult{false, std::move(previous)};
+    }
+    node->entry.store(new StoreEntry{std::move(value), version}, std::memory_order_release);
+    epoch::retire(current);
+    return PutResult{true, std::move(previous)};
+}
+
+void ShardedStore::grow(Shard& shard) {
+    Table* old_table = shard.table.load(std::memory_order_relaxed);
+    auto* table = new Table((old_table->mask + 1) * 2);
+
+    // Readers may still be walking the old chains, so they are copied rather
+    // than relinked. The copies share the entries; the old nodes are retired
+    // with the table but their entries are not.
+    for (size_t b = 0; b <= old_table->mask; ++b) {
+        for (Node* node = old_table->buckets[b].load(std::memory_order_relaxed); node;
+             node = node->next) {
+            auto& head = table->buckets[bucket_of(node->hash, table->mask)];
+            head.store(new Node{node->key, node->hash,
+                                {node->entry.load(std::memory_order_relaxed)},
+                                head.load(std::memory_order_relaxed)},
+                       std::memory_order_relaxed);
+        }
+    }
+    shard.table.store(table, std::memory_order_release);
+
+    epoch::retire(old_table, [](void* p) {
+        auto* retired = static_cast<Table*>(p);
+        for (size_t b = 0; b <= retired->mask; ++b) {
+            Node* node = retired->buckets[b].load(std::memory_order_relaxed);
+            while (node) {
+                Node* next = node->next;
+                delete node;
+                node = next;
+            }
+        }
+        delete retired;
+    });
+}
+
+void ShardedStore::for_each_in_shard(
+    size_t shard,
+    const std::function<void(const std::string&, const StoreEntry&)>& fn) const {
+    epoch::Guard guard;
+    const Table* table = shards_[shard].table.load(std::memory_order_acquire);
+    for (size_t b = 0; b <= table->mask; ++b) {
+        for (const Node* node = table->buckets[b].load(std::memory_order_acquire); node;
+             node = node->next) {
+            fn(node->key, *node->entry.load(std::memory_order_acquire));
+        }
+    }
+}
+
+size_t ShardedStore::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i <= mask_; ++i) {
+        total += shards_[i].count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+}
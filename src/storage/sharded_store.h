@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "node/version.h"
+#include "storage/storage_engine.h"
+
+/*
+- In-memory key/value store split into a power-of-two number of shards.
+- The shard is chosen from the key's murmur3 hash. Writers serialize per shard
+  on a mutex; readers take no lock at all. Each shard is a chained hash table
+  whose bucket heads, chain links and entry pointers are published with
+  release stores, so a reader walks it with plain acquire loads.
+- Replaced entries and outgrown tables are handed to epoch::retire() and only
+  freed once no reader (holding an epoch::Guard) can still see them.
+*/
+namespace kv::storage {
+
+class ShardedStore {
+public:
+    using PutResult = kv::storage::PutResult;
+
+    // shard_count is rounded up to the next power of two (minimum 1).
+    explicit ShardedStore(size_t shard_count = 16);
+    ~ShardedStore();
+
+    ShardedStore(const ShardedStore&) = delete;
+    ShardedStore& operator=(const ShardedStore&) = delete;
+
+    std::optional<StoreEntry> get(const std::string& key) const;
+
+    // Stores the entry if its version is newer than the current one (LWW).
+    PutResult put_if_newer(const std::string& key,
+                           ValueRef value,
+                           const Version& version);
+
+    // Visits every entry of one shard without blocking writers. Entries
+    // written concurrently may or may not be seen.
+    void for_each_in_shard(
+        size_t shard,
+        const std::function<void(const std::string&, const StoreEntry&)>& fn) const;
+
+    size_t size() const;
+    size_t shard_count() const { return mask_ + 1; }
+    size_t shard_index(std::string_view key) const;
+
+private:
+    // Chain link. key, hash and next are immutable once the node is reachable;
+    // only the entry pointer is swapped by writers.
+    struct Node {
+        std::string key;
+        uint64_t hash;
+        std::atomic<const StoreEntry*> entry;
+        Node* next;
+    };
+
+    struct Table {
+        explicit Table(size_t bucket_count);
+
+        size_t mask;
+        std::unique_ptr<std::atomic<Node*>[]> buckets;
+    };
+
+    // Padded to a cache line so neighbouring shard locks do not false-share.
+    struct alignas(64) Shard {
+        std::mutex write_mu;
+        std::atomic<Table*> table{nullptr};
+        std::atomic<size_t> count{0};
+    };
+
+    static Node* find(const Table* table, const std::string& key, uint64_t hash);
+    static void grow(Shard& shard);
+
+    size_t mask_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+}
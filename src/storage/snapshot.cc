@@ -0,0 +1,298 @@
+#include "storage/snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "hash/murmur3.h"
+#include "storage/file_util.h"
+#include "utils/logging.h"
+
+namespace kv::storage {
+
+namespace {
+constexpr char MAGIC[8] = {'K', 'V', 'S', 'N', 'A', 'P', '0', '1'};
+constexpr uint64_t CHECKSUM_SEED = 0x534e4150;  // "SNAP"
+constexpr size_t HEADER_SIZE = sizeof(MAGIC) + 2 * sizeof(uint32_t) + sizeof(uint64_t);
+constexpr size_t INDEX_ENTRY_SIZE = 3 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+constexpr size_t RECORD_FIXED = 2 * sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+constexpr size_t WRITE_CHUNK = 1 << 20;
+
+struct IndexEntry {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    uint64_t records = 0;
+    uint32_t checksum = 0;
+};
+
+template <typename T>
+void put_raw(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template <typename T>
+T get_raw(const char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Order-dependent fold of per-record hashes, so sections can be checksummed
+// while streaming instead of hashing one large buffer.
+uint32_t fold_checksum(uint32_t sum, const char* record, size_t len) {
+    auto h = static_cast<uint32_t>(kv::hash::murmur3_64(record, len, CHECKSUM_SEED));
+    return (sum * 0x01000193u) ^ h;
+}
+
+std::runtime_error io_error(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+class FileWriter {
+public:
+    explicit FileWriter(const std::string& path) : path_(path) {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw io_error("cannot create snapshot", path);
+        }
+    }
+    ~FileWriter() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    void append(const std::string& data) {
+        buffer_.append(data);
+        written_ += data.size();
+        if (buffer_.size() >= WRITE_CHUNK) {
+            flush();
+        }
+    }
+
+    void flush() {
+        const char* p = buffer_.data();
+        size_t len = buffer_.size();
+        while (len > 0) {
+            ssize_t n = ::write(fd_, p, len);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                throw io_error("cannot write snapshot", path_);
+            }
+            p += n;
+            len -= static_cast<size_t>(n);
+        }
+        buffer_.clear();
+    }
+
+    void pwrite_at(const std::string& data, uint64_t offset) {
+        if (::pwrite(fd_, data.data(), data.size(), static_cast<off_t>(offset)) !=
+            static_cast<ssize_t>(data.size())) {
+            throw io_error("cannot write snapshot", path_);
+        }
+    }
+
+    void sync_and_close() {
+        flush();
+        if (::fsync(fd_) != 0) {
+            throw io_error("cannot sync snapshot", path_);
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    uint64_t written() const { return written_; }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    std::string buffer_;
+    uint64_t written_ = 0;
+};
+
+// Decodes one verified shard section into `store`.
+void load_section(const char* data, const IndexEntry& entry, ShardedStore& store) {
+    const char* p = data + entry.offset;
+    for (uint64_t i = 0; i < entry.records; ++i) {
+        auto key_len = get_raw<uint32_t>(p);
+        auto value_len = get_raw<uint32_t>(p + sizeof(uint32_t));
+        Version version{get_raw<uint64_t>(p + 2 * sizeof(uint32_t)),
+                        get_raw<uint32_t>(p + 2 * sizeof(uint32_t) + sizeof(uint64_t))};
+        const char* key = p + RECORD_FIXED;
+        store.put_if_newer(std::string(key, key_len),
+                           ValueRef(std::string(key + key_len, value_len)),
+                           version);
+        p += RECORD_FIXED + key_len + value_len;
+    }
+}
+
+// Walks a section's records, checking bounds, count and checksum.
+bool verify_section(const char* data, size_t file_size, const IndexEntry& entry) {
+    if (entry.offset > file_size || entry.length > file_size - entry.offset) {
+        return false;
+    }
+    const char* p = data + entry.offset;
+    uint64_t left = entry.length;
+    uint32_t sum = 0;
+    for (uint64_t i = 0; i < entry.records; ++i) {
+        if (left < RECORD_FIXED) {
+            return false;
+        }
+        uint64_t len = RECORD_FIXED + get_raw<uint32_t>(p) + get_raw<uint32_t>(p + sizeof(uint32_t));
+        if (len > left) {
+            return false;
+        }
+        sum = fold_checksum(sum, p, len);
+        p += len;
+        left -= len;
+    }
+    return left == 0 && sum == entry.checksum;
+}
+}
+
+SnapshotInfo write_snapshot(const std::string& path,
+                            const ShardedStore& store,
+                            uint64_t wal_segment) {
+    const std::string tmp_path = path + ".tmp";
+    const auto shards = static_cast<uint32_t>(store.shard_count());
+    std::vector<IndexEntry> index(shards);
+    SnapshotInfo info{wal_segment, 0};
+
+    FileWriter out(tmp_path);
+    std::string header;
+    header.append(MAGIC, sizeof(MAGIC));
+    put_raw(header, shards);
+    put_raw(header, uint32_t{0});
+    put_raw(header, wal_segment);
+    out.append(header);
+    // Placeholder; the index is filled in once section sizes are known.
+    out.append(std::string(shards * INDEX_ENTRY_SIZE, '\0'));
+
+    std::string record;
+    for (uint32_t shard = 0; shard < shards; ++shard) {
+        IndexEntry& entry = index[shard];
+        entry.offset = out.written();
+        store.for_each_in_shard(shard, [&](const std::string& key, const StoreEntry& e) {
+            record.clear();
+            put_raw(record, static_cast<uint32_t>(key.size()));
+            put_raw(record, static_cast<uint32_t>(e.value.size()));
+            put_raw(record, e.version.write_created_at_us);
+            put_raw(record, e.version.writer);
+            record.append(key);
+            record.append(e.value.view());
+            entry.checksum = fold_checksum(entry.checksum, record.data(), record.size());
+            entry.records++;
+            out.append(record);
+        });
+        entry.length = out.written() - entry.offset;
+        info.records += entry.records;
+    }
+    out.flush();
+
+    std::string encoded_index;
+    for (const auto& entry : index) {
+        put_raw(encoded_index, entry.offset);
+        put_raw(encoded_index, entry.length);
+        put_raw(encoded_index, entry.records);
+        put_raw(encoded_index, entry.checksum);
+        put_raw(encoded_index, uint32_t{0});
+    }
+    out.pwrite_at(encoded_index, HEADER_SIZE);
+    out.sync_and_close();
+
+    std::filesystem::rename(tmp_path, path);
+    sync_dir(std::filesystem::path(path).parent_path());
+    return info;
+}
+
+std::optional<SnapshotInfo> load_snapshot(const std::string& path,
+                                          ShardedStore& store,
+                                          size_t threads) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_SIZE) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    auto size = static_cast<size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        LOG_INFO("snapshot " << path << ": mmap failed: " << std::strerror(errno));
+        return std::nullopt;
+    }
+    ::madvise(mapped, size, MADV_WILLNEED);
+    const char* data = static_cast<const char*>(mapped);
+
+    auto shards = get_raw<uint32_t>(data + sizeof(MAGIC));
+    if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+        (size - HEADER_SIZE) / INDEX_ENTRY_SIZE < shards) {
+        LOG_INFO("snapshot " << path << ": bad header");
+        ::munmap(mapped, size);
+        return std::nullopt;
+    }
+
+    SnapshotInfo info;
+    info.wal_segment = get_raw<uint64_t>(data + sizeof(MAGIC) + 2 * sizeof(uint32_t));
+
+    std::vector<IndexEntry> index(shards);
+    for (uint32_t i = 0; i < shards; ++i) {
+        const char* p = data + HEADER_SIZE + i * INDEX_ENTRY_SIZE;
+        index[i] = IndexEntry{get_raw<uint64_t>(p),
+                              get_raw<uint64_t>(p + sizeof(uint64_t)),
+                              get_raw<uint64_t>(p + 2 * sizeof(uint64_t)),
+                              get_raw<uint32_t>(p + 3 * sizeof(uint64_t))};
+    }
+
+    // Sections are claimed from a shared counter so large shards do not
+    // leave other threads idle.
+    std::atomic<uint32_t> next{0};
+    std::atomic<size_t> loaded{0};
+    std::atomic<bool> corrupt{false};
+    auto worker = [&] {
+        for (uint32_t i = next.fetch_add(1); i < shards && !corrupt.load();
+             i = next.fetch_add(1)) {
+            if (!verify_section(data, size, index[i])) {
+                LOG_INFO("snapshot " << path << ": shard section " << i << " is corrupt");
+                corrupt.store(true);
+                return;
+            }
+            load_section(data, index[i], store);
+            loaded.fetch_add(index[i].records);
+        }
+    };
+
+    size_t workers = std::clamp<size_t>(threads, 1, std::max<uint32_t>(shards, 1));
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < workers; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    ::munmap(mapped, size);
+    if (corrupt.load()) {
+        return std::nullopt;
+    }
+    info.records = loaded.load();
+    return info;
+}
+
+}
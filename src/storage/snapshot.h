@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "storage/sharded_store.h"
+
+/*
+- Point-in-time snapshots of a ShardedStore in a compact binary file.
+- Layout (host byte order):
+    header  : "KVSNAP01" | u32 shard_count | u32 reserved | u64 wal_segment
+    index   : shard_count x { u64 offset | u64 length | u64 records | u32 checksum | u32 reserved }
+    sections: per shard, records of
+              u32 key_len | u32 value_len | u64 ts | u32 writer | key | value
+- wal_segment is the first WAL segment not covered by the snapshot. Snapshots
+  are fuzzy (taken while writes continue), which is safe because replaying
+  the WAL from that segment re-applies any overlap under LWW.
+- Loading mmaps the file and decodes shard sections on parallel threads.
+*/
+namespace kv::storage {
+
+struct SnapshotInfo {
+    uint64_t wal_segment = 0;
+    size_t records = 0;
+};
+
+// Writes `store` to `path` via a temporary file, fsync and rename, so a crash
+// never leaves a partial snapshot under `path`. Throws std::runtime_error on
+// I/O failure.
+SnapshotInfo write_snapshot(const std::string& path,
+                            const ShardedStore& store,
+                            uint64_t wal_segment);
+
+// Loads the snapshot at `path` into `store`, one shard section per task on up
+// to `threads` threads. Returns nullopt if the file is missing, its header is
+// invalid or any shard section fails its checksum; `store` may then hold part
+// of the snapshot.
+std::optional<SnapshotInfo> load_snapshot(const std::string& path,
+                                          ShardedStore& store,
+                                          size_t threads);
+
+}
@@ -0,0 +1,340 @@
+#include "storage/sstable.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+#include "storage/storage_engine.h"
+
+namespace kv::storage {
+
+namespace {
+constexpr uint64_t MAGIC = 0x4b56535354616232ULL;  // "KVSSTab2"
+constexpr uint64_t CHECKSUM_SEED = 0x53535442;     // "SSTB"
+constexpr size_t BLOCK_SIZE = 4096;
+constexpr size_t RECORD_FIXED = 2 * sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+constexpr size_t FOOTER_SIZE = 7 * sizeof(uint64_t);
+
+template <typename T>
+void put_raw(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template <typename T>
+T get_raw(const char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t checksum(const std::string& data) {
+    return static_cast<uint32_t>(kv::hash::murmur3_64(data, CHECKSUM_SEED));
+}
+
+std::runtime_error io_error(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+bool pread_all(int fd, char* out, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t n = ::pread(fd, out, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        out += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// Decodes the record at `pos` in a verified block; returns the next offset,
+// or 0 if the record overruns the block.
+size_t decode_record(const std::string& block, size_t pos, std::string& key, StoreEntry& entry) {
+    if (block.size() - pos < RECORD_FIXED) {
+        return 0;
+    }
+    const char* p = block.data() + pos;
+    auto key_len = get_raw<uint32_t>(p);
+    auto value_len = get_raw<uint32_t>(p + sizeof(uint32_t));
+    if (block.size() - pos - RECORD_FIXED < static_cast<size_t>(key_len) + value_len) {
+        return 0;
+    }
+    entry.version = Version{get_raw<uint64_t>(p + 2 * sizeof(uint32_t)),
+                            get_raw<uint32_t>(p + 2 * sizeof(uint32_t) + sizeof(uint64_t))};
+    key.assign(p + RECORD_FIXED, key_len);
+    entry.value = ValueRef(std::string(p + RECORD_FIXED + key_len, value_len));
+    return pos + RECORD_FIXED + key_len + value_len;
+}
+}
+
+// ---------------------------------------------------------------------------
+// SSTableBuilder
+// ---------------------------------------------------------------------------
+
+SSTableBuilder::SSTableBuilder(std::string path, size_t expected_keys)
+    : path_(std::move(path)),
+      tmp_path_(path_ + ".tmp"),
+      bloom_(expected_keys) {
+    fd_ = ::open(tmp_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw io_error("cannot create sstable", tmp_path_);
+    }
+}
+
+SSTableBuilder::~SSTableBuilder() {
+    if (fd_ >= 0) {
+        // finish() was never reached; drop the partial file.
+        ::close(fd_);
+        ::unlink(tmp_path_.c_str());
+    }
+}
+
+void SSTableBuilder::write(const std::string& data) {
+    const char* p = data.data();
+    size_t len = data.size();
+    while (len > 0) {
+        ssize_t n = ::write(fd_, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            throw io_error("cannot write sstable", tmp_path_);
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    offset_ += data.size();
+}
+
+void SSTableBuilder::add(const std::string& key, const StoreEntry& entry) {
+    put_raw(block_, static_cast<uint32_t>(key.size()));
+    put_raw(block_, static_cast<uint32_t>(entry.value.size()));
+    put_raw(block_, entry.version.write_created_at_us);
+    put_raw(block_, entry.version.writer);
+    block_.append(key);
+    block_.append(entry.value.view());
+    last_key_ = key;
+    bloom_.add(BloomFilter::hash(key));
+    records_++;
+
+    if (block_.size() >= BLOCK_SIZE) {
+        flush_block();
+    }
+}
+
+void SSTableBuilder::flush_block() {
+    if (block_.empty()) {
+        return;
+    }
+    index_.push_back(IndexEntry{last_key_, offset_, static_cast<uint32_t>(block_.size()),
+                                checksum(block_)});
+    write(block_);
+    block_.clear();
+}
+
+void SSTableBuilder::finish() {
+    flush_block();
+
+    std::string index;
+    for (const auto& e : index_) {
+        put_raw(index, static_cast<uint32_t>(e.last_key.size()));
+        index.append(e.last_key);
+        put_raw(index, e.offset);
+        put_raw(index, e.length);
+        put_raw(index, e.checksum);
+    }
+    uint64_t index_offset = offset_;
+    write(index);
+
+    uint64_t bloom_offset = offset_;
+    write(bloom_.data());
+
+    std::string footer;
+    put_raw(footer, index_offset);
+    put_raw(footer, static_cast<uint64_t>(index.size()));
+    put_raw(footer, bloom_offset);
+    put_raw(footer, static_cast<uint64_t>(bloom_.data().size()));
+    put_raw(footer, records_);
+    put_raw(footer, checksum(index));
+    put_raw(footer, checksum(bloom_.data()));
+    put_raw(footer, MAGIC);
+    write(footer);
+
+    if (::fsync(fd_) != 0) {
+        throw io_error("cannot sync sstable", tmp_path_);
+    }
+    ::close(fd_);
+    fd_ = -1;
+    std::filesystem::rename(tmp_path_, path_);
+}
+
+// ---------------------------------------------------------------------------
+// SSTable
+// ---------------------------------------------------------------------------
+
+SSTable::SSTable(std::string path, uint64_t id, int fd)
+    : path_(std::move(path)), id_(id), fd_(fd) {}
+
+SSTable::~SSTable() {
+    ::close(fd_);
+}
+
+std::shared_ptr<SSTable> SSTable::open(const std::string& path, uint64_t id) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw io_error("cannot open sstable", path);
+    }
+    // Owns fd from here on, so every throw below closes it.
+    std::shared_ptr<SSTable> table(new SSTable(path, id, fd));
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < FOOTER_SIZE) {
+        throw std::runtime_error("sstable " + path + " is truncated");
+    }
+    auto size = static_cast<uint64_t>(st.st_size);
+
+    char footer[FOOTER_SIZE];
+    if (!pread_all(fd, footer, FOOTER_SIZE, size - FOOTER_SIZE) ||
+        get_raw<uint64_t>(footer + 6 * sizeof(uint64_t)) != MAGIC) {
+        throw std::runtime_error("sstable " + path + " has a bad footer");
+    }
+    auto index_offset = get_raw<uint64_t>(footer);
+    auto index_len = get_raw<uint64_t>(footer + sizeof(uint64_t));
+    auto bloom_offset = get_raw<uint64_t>(footer + 2 * sizeof(uint64_t));
+    auto bloom_len = get_raw<uint64_t>(footer + 3 * sizeof(uint64_t));
+    table->records_ = get_raw<uint64_t>(footer + 4 * sizeof(uint64_t));
+    auto index_checksum = get_raw<uint32_t>(footer + 5 * sizeof(uint64_t));
+    auto bloom_checksum = get_raw<uint32_t>(footer + 5 * sizeof(uint64_t) + sizeof(uint32_t));
+    table->bytes_ = size;
+    // Written so that no sum can wrap: the lengths come from the file.
+    const uint64_t data_end = size - FOOTER_SIZE;
+    if (index_offset > bloom_offset || index_len > bloom_offset - index_offset ||
+        bloom_offset > data_end || bloom_len > data_end - bloom_offset) {
+        throw std::runtime_error("sstable " + path + " has a bad footer");
+    }
+
+    std::string index(index_len, '\0');
+    std::string bloom(bloom_len, '\0');
+    if (!pread_all(fd, index.data(), index.size(), index_offset) ||
+        !pread_all(fd, bloom.data(), bloom.size(), bloom_offset)) {
+        throw io_error("cannot read sstable", path);
+    }
+    if (checksum(index) != index_checksum) {
+        throw std::runtime_error("sstable " + path + ": index fails its checksum");
+    }
+    if (checksum(bloom) != bloom_checksum) {
+        throw std::runtime_error("sstable " + path + ": bloom filter fails its checksum");
+    }
+    table->bloom_ = BloomFilter::from_bytes(std::move(bloom));
+
+    constexpr size_t ENTRY_FIXED = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+    size_t pos = 0;
+    while (pos < index.size()) {
+        if (index.size() - pos < sizeof(uint32_t)) {
+            throw std::runtime_error("sstable " + path + " has a bad index");
+        }
+        auto key_len = get_raw<uint32_t>(index.data() + pos);
+        pos += sizeof(uint32_t);
+        if (index.size() - pos < key_len + ENTRY_FIXED) {
+            throw std::runtime_error("sstable " + path + " has a bad index");
+        }
+        IndexEntry e;
+        e.last_key.assign(index.data() + pos, key_len);
+        pos += key_len;
+        e.offset = get_raw<uint64_t>(index.data() + pos);
+        e.length = get_raw<uint32_t>(index.data() + pos + sizeof(uint64_t));
+        e.checksum = get_raw<uint32_t>(index.data() + pos + sizeof(uint64_t) + sizeof(uint32_t));
+        pos += ENTRY_FIXED;
+        table->index_.push_back(std::move(e));
+    }
+    return table;
+}
+
+void SSTable::read_block(size_t block, std::string& out) const {
+    const IndexEntry& e = index_[block];
+    out.resize(e.length);
+    if (!pread_all(fd_, out.data(), e.length, e.offset)) {
+        throw StorageError("sstable " + path_ + ": cannot read block " + std::to_string(block));
+    }
+    if (checksum(out) != e.checksum) {
+        throw StorageError("sstable " + path_ + ": block " + std::to_string(block) +
+                           " fails its checksum");
+    }
+}
+
+std::optional<StoreEntry> SSTable::get(const std::string& key) const {
+    if (!bloom_.may_contain(BloomFilter::hash(key))) {
+        return std::nullopt;
+    }
+    // First block whose last key is >= key is the only one that can hold it.
+    auto it = std::lower_bound(index_.begin(), index_.end(), key,
+                               [](const IndexEntry& e, const std::string& k) {
+                                   return e.last_key < k;
+                               });
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+
+    const auto block_index = static_cast<size_t>(it - index_.begin());
+    std::string block;
+    read_block(block_index, block);
+    std::string record_key;
+    StoreEntry entry;
+    for (size_t pos = 0; pos < block.size();) {
+        pos = decode_record(block, pos, record_key, entry);
+        if (pos == 0) {
+            throw StorageError("sstable " + path_ + ": block " + std::to_string(block_index) +
+                               " holds a malformed record");
+        }
+        if (record_key == key) {
+            return entry;
+        }
+    }
+    return std::nullopt;
+}
+
+SSTable::Cursor::Cursor(const SSTable& table) : table_(table) {
+    if (!table_.index_.empty()) {
+        load_block(0);
+        valid_ = true;
+        next();
+    }
+}
+
+void SSTable::Cursor::load_block(size_t block) {
+    block_ = block;
+    table_.read_block(block_, data_);
+    pos_ = 0;
+}
+
+void SSTable::Cursor::next() {
+    while (valid_) {
+        if (pos_ < data_.size()) {
+            size_t next = decode_record(data_, pos_, key_, entry_);
+            if (next == 0) {
+                throw StorageError("sstable " + table_.path_ + ": block " +
+                                   std::to_string(block_) + " holds a malformed record");
+            }
+            pos_ = next;
+            return;
+        }
+        if (block_ + 1 >= table_.index_.size()) {
+            valid_ = false;
+            return;
+        }
+        load_block(block_ + 1);
+    }
+}
+
+}
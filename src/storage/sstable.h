@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "node/version.h"
+#include "storage/bloom_filter.h"
+
+/*
+- Immutable sorted string table: one file of ~4 KiB data blocks, a block
+  index holding each block's last key and checksum, a bloom filter, and a
+  fixed footer locating the index and filter and holding their checksums.
+- Record layout (host byte order):
+    u32 key_len | u32 value_len | u64 ts | u32 writer | key | value
+- The index and bloom filter are loaded on open; a point lookup costs one
+  bloom probe and, on a hit, one pread() of a single block.
+*/
+namespace kv::storage {
+
+using kv::node::StoreEntry;
+using kv::node::ValueRef;
+using kv::node::Version;
+
+// Writes a table to `path` from keys added in strictly increasing order. The
+// file is built under a temporary name and renamed into place by finish(),
+// which may replace an existing table. Throws std::runtime_error on I/O
+// failure.
+class SSTableBuilder {
+public:
+    SSTableBuilder(std::string path, size_t expected_keys);
+    ~SSTableBuilder();
+
+    SSTableBuilder(const SSTableBuilder&) = delete;
+    SSTableBuilder& operator=(const SSTableBuilder&) = delete;
+
+    void add(const std::string& key, const StoreEntry& entry);
+    void finish();
+
+private:
+    struct IndexEntry {
+        std::string last_key;
+        uint64_t offset;
+        uint32_t length;
+        uint32_t checksum;
+    };
+
+    void write(const std::string& data);
+    void flush_block();
+
+    std::string path_;
+    std::string tmp_path_;
+    int fd_ = -1;
+    uint64_t offset_ = 0;
+    uint64_t records_ = 0;
+    std::string block_;
+    std::string last_key_;
+    std::vector<IndexEntry> index_;
+    BloomFilter bloom_;
+};
+
+class SSTable {
+public:
+    // Opens a table written by SSTableBuilder. Throws std::runtime_error if
+    // the file is unreadable, its footer is malformed, or its index or filter
+    // fails its checksum.
+    static std::shared_ptr<SSTable> open(const std::string& path, uint64_t id);
+    ~SSTable();
+
+    SSTable(const SSTable&) = delete;
+    SSTable& operator=(const SSTable&) = delete;
+
+    // Throws StorageError if the key's block is unreadable or corrupt.
+    std::optional<StoreEntry> get(const std::string& key) const;
+
+    // Sequential scan in key order, one block in memory at a time. The
+    // constructor and next() throw StorageError on an unreadable or corrupt
+    // block rather than skipping it.
+    class Cursor {
+    public:
+        explicit Cursor(const SSTable& table);
+        bool valid() const { return valid_; }
+        const std::string& key() const { return key_; }
+        const StoreEntry& entry() const { return entry_; }
+        void next();
+
+    private:
+        void load_block(size_t block);
+
+        const SSTable& table_;
+        size_t block_ = 0;
+        std::string data_;
+        size_t pos_ = 0;
+        bool valid_ = false;
+        std::string key_;
+        StoreEntry entry_;
+    };
+
+    uint64_t id() const { return id_; }
+    uint64_t records() const { return records_; }
+    uint64_t bytes() const { return bytes_; }  // file size
+    const std::string& path() const { return path_; }
+
+private:
+    struct IndexEntry {
+        std::string last_key;
+        uint64_t offset;
+        uint32_t length;
+        uint32_t checksum;
+    };
+
+    SSTable(std::string path, uint64_t id, int fd);
+    void read_block(size_t block, std::string& out) const;
+
+    std::string path_;
+    uint64_t id_;
+    int fd_;
+    uint64_t records_ = 0;
+    uint64_t bytes_ = 0;
+    std::vector<IndexEntry> index_;
+    BloomFilter bloom_{0};
+};
+
+}
@@ -0,0 +1,41 @@
+#include "storage/storage_engine.h"
+
+#include <stdexcept>
+
+#include "storage/lsm_engine.h"
+#include "storage/memory_engine.h"
+
+namespace kv::storage {
+
+std::optional<StorageEngineKind> parse_storage_engine(std::string_view value) {
+    if (value == "memory") return StorageEngineKind::Memory;
+    if (value == "lsm") return StorageEngineKind::Lsm;
+    return std::nullopt;
+}
+
+const char* to_string(StorageEngineKind kind) {
+    switch (kind) {
+        case StorageEngineKind::Memory: return "memory";
+        case StorageEngineKind::Lsm: return "lsm";
+    }
+    return "unknown";
+}
+
+std::unique_ptr<StorageEngine> make_storage_engine(const StorageEngineOptions& options) {
+    switch (options.kind) {
+        case StorageEngineKind::Memory:
+            return std::make_unique<MemoryEngine>(options);
+        case StorageEngineKind::Lsm:
+            if (options.data_dir.empty()) {
+                throw std::invalid_argument("lsm storage engine requires a data_dir");
+            }
+            if (options.lsm_memtable_bytes == 0 || options.lsm_compaction_trigger < 2) {
+                throw std::invalid_argument(
+                    "lsm storage engine needs a non-zero memtable size and a compaction trigger >= 2");
+            }
+            return std::make_unique<LsmEngine>(options);
+    }
+    throw std::invalid_argument("unknown storage engine");
+}
+
+}
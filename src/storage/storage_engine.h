@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "node/version.h"
+#include "storage/wal.h"
+
+/*
+- Interface between Node and whatever holds its replica data.
+- Engines apply last-write-wins themselves (put_if_newer) and own their
+  durability: write-ahead logging, recovery on construction, and
+  checkpoint(), which bounds the log.
+- "memory": the sharded in-memory store, optionally persisted with a WAL
+  plus periodic snapshots. "lsm": a log-structured merge tree on disk, for
+  datasets larger than RAM.
+*/
+namespace kv::storage {
+
+using kv::node::StoreEntry;
+using kv::node::ValueRef;
+using kv::node::Version;
+
+// Stored data could not be read back intact (failed checksum, malformed
+// record or read error). The key is unreadable, not missing: falling back to
+// an older copy would serve stale data.
+class StorageError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+struct PutResult {
+    bool overwritten;                 // incoming version won LWW
+    std::optional<Version> previous;  // version held before the put
+    bool io_error = false;            // the write could not be made durable
+};
+
+enum class StorageEngineKind {
+    Memory,
+    Lsm,
+};
+
+// Accepts memory/lsm (case-sensitive).
+std::optional<StorageEngineKind> parse_storage_engine(std::string_view value);
+const char* to_string(StorageEngineKind kind);
+
+struct StorageEngineOptions {
+    StorageEngineKind kind = StorageEngineKind::Memory;
+    // Empty keeps a memory engine purely in memory. Required for lsm.
+    std::string data_dir;
+    WalSyncMode wal_sync_mode = WalSyncMode::Batch;
+    std::chrono::milliseconds wal_sync_interval{10};
+
+    size_t memory_shards = 16;                // memory: power of two
+    size_t lsm_memtable_bytes = 64u << 20;    // lsm: flush threshold
+    size_t lsm_compaction_trigger = 4;        // lsm: size-tiered run length to merge
+
+    std::string log_prefix;  // prepended to the engine's log lines
+};
+
+class StorageEngine {
+public:
+    virtual ~StorageEngine() = default;
+
+    // get(), put_if_newer() and for_each() throw StorageError if they hit
+    // stored data that fails verification.
+    virtual std::optional<StoreEntry> get(const std::string& key) const = 0;
+
+    // Stores the entry if its version is newer than the current one (LWW).
+    virtual PutResult put_if_newer(const std::string& key,
+                                   ValueRef value,
+                                   const Version& version) = 0;
+
+    // Visits the newest entry of every key, in no particular order, without
+    // blocking writers for the length of the scan. Entries written
+    // concurrently may or may not be seen.
+    virtual void for_each(
+        const std::function<void(const std::string&, const StoreEntry&)>& fn) const = 0;
+
+    // Number of keys; approximate for engines that may hold several
+    // versions of a key at once.
+    virtual size_t size() const = 0;
+
+    // Persists in-memory state so the write-ahead log can be truncated.
+    // Returns false if the engine is not persistent or the checkpoint failed.
+    virtual bool checkpoint() = 0;
+
+    virtual StorageEngineKind kind() const = 0;
+};
+
+// Builds and recovers the configured engine. Throws std::invalid_argument for
+// unusable options and std::runtime_error on I/O failure during recovery.
+std::unique_ptr<StorageEngine> make_storage_engine(const StorageEngineOptions& options);
+
+}
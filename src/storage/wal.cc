@@ -0,0 +1,395 @@
+#include "storage/wal.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "hash/murmur3.h"
+#include "storage/file_util.h"
+#include "utils/logging.h"
+
+namespace kv::storage {
+
+namespace {
+constexpr uint64_t CHECKSUM_SEED = 0x57414c31;  // "WAL1"
+constexpr size_t HEADER_SIZE = 2 * sizeof(uint32_t);
+constexpr size_t PAYLOAD_FIXED = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+// Writers block once this much is buffered so a slow disk applies backpressure.
+constexpr size_t MAX_BUFFERED_BYTES = 4 << 20;
+
+uint32_t checksum(const char* data, size_t len) {
+    return static_cast<uint32_t>(kv::hash::murmur3_64(data, len, CHECKSUM_SEED));
+}
+
+template <typename T>
+void put_raw(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template <typename T>
+T get_raw(const char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+void encode_record(std::string& out, const std::string& key, std::string_view value,
+                   const Version& version) {
+    auto payload_len = static_cast<uint32_t>(PAYLOAD_FIXED + key.size() + value.size());
+    size_t start = out.size();
+    put_raw(out, payload_len);
+    put_raw(out, uint32_t{0});
+    put_raw(out, version.write_created_at_us);
+    put_raw(out, version.writer);
+    put_raw(out, static_cast<uint32_t>(key.size()));
+    out.append(key);
+    out.append(value);
+
+    uint32_t sum = checksum(out.data() + start + HEADER_SIZE, payload_len);
+    std::memcpy(out.data() + start + sizeof(uint32_t), &sum, sizeof(sum));
+}
+
+bool write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Segment ids found in `dir`, ascending.
+std::vector<uint64_t> list_segments(const std::string& dir) {
+    std::vector<uint64_t> ids;
+    for (const auto& file : std::filesystem::directory_iterator(dir)) {
+        uint64_t id = 0;
+        char tail = 0;
+        std::string name = file.path().filename().string();
+        if (std::sscanf(name.c_str(), "wal-%" SCNu64 ".lo%c", &id, &tail) == 2 && tail == 'g') {
+            ids.push_back(id);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+int open_segment(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open WAL " + path + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+// Reads a whole segment; returns the offset just past the last intact record.
+size_t replay_file(int fd, const WriteAheadLog::RecordFn& fn, size_t& records) {
+    std::string data;
+    char chunk[1 << 16];
+    for (;;) {
+        ssize_t n = ::read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        data.append(chunk, static_cast<size_t>(n));
+    }
+
+    size_t pos = 0;
+    while (data.size() - pos >= HEADER_SIZE) {
+        auto payload_len = get_raw<uint32_t>(data.data() + pos);
+        auto sum = get_raw<uint32_t>(data.data() + pos + sizeof(uint32_t));
+        const char* payload = data.data() + pos + HEADER_SIZE;
+        if (payload_len < PAYLOAD_FIXED || data.size() - pos - HEADER_SIZE < payload_len ||
+            checksum(payload, payload_len) != sum) {
+            break;
+        }
+        auto key_len = get_raw<uint32_t>(payload + sizeof(uint64_t) + sizeof(uint32_t));
+        if (key_len > payload_len - PAYLOAD_FIXED) {
+            break;
+        }
+        Version version{get_raw<uint64_t>(payload),
+                        get_raw<uint32_t>(payload + sizeof(uint64_t))};
+        std::string key(payload + PAYLOAD_FIXED, key_len);
+        std::string value(payload + PAYLOAD_FIXED + key_len,
+                          payload_len - PAYLOAD_FIXED - key_len);
+        fn(key, ValueRef(std::move(value)), version);
+        records++;
+        pos += HEADER_SIZE + payload_len;
+    }
+    return pos;
+}
+}
+
+std::optional<WalSyncMode> parse_wal_sync_mode(std::string_view value) {
+    if (value == "none") return WalSyncMode::None;
+    if (value == "batch") return WalSyncMode::Batch;
+    if (value == "periodic") return WalSyncMode::Periodic;
+    return std::nullopt;
+}
+
+const char* to_string(WalSyncMode mode) {
+    switch (mode) {
+        case WalSyncMode::None: return "none";
+        case WalSyncMode::Batch: return "batch";
+        case WalSyncMode::Periodic: return "periodic";
+    }
+    return "unknown";
+}
+
+WriteAheadLog::WriteAheadLog(Options options, const RecordFn& replay)
+    : options_(std::move(options)) {
+    std::filesystem::create_directories(options_.dir);
+    migrate_legacy_log();
+
+    std::vector<uint64_t> segments;
+    for (uint64_t id : list_segments(options_.dir)) {
+        if (id < options_.first_segment) {
+            std::filesystem::remove(segment_path(id));
+        } else {
+            segments.push_back(id);
+        }
+    }
+
+    // Every segment is replayed; only the newest one is reopened and may
+    // legitimately end in a torn record.
+    for (size_t i = 0; i < segments.size(); ++i) {
+        std::string path = segment_path(segments[i]);
+        int fd = open_segment(path);
+        size_t valid = replay_file(fd, replay, replayed_records_);
+        off_t end = ::lseek(fd, 0, SEEK_END);
+        if (end > static_cast<off_t>(valid) && i + 1 < segments.size()) {
+            // Dropping it would lose acknowledged records from the middle
+            // of the log.
+            ::close(fd);
+            throw std::runtime_error("WAL " + path + " is corrupt at offset " +
+                                     std::to_string(valid) + " but is not the newest segment");
+        }
+        if (end > static_cast<off_t>(valid)) {
+            LOG_INFO("WAL " << path << ": dropping "
+                     << (end - static_cast<off_t>(valid)) << " bytes of torn tail");
+            if (::ftruncate(fd, static_cast<off_t>(valid)) != 0) {
+                ::close(fd);
+                throw std::runtime_error("cannot truncate WAL " + path + ": " +
+                                         std::strerror(errno));
+            }
+        }
+        if (i + 1 < segments.size()) {
+            ::close(fd);
+            continue;
+        }
+        ::lseek(fd, static_cast<off_t>(valid), SEEK_SET);
+        fd_ = fd;
+        segment_ = segments[i];
+    }
+
+    if (fd_ < 0) {
+        segment_ = std::max<uint64_t>(options_.first_segment, 1);
+        fd_ = open_segment(segment_path(segment_));
+    }
+    // Records synced into a segment are only durable once its directory
+    // entry is: covers a new segment, a migrated wal.log and the segments
+    // dropped above.
+    if (!sync_dir(options_.dir)) {
+        throw std::runtime_error("cannot sync WAL directory " + options_.dir + ": " +
+                                 std::strerror(errno));
+    }
+
+    flusher_ = std::thread([this] { flush_loop(); });
+}
+
+void WriteAheadLog::migrate_legacy_log() {
+    // Logs written before segmentation were a single wal.log with the same
+    // record layout; it becomes the first segment. Alongside segments or a
+    // snapshot its place in the history is unknown, so refuse to guess.
+    const auto legacy = std::filesystem::path(options_.dir) / "wal.log";
+    if (!std::filesystem::exists(legacy)) {
+        return;
+    }
+    if (options_.first_segment > 1 || !list_segments(options_.dir).empty()) {
+        throw std::runtime_error("WAL " + legacy.string() +
+                                 " predates segmented logs but segments or a snapshot already exist;"
+                                 " move it aside to start");
+    }
+    const uint64_t first = std::max<uint64_t>(options_.first_segment, 1);
+    std::filesystem::rename(legacy, segment_path(first));
+    LOG_INFO("WAL " << legacy.string() << ": migrated to " << segment_path(first));
+}
+
+std::string WriteAheadLog::segment_path(uint64_t segment) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "wal-%016" PRIu64 ".log", segment);
+    return (std::filesystem::path(options_.dir) / name).string();
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    sync();
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    flusher_.join();
+    ::close(fd_);
+}
+
+bool WriteAheadLog::append(const std::string& key, std::string_view value,
+                           const Version& version) {
+    return wait(enqueue(key, value, version));
+}
+
+uint64_t WriteAheadLog::enqueue(const std::string& key, std::string_view value,
+                                const Version& version) {
+    std::unique_lock<std::mutex> lock(mu_);
+    done_cv_.wait(lock, [&] { return buffer_.size() < MAX_BUFFERED_BYTES || failed_; });
+    if (failed_) {
+        return 0;
+    }
+
+    encode_record(buffer_, key, value, version);
+    uint64_t seq = ++appended_seq_;
+    work_cv_.notify_one();
+    return seq;
+}
+
+bool WriteAheadLog::wait(uint64_t seq) {
+    if (seq == 0) {
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(mu_);
+    if (options_.sync_mode == WalSyncMode::Batch) {
+        done_cv_.wait(lock, [&] { return durable_seq_ >= seq || failed_; });
+    }
+    return !failed_;
+}
+
+bool WriteAheadLog::sync() {
+    std::unique_lock<std::mutex> lock(mu_);
+    uint64_t seq = appended_seq_;
+    if (durable_seq_ >= seq) {
+        return !failed_;
+    }
+    sync_requested_seq_ = std::max(sync_requested_seq_, seq);
+    work_cv_.notify_one();
+    done_cv_.wait(lock, [&] { return durable_seq_ >= seq || failed_; });
+    return !failed_;
+}
+
+uint64_t WriteAheadLog::rotate() {
+    std::unique_lock<std::mutex> lock(mu_);
+    if (failed_) {
+        return 0;
+    }
+    rotate_requested_ = true;
+    work_cv_.notify_one();
+    done_cv_.wait(lock, [&] { return !rotate_requested_ || failed_; });
+    return failed_ ? 0 : segment_;
+}
+
+void WriteAheadLog::remove_segments_before(uint64_t segment) {
+    for (uint64_t id : list_segments(options_.dir)) {
+        if (id < segment) {
+            std::error_code ec;
+            std::filesystem::remove(segment_path(id), ec);
+        }
+    }
+    // Otherwise a crash could bring back segments whose records are
+    // already covered by a checkpoint.
+    sync_dir(options_.dir);
+}
+
+uint64_t WriteAheadLog::syncs() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return syncs_;
+}
+
+void WriteAheadLog::flush_loop() {
+    const bool periodic = options_.sync_mode == WalSyncMode::Periodic;
+    auto next_periodic_sync = std::chrono::steady_clock::now() + options_.sync_interval;
+    std::string batch;
+
+    std::unique_lock<std::mutex> lock(mu_);
+    for (;;) {
+        auto has_work = [&] {
+            return stopping_ || rotate_requested_ || !buffer_.empty() ||
+                   sync_requested_seq_ > durable_seq_ ||
+                   (periodic && written_seq_ > durable_seq_ &&
+                    std::chrono::steady_clock::now() >= next_periodic_sync);
+        };
+        if (periodic && written_seq_ > durable_seq_) {
+            work_cv_.wait_until(lock, next_periodic_sync, has_work);
+        } else {
+            work_cv_.wait(lock, has_work);
+        }
+        if (stopping_ && buffer_.empty() && !rotate_requested_) {
+            return;
+        }
+
+        batch.swap(buffer_);
+        uint64_t batch_seq = appended_seq_;
+        const bool rotate = rotate_requested_;
+        const uint64_t next_segment = segment_ + 1;
+        bool want_sync =
+            options_.sync_mode == WalSyncMode::Batch || rotate ||
+            sync_requested_seq_ > durable_seq_ ||
+            (periodic && std::chrono::steady_clock::now() >= next_periodic_sync);
+        lock.unlock();
+        done_cv_.notify_all();  // buffer space freed
+
+        bool ok = batch.empty() || write_all(fd_, batch.data(), batch.size());
+        if (ok && want_sync) {
+            ok = ::fdatasync(fd_) == 0;
+        }
+        batch.clear();
+
+        int next_fd = -1;
+        if (ok && rotate) {
+            next_fd = ::open(segment_path(next_segment).c_str(),
+                             O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            ok = next_fd >= 0 && sync_dir(options_.dir);
+            if (!ok && next_fd >= 0) {
+                ::close(next_fd);
+                next_fd = -1;
+            }
+        }
+
+        lock.lock();
+        if (!ok) {
+            LOG_INFO("WAL segment " << segment_ << " in " << options_.dir
+                     << ": write failed: " << std::strerror(errno));
+            failed_ = true;
+        }
+        if (next_fd >= 0) {
+            ::close(fd_);
+            fd_ = next_fd;
+            segment_ = next_segment;
+        }
+        rotate_requested_ = false;
+        written_seq_ = batch_seq;
+        if (want_sync) {
+            durable_seq_ = batch_seq;
+            syncs_++;
+            next_periodic_sync = std::chrono::steady_clock::now() + options_.sync_interval;
+        }
+        done_cv_.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "node/version.h"
+
+/*
+- Append-only write-ahead log of applied puts.
+- Writers encode records into a shared in-memory batch; a single flusher
+  thread writes each batch with one write() and, depending on the sync mode,
+  one fdatasync(). Writers that arrive while a sync is in flight form the
+  next batch, so concurrent writers share the cost of each fsync (group
+  commit).
+- The log is a sequence of segment files wal-<id>.log in one directory.
+  rotate() starts a new segment so a snapshot can cover everything before
+  it and the older segments can be deleted. A single wal.log left by older
+  builds is adopted as the first segment on open.
+- Record layout (host byte order):
+    u32 payload_len | u32 checksum | u64 ts | u32 writer | u32 key_len | key | value
+  A torn or corrupt tail left by a crash is dropped on open; only the newest
+  segment can have one, so a bad record in an older segment fails the open.
+*/
+namespace kv::storage {
+
+using kv::node::ValueRef;
+using kv::node::Version;
+
+enum class WalSyncMode {
+    None,      // write to the OS, never fsync; survives process but not host crashes
+    Batch,     // append() returns once its batch is fsynced (group commit)
+    Periodic,  // fsync every sync_interval; append() does not wait
+};
+
+// Accepts none/batch/periodic (case-sensitive).
+std::optional<WalSyncMode> parse_wal_sync_mode(std::string_view value);
+const char* to_string(WalSyncMode mode);
+
+class WriteAheadLog {
+public:
+    struct Options {
+        std::string dir;
+        WalSyncMode sync_mode = WalSyncMode::Batch;
+        std::chrono::milliseconds sync_interval{10};  // Periodic mode only
+        // Segments below this id are already covered by a snapshot; they are
+        // deleted instead of replayed.
+        uint64_t first_segment = 0;
+    };
+
+    using RecordFn = std::function<void(const std::string& key,
+                                        ValueRef value,
+                                        const Version& version)>;
+
+    // Replays every intact record in the segments of options.dir (oldest
+    // first) through `replay`, truncates a torn tail of the newest segment,
+    // and opens it for appending. Throws std::runtime_error on I/O failure or
+    // a bad record in an older segment.
+    WriteAheadLog(Options options, const RecordFn& replay);
+
+    // Flushes and syncs whatever is still buffered.
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Returns false if the record could not be written (or, in Batch mode,
+    // synced). Blocks for the fsync only in Batch mode. Same as
+    // wait(enqueue(...)).
+    bool append(const std::string& key, std::string_view value, const Version& version);
+
+    // Buffers the record for the next batch without waiting for it and
+    // returns its sequence number, or 0 if the log has failed. Records land
+    // in the segment current at the call, in call order.
+    uint64_t enqueue(const std::string& key, std::string_view value, const Version& version);
+
+    // Blocks until record `seq` from enqueue() is synced (Batch mode only).
+    // Waiting on the last of several records covers all of them. Returns
+    // false if seq is 0 or the log has failed.
+    bool wait(uint64_t seq);
+
+    // Writes and fsyncs everything appended so far, regardless of mode.
+    bool sync();
+
+    // Syncs the current segment and switches appends to a new one. Every
+    // record appended before the call is in a segment below the returned id.
+    // Returns 0 on I/O failure.
+    uint64_t rotate();
+
+    // Deletes segment files whose id is below `segment`.
+    void remove_segments_before(uint64_t segment);
+
+    size_t replayed_records() const { return replayed_records_; }
+    uint64_t syncs() const;
+
+private:
+    // Renames a pre-segment wal.log to the first segment; throws
+    // std::runtime_error if segments or a snapshot already exist beside it.
+    void migrate_legacy_log();
+    std::string segment_path(uint64_t segment) const;
+    void flush_loop();
+
+    Options options_;
+    int fd_ = -1;
+    size_t replayed_records_ = 0;
+
+    mutable std::mutex mu_;
+    std::condition_variable work_cv_;  // flusher: new data, sync request, stop
+    std::condition_variable done_cv_;  // writers: batch written/synced
+    std::string buffer_;               // records not yet handed to write()
+    uint64_t appended_seq_ = 0;        // last record placed in buffer_
+    uint64_t written_seq_ = 0;         // last record handed to write()
+    uint64_t durable_seq_ = 0;         // last record covered by fdatasync()
+    uint64_t sync_requested_seq_ = 0;  // sync() asks the flusher to cover this
+    uint64_t syncs_ = 0;
+    uint64_t segment_ = 0;             // id of the segment fd_ appends to
+    bool rotate_requested_ = false;
+    bool failed_ = false;
+    bool stopping_ = false;
+    std::thread flusher_;
+};
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+/*
+- Scratch directories for tests that write to disk.
+*/
+namespace kv::test {
+
+// Empty directory under the system temp dir, named after the running test
+// and the process so no two tests or concurrent runs share one. Removed with
+// everything in it on destruction. `tag` tells apart several directories in
+// one test.
+struct TempDir {
+    std::filesystem::path path;
+
+    explicit TempDir(const std::string& tag = "") {
+        const auto* test = ::testing::UnitTest::GetInstance()->current_test_info();
+        std::string name = "kv_" + std::string(test->test_suite_name()) + "." + test->name() +
+                           "_" + std::to_string(::getpid());
+        if (!tag.empty()) {
+            name += "_" + tag;
+        }
+        // Parameterized test names contain '/'.
+        for (char& c : name) {
+            if (c == '/') {
+                c = '_';
+            }
+        }
+        path = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+};
+
+}  // namespace kv::test
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+#include "cluster/cluster_view.h"
+#include "node/channel_pool.h"
+
+using kv::cluster::ClusterView;
+using kv::node::ChannelPool;
+using kv::node::ChannelSelection;
+
+// Channels are created lazily and never connected here (no warm_up), so
+// every channel stays IDLE and counts as healthy.
+
+TEST(ChannelPool, UnknownPeerYieldsEmptyLease) {
+    ClusterView view;
+    ChannelPool pool(view, 2, ChannelSelection::RoundRobin);
+
+    auto lease = pool.acquire("ghost");
+    EXPECT_FALSE(lease);
+    EXPECT_EQ(lease.stub(), nullptr);
+}
+
+TEST(ChannelPool, ZeroChannelsThrows) {
+    ClusterView view;
+    EXPECT_THROW(ChannelPool(view, 0, ChannelSelection::RoundRobin), std::invalid_argument);
+}
+
+TEST(ChannelPool, RoundRobinCyclesThroughChannels) {
+    ClusterView view;
+    view.add_node_to_cluster("A", "localhost:5000");
+    ChannelPool pool(view, 3, ChannelSelection::RoundRobin);
+
+    std::vector<size_t> order;
+    std::set<kvstore::KeyValue::Stub*> stubs;
+    for (int i = 0; i < 6; ++i) {
+        auto lease = pool.acquire("A");
+        ASSERT_TRUE(lease);
+        order.push_back(lease.channel_index());
+        stubs.insert(lease.stub());
+    }
+    EXPECT_EQ(order, (std::vector<size_t>{0, 1, 2, 0, 1, 2}));
+    EXPECT_EQ(stubs.size(), 3u);
+}
+
+TEST(ChannelPool, LeastInflightAvoidsBusyChannels) {
+    ClusterView view;
+    view.add_node_to_cluster("A", "localhost:5000");
+    ChannelPool pool(view, 3, ChannelSelection::LeastInflight);
+
+    // Held leases spread over all three channels before any repeats.
+    std::vector<ChannelPool::Lease> held;
+    std::set<size_t> used;
+    for (int i = 0; i < 3; ++i) {
+        held.push_back(pool.acquire("A"));
+        used.insert(held.back().channel_index());
+    }
+    EXPECT_EQ(used.size(), 3u);
+    EXPECT_EQ(pool.inflight("A"), 3u);
+
+    // Freeing one channel makes it the next pick.
+    size_t freed = held[1].channel_index();
+    held.erase(held.begin() + 1);
+    held.push_back(pool.acquire("A"));
+    EXPECT_EQ(held.back().channel_index(), freed);
+
+    held.clear();
+    EXPECT_EQ(pool.inflight("A"), 0u);
+}
+
+TEST(ChannelPool, AddressChangeRebuildsChannels) {
+    ClusterView view;
+    view.add_node_to_cluster("A", "localhost:5000");
+    ChannelPool pool(view, 1, ChannelSelection::RoundRobin);
+
+    auto old_lease = pool.acquire("A");
+    ASSERT_TRUE(old_lease);
+    auto* old_stub = old_lease.stub();
+    EXPECT_EQ(pool.acquire("A").stub(), old_stub);
+
+    view.remove_node_from_cluster("A");
+    EXPECT_FALSE(pool.acquire("A"));
+
+    view.add_node_to_cluster("A", "localhost:6000");
+    auto new_lease = pool.acquire("A");
+    ASSERT_TRUE(new_lease);
+    EXPECT_NE(new_lease.stub(), old_stub);
+
+    // The outstanding lease still points at its (old) live channel.
+    EXPECT_EQ(old_lease.stub(), old_stub);
+}
+
+TEST(ChannelPool, ParseSelection) {
+    EXPECT_EQ(kv::node::parse_channel_selection("round_robin"), ChannelSelection::RoundRobin);
+    EXPECT_EQ(kv::node::parse_channel_selection("least_inflight"), ChannelSelection::LeastInflight);
+    EXPECT_FALSE(kv::node::parse_channel_selection("random").has_value());
+}
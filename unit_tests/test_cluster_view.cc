@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include "cluster/cluster_view.h"
 
@@ -97,3 +102,98 @@ TEST(ClusterView, ReplicationFactorZeroReturnsEmpty) {
     auto replicas = view.get_replica_set_for_key("key", 0);
     EXPECT_TRUE(replicas.empty());
 }
+
+// Writer ids are derived from the name, so independent views agree on them.
+TEST(ClusterView, InternWriterIsDeterministicAcrossViews) {
+    ClusterView a;
+    ClusterView b;
+
+    uint32_t id = a.intern_writer("nodeA");
+    EXPECT_NE(id, 0u);
+    EXPECT_EQ(id, a.intern_writer("nodeA"));
+    EXPECT_EQ(id, b.intern_writer("nodeA"));
+    EXPECT_NE(id, a.intern_writer("nodeB"));
+}
+
+TEST(ClusterView, WriterNameResolvesInternedAndMemberIds) {
+    ClusterView view;
+
+    uint32_t interned = view.intern_writer("client-writer");
+    EXPECT_EQ(view.writer_name(interned), "client-writer");
+
+    // Adding a node interns it too, and the name outlives its removal.
+    view.add_node_to_cluster("nodeA", "localhost:5000");
+    uint32_t member = view.intern_writer("nodeA");
+    view.remove_node_from_cluster("nodeA");
+    EXPECT_EQ(view.writer_name(member), "nodeA");
+
+    EXPECT_FALSE(view.writer_name(0).has_value());
+}
+
+TEST(ClusterView, FindWriterOnlyResolvesKnownNames) {
+    ClusterView view;
+    view.add_node_to_cluster("nodeA", "localhost:5000");
+
+    uint32_t member = view.intern_writer("nodeA");
+    EXPECT_EQ(view.find_writer("nodeA"), member);
+
+    // Looking a name up does not intern it; interning does.
+    EXPECT_FALSE(view.find_writer("stranger").has_value());
+    EXPECT_FALSE(view.find_writer("stranger").has_value());
+    uint32_t interned = view.intern_writer("stranger");
+    EXPECT_EQ(view.find_writer("stranger"), interned);
+}
+
+// "node-93722" and "node-134589" hash to the same writer id.
+TEST(ClusterView, AddingACollidingNodeThrows) {
+    ClusterView view;
+    view.add_node_to_cluster("node-93722", "localhost:5000");
+
+    EXPECT_THROW(view.add_node_to_cluster("node-134589", "localhost:5001"),
+                 std::invalid_argument);
+    EXPECT_FALSE(view.get_node_address("node-134589").has_value());
+    EXPECT_EQ(view.get_node_ids().size(), 1u);
+    EXPECT_EQ(view.writer_name(view.intern_writer("node-93722")), "node-93722");
+    EXPECT_THROW(view.intern_writer("node-134589"), std::invalid_argument);
+}
+
+// Readers run against published snapshots while membership churns: every
+// replica set they see must be a consistent one (distinct, known members),
+// and the stable nodes never disappear.
+TEST(ClusterView, ReadersSeeConsistentSnapshotsDuringMembershipChanges) {
+    ClusterView view(32, 3);
+    view.add_node_to_cluster("A", "localhost:5000");
+    view.add_node_to_cluster("B", "localhost:5001");
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> bad{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t] {
+            for (int i = 0; !stop.load(); ++i) {
+                auto replicas = view.get_replica_set_for_key(
+                    "key_" + std::to_string(t) + "_" + std::to_string(i), 3);
+                std::unordered_set<std::string> unique(replicas.begin(), replicas.end());
+                if (replicas.size() < 2 || unique.size() != replicas.size()) {
+                    bad.fetch_add(1);
+                }
+                if (!view.get_node_address("A") || !view.get_node_address("B")) {
+                    bad.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    for (int round = 0; round < 200; ++round) {
+        view.add_node_to_cluster("C", "localhost:5002");
+        view.remove_node_from_cluster("C");
+    }
+    stop.store(true);
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    EXPECT_EQ(bad.load(), 0);
+    EXPECT_FALSE(view.get_node_address("C").has_value());
+    EXPECT_EQ(view.get_replica_set_for_key("k", 3).size(), 2u);
+}
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <unordered_map>
 #include "ring/consistent_hash_ring.h"
 
@@ -174,3 +175,95 @@ TEST(ConsistentHashRing, KeysDistributeUniformlyAcrossNodes) {
             << node << " is hot: " << count << " keys (expected ~" << expected << ")";
     }
 }
+
+// Removing a node must not disturb keys owned by the others, including nodes
+// added after it, and re-adding a present node is a no-op.
+TEST(ConsistentHashRing, MembershipChangesOnlyMoveAffectedKeys) {
+    ConsistentHashRing ring(100);
+    ring.add_node("A");
+    ring.add_node("B");
+    ring.add_node("C");
+    ring.add_node("B");
+    EXPECT_EQ(ring.size(), 300u);
+
+    const int kKeys = 1000;
+    std::vector<std::string> owners_before;
+    for (int i = 0; i < kKeys; ++i) {
+        owners_before.push_back(ring.get_owner_node("key_" + std::to_string(i)));
+    }
+
+    ring.remove_node("B");
+
+    for (int i = 0; i < kKeys; ++i) {
+        const std::string key = "key_" + std::to_string(i);
+        if (owners_before[static_cast<size_t>(i)] != "B") {
+            EXPECT_EQ(ring.get_owner_node(key), owners_before[static_cast<size_t>(i)]) << key;
+        }
+        auto prefs = ring.get_preference_list(key, 3);
+        ASSERT_EQ(prefs.size(), 2u);
+        EXPECT_NE(prefs[0], prefs[1]);
+    }
+}
+
+// The precomputed table must agree with a plain ring walk, and requests wider
+// than the table fall back to walking.
+TEST(ConsistentHashRing, PrecomputedPreferencesMatchRingWalk) {
+    ConsistentHashRing narrow(64, 2);
+    ConsistentHashRing wide(64, 5);
+    for (const char* node : {"A", "B", "C", "D", "E"}) {
+        narrow.add_node(node);
+        wide.add_node(node);
+    }
+    narrow.remove_node("C");
+    wide.remove_node("C");
+    EXPECT_EQ(narrow.precomputed_replicas(), 2u);
+    EXPECT_EQ(wide.precomputed_replicas(), 4u);
+
+    for (int i = 0; i < 500; ++i) {
+        const std::string key = "key_" + std::to_string(i);
+        auto full = wide.get_preference_list(key, 4);
+        ASSERT_EQ(full.size(), 4u);
+        EXPECT_EQ(narrow.get_preference_list(key, 4), full) << key;
+
+        auto slots = narrow.preference_slots(key, 3);
+        ASSERT_EQ(slots.size(), 2u);
+        EXPECT_EQ(narrow.node_id(slots[0]), full[0]);
+        EXPECT_EQ(narrow.node_id(slots[1]), full[1]);
+    }
+}
+
+// A node's ranges hold exactly the keys whose preference lists include it,
+// each with that preference list.
+TEST(ConsistentHashRing, RangesForMatchPreferenceLists) {
+    ConsistentHashRing ring(32, 2);
+    for (const char* node : {"A", "B", "C", "D"}) {
+        ring.add_node(node);
+    }
+    for (size_t rf : {2u, 3u}) {
+        auto ranges = ring.ranges_for("B", rf);
+        ASSERT_FALSE(ranges.empty());
+        for (size_t i = 1; i < ranges.size(); ++i) {
+            EXPECT_LT(ranges[i - 1].end, ranges[i].end);
+        }
+
+        for (int i = 0; i < 500; ++i) {
+            const std::string key = "key_" + std::to_string(i);
+            const uint64_t token = ConsistentHashRing::token(key);
+            auto prefs = ring.get_preference_list(key, rf);
+            const bool replica = std::find(prefs.begin(), prefs.end(), "B") != prefs.end();
+
+            size_t holding = 0;
+            for (const auto& range : ranges) {
+                const bool inside = range.start < range.end
+                    ? token > range.start && token <= range.end
+                    : token > range.start || token <= range.end;
+                if (inside) {
+                    holding++;
+                    EXPECT_EQ(range.replicas, prefs) << key;
+                }
+            }
+            EXPECT_EQ(holding, replica ? 1u : 0u) << key;
+        }
+    }
+    EXPECT_TRUE(ring.ranges_for("Z", 2).empty());
+}
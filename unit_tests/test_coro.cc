@@ -0,0 +1,284 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "cluster/cluster_view.h"
+#include "node/coro.h"
+
+using kv::node::coro::Quorum;
+using kv::node::coro::Task;
+using kv::node::coro::WorkerPool;
+using kv::node::coro::spawn;
+
+namespace {
+
+Task<int> value_of(int v) {
+    co_return v;
+}
+
+Task<int> sum_of(int a, int b) {
+    int x = co_await value_of(a);
+    int y = co_await value_of(b);
+    co_return x + y;
+}
+
+Task<int> throws() {
+    throw std::runtime_error("boom");
+    co_return 0;
+}
+
+Task<std::vector<int>> wait_for(std::shared_ptr<Quorum<int>> quorum) {
+    co_return co_await quorum->wait();
+}
+
+std::shared_ptr<Quorum<int>> positive_quorum(size_t n, bool fail_fast = false) {
+    return std::make_shared<Quorum<int>>(n, [](const int& v) { return v > 0; }, fail_fast);
+}
+
+// Drains a completion queue on its own thread, like Node's poller.
+struct Poller {
+    grpc::CompletionQueue cq;
+    std::thread thread{[this] {
+        void* tag = nullptr;
+        bool ok = false;
+        while (cq.Next(&tag, &ok)) {
+            auto* call = static_cast<kv::node::coro::AsyncCall*>(tag);
+            call->on_complete();
+            delete call;
+        }
+    }};
+
+    ~Poller() {
+        cq.Shutdown();
+        thread.join();
+    }
+};
+
+}  // namespace
+
+TEST(Coro, TasksRunSynchronouslyUntilTheySuspend) {
+    std::optional<int> result;
+    spawn(sum_of(2, 3), [&](int v) { result = v; });
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(*result, 5);
+}
+
+TEST(Coro, ExceptionsPropagateToTheAwaiter) {
+    auto catcher = [](Task<int> task) -> Task<bool> {
+        try {
+            co_await std::move(task);
+        } catch (const std::runtime_error&) {
+            co_return true;
+        }
+        co_return false;
+    };
+    bool caught = false;
+    spawn(catcher(throws()), [&](bool v) { caught = v; });
+    EXPECT_TRUE(caught);
+}
+
+TEST(Coro, QuorumResumesAtNAcceptedAndPassesStragglersToOnLate) {
+    auto quorum = positive_quorum(2);
+    quorum->expect(4);
+
+    std::optional<std::vector<int>> result;
+    spawn(wait_for(quorum), [&](std::vector<int> v) { result = std::move(v); });
+
+    quorum->complete(0);  // not accepted
+    quorum->complete(7);
+    EXPECT_FALSE(result.has_value());
+    quorum->complete(9);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(*result, (std::vector<int>{0, 7, 9}));
+
+    std::vector<int> late;
+    quorum->on_late([&](int v) { late.push_back(v); });
+    quorum->complete(3);
+    EXPECT_EQ(late, (std::vector<int>{3}));
+    EXPECT_EQ(quorum->outstanding(), 0u);
+}
+
+TEST(Coro, QuorumNeverResumesBeforeItIsAwaited) {
+    // Results recorded before the wait (e.g. the coordinator's local
+    // apply) count toward it, but nothing resumes until then.
+    auto quorum = positive_quorum(2);
+    quorum->add(1);
+    quorum->add(1);
+
+    std::optional<std::vector<int>> result;
+    spawn(wait_for(quorum), [&](std::vector<int> v) { result = std::move(v); });
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->size(), 2u);
+}
+
+TEST(Coro, QuorumWaitsForEveryOperationWhenNIsOutOfReach) {
+    auto quorum = positive_quorum(3);
+    quorum->expect(3);
+
+    std::optional<std::vector<int>> result;
+    spawn(wait_for(quorum), [&](std::vector<int> v) { result = std::move(v); });
+
+    quorum->complete(0);
+    quorum->complete(0);
+    EXPECT_FALSE(result.has_value());
+    quorum->complete(5);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->size(), 3u);
+}
+
+TEST(Coro, FailFastQuorumGivesUpOnceNIsOutOfReach) {
+    auto quorum = positive_quorum(2, true);
+    quorum->expect(3);
+
+    std::optional<std::vector<int>> result;
+    spawn(wait_for(quorum), [&](std::vector<int> v) { result = std::move(v); });
+
+    quorum->complete(0);
+    EXPECT_FALSE(result.has_value());
+    quorum->complete(0);  // one left, two needed
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->size(), 2u);
+}
+
+TEST(Coro, WhenNOfStartsEveryTask) {
+    std::vector<Task<int>> tasks;
+    tasks.push_back(value_of(1));
+    tasks.push_back(value_of(0));
+    tasks.push_back(value_of(2));
+    auto quorum = kv::node::coro::when_n_of<int>(2, std::move(tasks),
+                                                 [](const int& v) { return v > 0; });
+    EXPECT_EQ(quorum->outstanding(), 0u);
+
+    std::optional<std::vector<int>> result;
+    spawn(wait_for(quorum), [&](std::vector<int> v) { result = std::move(v); });
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(*result, (std::vector<int>{1, 0, 2}));
+}
+
+TEST(Coro, WaitUntilResumesAtTheDeadline) {
+    Poller poller;
+    auto quorum = positive_quorum(1);
+    quorum->expect();
+
+    std::atomic<bool> done{false};
+    auto waiter = [](std::shared_ptr<Quorum<int>> q, grpc::CompletionQueue* cq) -> Task<size_t> {
+        auto results = co_await q->wait_until(
+            cq, std::chrono::system_clock::now() + std::chrono::milliseconds(20));
+        co_return results.size();
+    };
+    size_t received = 99;
+    spawn(waiter(quorum, &poller.cq), [&](size_t n) {
+        received = n;
+        done = true;
+    });
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!done && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(done);
+    EXPECT_EQ(received, 0u);
+    EXPECT_TRUE(quorum->expired());
+
+    // The operation still completes later; nothing waits for it.
+    quorum->complete(1);
+    EXPECT_EQ(quorum->outstanding(), 0u);
+}
+
+TEST(Coro, WaitUntilIsCancelledByAnEarlyResult) {
+    Poller poller;
+    auto quorum = positive_quorum(1);
+    quorum->expect();
+
+    std::optional<size_t> received;
+    auto waiter = [](std::shared_ptr<Quorum<int>> q, grpc::CompletionQueue* cq) -> Task<size_t> {
+        auto results = co_await q->wait_until(cq, std::chrono::system_clock::now() + std::chrono::hours(1));
+        co_return results.size();
+    };
+    spawn(waiter(quorum, &poller.cq), [&](size_t n) { received = n; });
+
+    quorum->complete(1);
+    ASSERT_TRUE(received.has_value());
+    EXPECT_EQ(*received, 1u);
+    EXPECT_FALSE(quorum->expired());
+    // ~Poller returns promptly only because the hour-long alarm was cancelled.
+}
+
+TEST(Coro, ReadyByTimesOutWithoutEndingTheWait) {
+    Poller poller;
+    auto quorum = positive_quorum(1);
+    quorum->expect();
+
+    std::atomic<int> stage{0};
+    std::optional<std::vector<int>> result;
+    auto hedger = [](std::shared_ptr<Quorum<int>> q, grpc::CompletionQueue* cq,
+                     std::atomic<int>* step) -> Task<std::vector<int>> {
+        bool ready = co_await q->ready_by(
+            cq, std::chrono::system_clock::now() + std::chrono::milliseconds(10));
+        q->expect();  // e.g. a hedge
+        *step = ready ? -1 : 1;
+        co_return co_await q->wait();
+    };
+    spawn(hedger(quorum, &poller.cq, &stage), [&](std::vector<int> v) {
+        result = std::move(v);
+        stage = 2;
+    });
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (stage == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(stage, 1);
+    quorum->complete(5);
+    ASSERT_EQ(stage, 2);
+    EXPECT_EQ(*result, (std::vector<int>{5}));
+    quorum->complete(0);  // the slower of the two arrives late
+    EXPECT_EQ(quorum->outstanding(), 0u);
+}
+
+TEST(Coro, UnaryCallWithoutAChannelFailsWithoutSuspending) {
+    kv::cluster::ClusterView view;
+    kv::node::ChannelPool pool(view, 1, kv::node::ChannelSelection::RoundRobin);
+    grpc::CompletionQueue cq;
+
+    auto call = [](kv::node::ChannelPool& p, grpc::CompletionQueue* q) -> Task<grpc::StatusCode> {
+        kvstore::GetRequest request;
+        auto result = co_await kv::node::coro::unary_call(
+            p.acquire("ghost"), &kvstore::KeyValue::Stub::PrepareAsyncGet, request, q);
+        co_return result.status.error_code();
+    };
+    std::optional<grpc::StatusCode> code;
+    spawn(call(pool, &cq), [&](grpc::StatusCode c) { code = c; });
+    ASSERT_TRUE(code.has_value());
+    EXPECT_EQ(*code, grpc::StatusCode::UNAVAILABLE);
+    cq.Shutdown();
+}
+
+// Blocking work runs on a worker and the coroutine resumes there, leaving
+// the caller's thread free; a stopped pool runs it inline instead.
+TEST(Coro, WorkerPoolRunsBlockingWorkOffTheCallingThread) {
+    auto on_worker = [](WorkerPool& pool) -> Task<std::thread::id> {
+        auto worker = co_await pool.run([] { return std::this_thread::get_id(); });
+        EXPECT_EQ(worker, std::this_thread::get_id());
+        co_return worker;
+    };
+
+    WorkerPool pool(2);
+    std::promise<std::thread::id> ran;
+    auto ran_on = ran.get_future();
+    spawn(on_worker(pool), [&](std::thread::id id) { ran.set_value(id); });
+    EXPECT_NE(ran_on.get(), std::this_thread::get_id());
+
+    pool.stop();
+    std::optional<std::thread::id> inline_id;
+    spawn(on_worker(pool), [&](std::thread::id id) { inline_id = id; });
+    ASSERT_TRUE(inline_id.has_value());
+    EXPECT_EQ(*inline_id, std::this_thread::get_id());
+}
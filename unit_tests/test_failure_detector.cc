@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "node/failure_detector.h"
+
+using kv::node::FailureDetector;
+using kv::node::FailureDetectorOptions;
+using std::chrono::milliseconds;
+
+namespace {
+
+FailureDetectorOptions options() {
+    FailureDetectorOptions o;
+    o.phi_threshold = 8.0;
+    o.failure_threshold = 3;
+    o.heartbeat_interval = milliseconds(100);
+    o.open_duration = milliseconds(1000);
+    return o;
+}
+
+// Heartbeats `peer` every `interval` for `count` beats, starting at `start`.
+FailureDetector::Clock::time_point beat(FailureDetector& detector, const std::string& peer,
+                                        FailureDetector::Clock::time_point start,
+                                        milliseconds interval, int count) {
+    auto now = start;
+    for (int i = 0; i < count; ++i) {
+        EXPECT_TRUE(detector.begin_ping(peer, now));
+        detector.ping_succeeded(peer, now);
+        now += interval;
+    }
+    return now - interval;
+}
+
+}  // namespace
+
+TEST(FailureDetector, UnknownPeersAreAllowed) {
+    FailureDetector detector(options());
+    EXPECT_TRUE(detector.allow("A"));
+    EXPECT_EQ(detector.phi("A"), 0.0);
+    EXPECT_TRUE(detector.down_peers().empty());
+}
+
+TEST(FailureDetector, ConsecutiveFailuresOpenTheCircuit) {
+    FailureDetector detector(options());
+    detector.record_failure("A");
+    detector.record_failure("A");
+    detector.record_success("A");  // resets the run
+    detector.record_failure("A");
+    detector.record_failure("A");
+    EXPECT_TRUE(detector.allow("A"));
+    detector.record_failure("A");
+    EXPECT_FALSE(detector.allow("A"));
+    EXPECT_EQ(detector.down_peers(), (std::vector<std::string>{"A"}));
+}
+
+TEST(FailureDetector, PhiGrowsWithSilence) {
+    FailureDetector detector(options());
+    const auto start = FailureDetector::Clock::now();
+    const auto last = beat(detector, "A", start, milliseconds(100), 20);
+
+    // One interval of silence is unremarkable; twenty is not.
+    EXPECT_LT(detector.phi("A", last + milliseconds(100)), 1.0);
+    EXPECT_TRUE(detector.allow("A", last + milliseconds(100)));
+    EXPECT_GT(detector.phi("A", last + milliseconds(2000)), 8.0);
+    EXPECT_FALSE(detector.allow("A", last + milliseconds(2000)));
+}
+
+TEST(FailureDetector, SilenceCountsFromTheFirstPing) {
+    FailureDetector detector(options());
+    const auto start = FailureDetector::Clock::now();
+    ASSERT_TRUE(detector.begin_ping("A", start));
+    detector.ping_missed("A");
+    // A peer that never answers is judged against the expected interval.
+    EXPECT_TRUE(detector.allow("A", start + milliseconds(500)));
+    EXPECT_FALSE(detector.allow("A", start + milliseconds(2000)));
+}
+
+TEST(FailureDetector, CircuitClosesOnTheFirstHeartbeatAfterOpenDuration) {
+    FailureDetector detector(options());
+    const auto start = FailureDetector::Clock::now();
+    for (int i = 0; i < 3; ++i) {
+        detector.record_failure("A", start);
+    }
+    ASSERT_FALSE(detector.allow("A", start));
+
+    ASSERT_TRUE(detector.begin_ping("A", start + milliseconds(500)));
+    detector.ping_succeeded("A", start + milliseconds(500));
+    EXPECT_FALSE(detector.allow("A", start + milliseconds(500)));
+
+    ASSERT_TRUE(detector.begin_ping("A", start + milliseconds(1100)));
+    detector.ping_succeeded("A", start + milliseconds(1100));
+    EXPECT_TRUE(detector.allow("A", start + milliseconds(1100)));
+}
+
+TEST(FailureDetector, OnePingAtATimeAndMissedPingsAreNotFailures) {
+    FailureDetector detector(options());
+    const auto now = FailureDetector::Clock::now();
+    EXPECT_TRUE(detector.begin_ping("A", now));
+    EXPECT_FALSE(detector.begin_ping("A", now));
+    detector.ping_missed("A");
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(detector.begin_ping("A", now));
+        detector.ping_missed("A");
+    }
+    EXPECT_TRUE(detector.allow("A", now));
+
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(detector.begin_ping("A", now));
+        detector.ping_failed("A", now);
+    }
+    EXPECT_FALSE(detector.allow("A", now));
+}
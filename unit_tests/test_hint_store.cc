@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "node/hint_store.h"
+#include "temp_dir.h"
+
+using kv::node::Hint;
+using kv::node::HintStore;
+using kv::node::ValueRef;
+using kv::node::Version;
+using kv::test::TempDir;
+
+namespace {
+HintStore::Options hint_options(const TempDir& dir) {
+    HintStore::Options opts;
+    opts.dir = dir.path.string();
+    return opts;
+}
+
+Version version_at(uint64_t ts) {
+    return Version{ts, 1};
+}
+
+std::vector<std::string> keys_of(const std::vector<Hint>& hints) {
+    std::vector<std::string> keys;
+    for (const auto& hint : hints) {
+        keys.push_back(hint.key);
+    }
+    return keys;
+}
+
+}  // namespace
+
+TEST(HintStore, QueuesHintsPerTargetInArrivalOrder) {
+    HintStore store(HintStore::Options{});
+    EXPECT_TRUE(store.add("n2", "a", ValueRef("1"), version_at(1)));
+    EXPECT_TRUE(store.add("n3", "b", ValueRef("22"), version_at(2)));
+    EXPECT_TRUE(store.add("n2", "c", ValueRef("333"), version_at(3)));
+
+    EXPECT_EQ(store.targets(), (std::vector<std::string>{"n2", "n3"}));
+    EXPECT_EQ(store.pending(), 3u);
+    EXPECT_EQ(store.pending_bytes(), 9u);
+
+    auto hints = store.peek("n2", 10);
+    EXPECT_EQ(keys_of(hints), (std::vector<std::string>{"a", "c"}));
+    EXPECT_EQ(hints[1].value.view(), "333");
+    EXPECT_EQ(hints[1].version.write_created_at_us, 3u);
+    EXPECT_EQ(keys_of(store.peek("n2", 1)), (std::vector<std::string>{"a"}));
+    EXPECT_TRUE(store.peek("n4", 10).empty());
+
+    store.remove("n2", 1);
+    EXPECT_EQ(keys_of(store.peek("n2", 10)), (std::vector<std::string>{"c"}));
+    store.remove("n2", 5);
+    EXPECT_EQ(store.targets(), (std::vector<std::string>{"n3"}));
+    EXPECT_EQ(store.pending(), 1u);
+    EXPECT_EQ(store.pending_bytes(), 3u);
+}
+
+TEST(HintStore, DropsHintsBeyondTheByteLimit) {
+    HintStore::Options opts;
+    opts.max_bytes = 8;
+    HintStore store(opts);
+    EXPECT_TRUE(store.add("n2", "k1", ValueRef("abcd"), version_at(1)));
+    EXPECT_FALSE(store.add("n2", "k2", ValueRef("abcd"), version_at(2)));
+    EXPECT_EQ(store.pending(), 1u);
+    EXPECT_EQ(store.dropped(), 1u);
+
+    // Delivering frees the room again.
+    store.remove("n2", 1);
+    EXPECT_TRUE(store.add("n2", "k2", ValueRef("abcd"), version_at(2)));
+}
+
+// A batch is logged with one sync; entries past the byte budget are dropped
+// and the rest queue in order and survive a restart.
+TEST(HintStore, BatchAddQueuesWhatFitsAndPersistsIt) {
+    TempDir temp;
+    auto opts = hint_options(temp);
+    opts.max_bytes = 10;
+    {
+        HintStore store(opts);
+        std::vector<Hint> batch{Hint{"k1", ValueRef("abc"), version_at(1)},
+                                Hint{"k2", ValueRef("abc"), version_at(2)},
+                                Hint{"k3", ValueRef("abc"), version_at(3)}};
+        EXPECT_EQ(store.add("n2", std::move(batch)), 2u);
+        EXPECT_EQ(store.pending(), 2u);
+        EXPECT_EQ(store.pending_bytes(), 10u);
+        EXPECT_EQ(store.dropped(), 1u);
+    }
+    HintStore reopened(opts);
+    EXPECT_EQ(keys_of(reopened.peek("n2", 10)), (std::vector<std::string>{"k1", "k2"}));
+}
+
+TEST(HintStore, PendingHintsSurviveARestart) {
+    TempDir temp;
+    {
+        HintStore store(hint_options(temp));
+        store.add("n2", "a", ValueRef("1"), version_at(1));
+        store.add("n2", "b", ValueRef("2"), version_at(2));
+        store.add("n3", "c", ValueRef("3"), version_at(3));
+        store.remove("n3", 1);
+    }
+    HintStore reopened(hint_options(temp));
+    EXPECT_EQ(reopened.targets(), (std::vector<std::string>{"n2"}));
+    auto hints = reopened.peek("n2", 10);
+    EXPECT_EQ(keys_of(hints), (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(hints[1].value.view(), "2");
+    EXPECT_EQ(hints[1].version.write_created_at_us, 2u);
+    EXPECT_EQ(reopened.pending(), 2u);
+}
+
+TEST(HintStore, TargetsAreEscapedOnDisk) {
+    TempDir temp;
+    const std::string target = "rack/1:node%2";
+    {
+        HintStore store(hint_options(temp));
+        store.add(target, "a", ValueRef("1"), version_at(1));
+        store.add("..", "b", ValueRef("2"), version_at(2));
+    }
+    // One flat directory per target.
+    size_t dirs = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(temp.path)) {
+        EXPECT_TRUE(entry.is_directory());
+        dirs++;
+    }
+    EXPECT_EQ(dirs, 2u);
+    HintStore reopened(hint_options(temp));
+    EXPECT_EQ(reopened.targets(), (std::vector<std::string>{"..", target}));
+    EXPECT_EQ(keys_of(reopened.peek(target, 10)), (std::vector<std::string>{"a"}));
+}
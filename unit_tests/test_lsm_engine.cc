@@ -0,0 +1,362 @@
+#include <gtest/gtest.h>
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/bloom_filter.h"
+#include "storage/lsm_engine.h"
+#include "storage/sstable.h"
+#include "storage/storage_engine.h"
+#include "temp_dir.h"
+
+using kv::node::StoreEntry;
+using kv::node::Version;
+using kv::storage::BloomFilter;
+using kv::storage::LsmEngine;
+using kv::storage::StorageEngineKind;
+using kv::storage::StorageEngineOptions;
+using kv::test::TempDir;
+
+namespace {
+StorageEngineOptions lsm_options(const TempDir& dir) {
+    StorageEngineOptions options;
+    options.kind = StorageEngineKind::Lsm;
+    options.data_dir = dir.path.string();
+    options.wal_sync_mode = kv::storage::WalSyncMode::None;
+    options.lsm_memtable_bytes = 16 << 10;  // flush every few hundred small puts
+    options.lsm_compaction_trigger = 3;
+    return options;
+}
+
+std::string key_of(int i) {
+    return "key_" + std::to_string(i);
+}
+}  // namespace
+
+TEST(BloomFilter, NoFalseNegatives) {
+    BloomFilter filter(1000);
+    for (int i = 0; i < 1000; ++i) {
+        filter.add(BloomFilter::hash(key_of(i)));
+    }
+    auto restored = BloomFilter::from_bytes(filter.data());
+    size_t false_positives = 0;
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(restored.may_contain(BloomFilter::hash(key_of(i))));
+        false_positives += restored.may_contain(BloomFilter::hash("absent_" + std::to_string(i)));
+    }
+    EXPECT_LT(false_positives, 50u);
+}
+
+TEST(SSTable, RoundTripAndPointLookups) {
+    TempDir dir;
+    auto path = (dir.path / "sst-0000000000000001.sst").string();
+
+    // Zero-padded keys keep lexical order equal to numeric order.
+    std::vector<std::string> keys;
+    for (int i = 0; i < 3000; ++i) {
+        char key[16];
+        std::snprintf(key, sizeof(key), "k%06d", i);
+        keys.emplace_back(key);
+    }
+    {
+        kv::storage::SSTableBuilder builder(path, keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            builder.add(keys[i], StoreEntry{"value_" + keys[i], Version{i + 1, 9}});
+        }
+        builder.finish();
+    }
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+
+    auto table = kv::storage::SSTable::open(path, 1);
+    EXPECT_EQ(table->records(), keys.size());
+    for (size_t i = 0; i < keys.size(); i += 97) {
+        auto entry = table->get(keys[i]);
+        ASSERT_TRUE(entry.has_value()) << keys[i];
+        EXPECT_EQ(entry->value, "value_" + keys[i]);
+        EXPECT_EQ(entry->version.write_created_at_us, i + 1);
+        EXPECT_EQ(entry->version.writer, 9u);
+    }
+    EXPECT_FALSE(table->get("k9999999").has_value());
+    EXPECT_FALSE(table->get("a").has_value());
+
+    size_t scanned = 0;
+    for (kv::storage::SSTable::Cursor cursor(*table); cursor.valid(); cursor.next()) {
+        ASSERT_LT(scanned, keys.size());
+        EXPECT_EQ(cursor.key(), keys[scanned]);
+        scanned++;
+    }
+    EXPECT_EQ(scanned, keys.size());
+}
+
+TEST(SSTable, CorruptBlockThrowsInsteadOfReadingAsMissing) {
+    TempDir dir;
+    auto path = (dir.path / "sst-0000000000000001.sst").string();
+    {
+        kv::storage::SSTableBuilder builder(path, 2);
+        builder.add("a", StoreEntry{"value_a", Version{1, 1}});
+        builder.add("b", StoreEntry{"value_b", Version{2, 1}});
+        builder.finish();
+    }
+    {
+        // The first data block starts at offset 0; flip a byte of its first key.
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(20);
+        file.put('z');
+    }
+
+    auto table = kv::storage::SSTable::open(path, 1);
+    EXPECT_THROW(table->get("a"), kv::storage::StorageError);
+    EXPECT_THROW(kv::storage::SSTable::Cursor cursor(*table), kv::storage::StorageError);
+}
+
+// The index and bloom filter are checked on open, and footer lengths that
+// would run past the file are rejected however large they are.
+TEST(SSTable, CorruptIndexOrFilterFailsOpen) {
+    TempDir dir;
+    auto path = (dir.path / "sst-0000000000000001.sst").string();
+    auto build = [&] {
+        kv::storage::SSTableBuilder builder(path, 2);
+        builder.add("a", StoreEntry{"value_a", Version{1, 1}});
+        builder.add("b", StoreEntry{"value_b", Version{2, 1}});
+        builder.finish();
+    };
+    // Footer: index offset, index length, bloom offset, bloom length,
+    // records, checksums, magic.
+    constexpr std::streamoff footer = 7 * sizeof(uint64_t);
+    auto overwrite = [&](std::streamoff from_end, const std::string& bytes) {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-from_end, std::ios::end);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    };
+
+    build();
+    overwrite(footer + 1, "\xff");  // last byte of the bloom filter
+    EXPECT_THROW(kv::storage::SSTable::open(path, 1), std::runtime_error);
+
+    build();
+    uint64_t index_offset = 0;
+    {
+        std::ifstream file(path, std::ios::binary);
+        file.seekg(-footer, std::ios::end);
+        file.read(reinterpret_cast<char*>(&index_offset), sizeof(index_offset));
+    }
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(index_offset) + 4);
+        file.put('z');  // first byte of the first block's last key
+    }
+    EXPECT_THROW(kv::storage::SSTable::open(path, 1), std::runtime_error);
+
+    build();
+    const uint64_t huge = ~0ULL - 8;
+    overwrite(footer - static_cast<std::streamoff>(sizeof(uint64_t)),
+              std::string(reinterpret_cast<const char*>(&huge), sizeof(huge)));
+    EXPECT_THROW(kv::storage::SSTable::open(path, 1), std::runtime_error);
+}
+
+TEST(LsmEngine, ReadsAcrossFlushesAndCompaction) {
+    TempDir dir;
+    LsmEngine engine(lsm_options(dir));
+
+    for (int round = 1; round <= 4; ++round) {
+        for (int i = 0; i < 500; ++i) {
+            auto result = engine.put_if_newer(key_of(i), "r" + std::to_string(round),
+                                              Version{static_cast<uint64_t>(round), 1});
+            EXPECT_TRUE(result.overwritten);
+            EXPECT_FALSE(result.io_error);
+        }
+        EXPECT_TRUE(engine.checkpoint());
+    }
+    // A dozen flushes; size-tiered merges keep only a few tables around.
+    EXPECT_LT(engine.table_count(), 6u);
+
+    for (int i = 0; i < 500; ++i) {
+        auto entry = engine.get(key_of(i));
+        ASSERT_TRUE(entry.has_value());
+        EXPECT_EQ(entry->value, "r4");
+        EXPECT_EQ(entry->version.write_created_at_us, 4u);
+    }
+    EXPECT_FALSE(engine.get("missing").has_value());
+}
+
+// Compaction merges only the newest run of similar-sized tables; a large
+// older table is left alone until as much newer data has piled up.
+TEST(LsmEngine, CompactionLeavesLargerOlderTablesAlone) {
+    TempDir dir;
+    auto options = lsm_options(dir);
+    options.lsm_memtable_bytes = 1 << 20;  // flush only on checkpoint()
+    LsmEngine engine(options);
+
+    for (int i = 0; i < 1000; ++i) {
+        engine.put_if_newer(key_of(i), "big", Version{1, 1});
+    }
+    ASSERT_TRUE(engine.checkpoint());
+    const auto big_table = dir.path / "sst-0000000000000001.sst";
+    const auto big_size = std::filesystem::file_size(big_table);
+
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 10; ++i) {
+            engine.put_if_newer("small_" + std::to_string(round) + "_" + std::to_string(i),
+                                "v", Version{2, 1});
+        }
+        ASSERT_TRUE(engine.checkpoint());
+    }
+    // Compaction runs in the background after the flush.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (engine.table_count() != 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(engine.table_count(), 2u);
+    EXPECT_EQ(std::filesystem::file_size(big_table), big_size);
+    EXPECT_EQ(engine.get(key_of(999))->value, "big");
+    EXPECT_EQ(engine.get("small_0_0")->value, "v");
+    EXPECT_EQ(engine.size(), 1030u);
+}
+
+TEST(LsmEngine, RejectsStaleWritesAgainstFlushedData) {
+    TempDir dir;
+    LsmEngine engine(lsm_options(dir));
+
+    EXPECT_TRUE(engine.put_if_newer("k", "new", Version{10, 1}).overwritten);
+    ASSERT_TRUE(engine.checkpoint());
+
+    auto stale = engine.put_if_newer("k", "old", Version{5, 1});
+    EXPECT_FALSE(stale.overwritten);
+    ASSERT_TRUE(stale.previous.has_value());
+    EXPECT_EQ(stale.previous->write_created_at_us, 10u);
+    EXPECT_EQ(engine.get("k")->value, "new");
+
+    // Same timestamp: the higher writer id wins.
+    EXPECT_TRUE(engine.put_if_newer("k", "tie", Version{10, 2}).overwritten);
+    EXPECT_EQ(engine.get("k")->value, "tie");
+}
+
+TEST(LsmEngine, RestartRecoversTablesAndWalTail) {
+    TempDir dir;
+    {
+        LsmEngine engine(lsm_options(dir));
+        for (int i = 0; i < 2000; ++i) {
+            engine.put_if_newer(key_of(i), "flushed", Version{1, 1});
+        }
+        ASSERT_TRUE(engine.checkpoint());
+        engine.put_if_newer(key_of(0), "tail", Version{2, 1});
+        engine.put_if_newer("only_in_wal", "tail", Version{2, 1});
+    }
+    LsmEngine engine(lsm_options(dir));
+    EXPECT_GE(engine.table_count(), 1u);
+    EXPECT_EQ(engine.get(key_of(0))->value, "tail");
+    EXPECT_EQ(engine.get(key_of(1999))->value, "flushed");
+    EXPECT_EQ(engine.get("only_in_wal")->value, "tail");
+}
+
+// A write whose WAL append fails must not become visible, and once the log
+// has failed later writes are refused before reaching the memtable.
+TEST(LsmEngine, FailedWalAppendLeavesNothingVisible) {
+    TempDir dir;
+    auto options = lsm_options(dir);
+    options.wal_sync_mode = kv::storage::WalSyncMode::Batch;
+    LsmEngine engine(options);
+    EXPECT_TRUE(engine.put_if_newer("k", "old", Version{1, 1}).overwritten);
+
+    // Capping the file size makes the WAL's write() fail with EFBIG.
+    struct rlimit saved {};
+    ASSERT_EQ(::getrlimit(RLIMIT_FSIZE, &saved), 0);
+    auto saved_handler = std::signal(SIGXFSZ, SIG_IGN);
+    struct rlimit capped = saved;
+    capped.rlim_cur = 4096;
+    ASSERT_EQ(::setrlimit(RLIMIT_FSIZE, &capped), 0);
+    auto failed = engine.put_if_newer("k", std::string(8192, 'x'), Version{2, 1});
+    ::setrlimit(RLIMIT_FSIZE, &saved);
+    std::signal(SIGXFSZ, saved_handler);
+
+    EXPECT_TRUE(failed.io_error);
+    EXPECT_FALSE(failed.overwritten);
+    EXPECT_EQ(engine.get("k")->value, "old");
+
+    auto refused = engine.put_if_newer("other", "v", Version{3, 1});
+    EXPECT_TRUE(refused.io_error);
+    EXPECT_FALSE(engine.get("other").has_value());
+}
+
+TEST(LsmEngine, ConcurrentWritersKeepNewestVersion) {
+    TempDir dir;
+    LsmEngine engine(lsm_options(dir));
+
+    std::vector<std::thread> writers;
+    for (uint32_t t = 1; t <= 4; ++t) {
+        writers.emplace_back([&engine, t] {
+            for (uint64_t ts = 1; ts <= 300; ++ts) {
+                engine.put_if_newer(key_of(static_cast<int>(ts % 50)),
+                                    "w" + std::to_string(t), Version{ts, t});
+            }
+        });
+    }
+    for (auto& w : writers) {
+        w.join();
+    }
+    // Key 0 last saw ts=300; the tie across writers goes to writer 4.
+    auto entry = engine.get(key_of(0));
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->version.write_created_at_us, 300u);
+    EXPECT_EQ(entry->value, "w4");
+}
+
+TEST(LsmEngine, ForEachVisitsTheNewestVersionOfEveryKey) {
+    TempDir dir;
+    LsmEngine engine(lsm_options(dir));
+    for (int i = 0; i < 600; ++i) {
+        engine.put_if_newer(key_of(i), "table", Version{1, 1});
+    }
+    ASSERT_TRUE(engine.checkpoint());
+    for (int i = 0; i < 600; i += 3) {
+        engine.put_if_newer(key_of(i), "memtable", Version{2, 1});
+    }
+    engine.put_if_newer("only_in_memtable", "memtable", Version{2, 1});
+
+    std::map<std::string, StoreEntry> seen;
+    engine.for_each([&seen](const std::string& key, const StoreEntry& entry) {
+        EXPECT_TRUE(seen.emplace(key, entry).second) << key << " visited twice";
+    });
+    ASSERT_EQ(seen.size(), 601u);
+    EXPECT_EQ(seen[key_of(0)].value, "memtable");
+    EXPECT_EQ(seen[key_of(1)].value, "table");
+    EXPECT_EQ(seen[key_of(3)].version.write_created_at_us, 2u);
+    EXPECT_EQ(seen["only_in_memtable"].value, "memtable");
+}
+
+TEST(StorageEngine, MemoryEngineForEachVisitsEveryKey) {
+    auto engine = kv::storage::make_storage_engine(StorageEngineOptions{});
+    for (int i = 0; i < 100; ++i) {
+        engine->put_if_newer(key_of(i), "v1", Version{1, 1});
+    }
+    engine->put_if_newer(key_of(7), "v2", Version{2, 1});
+
+    std::map<std::string, StoreEntry> seen;
+    engine->for_each([&seen](const std::string& key, const StoreEntry& entry) {
+        seen.emplace(key, entry);
+    });
+    ASSERT_EQ(seen.size(), 100u);
+    EXPECT_EQ(seen[key_of(7)].value, "v2");
+    EXPECT_EQ(seen[key_of(8)].value, "v1");
+}
+
+TEST(StorageEngine, FactoryParsesKindsAndRejectsLsmWithoutDataDir) {
+    EXPECT_EQ(kv::storage::parse_storage_engine("memory"), StorageEngineKind::Memory);
+    EXPECT_EQ(kv::storage::parse_storage_engine("lsm"), StorageEngineKind::Lsm);
+    EXPECT_FALSE(kv::storage::parse_storage_engine("LSM").has_value());
+
+    StorageEngineOptions options;
+    EXPECT_EQ(kv::storage::make_storage_engine(options)->kind(), StorageEngineKind::Memory);
+
+    options.kind = StorageEngineKind::Lsm;
+    EXPECT_THROW(kv::storage::make_storage_engine(options), std::invalid_argument);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "node/merkle_tree.h"
+#include "ring/consistent_hash_ring.h"
+
+using kv::node::MerkleRanges;
+using kv::node::MerkleTree;
+using kv::node::Version;
+using kv::ring::ConsistentHashRing;
+using kv::ring::TokenRange;
+
+namespace {
+
+constexpr uint64_t MAX_TOKEN = std::numeric_limits<uint64_t>::max();
+
+// Two ranges covering the whole ring, the first wrapping through zero.
+std::vector<TokenRange> halves() {
+    return {TokenRange{MAX_TOKEN / 2, 100, {"a", "b"}},
+            TokenRange{100, MAX_TOKEN / 2, {"b", "c"}}};
+}
+
+}  // namespace
+
+TEST(MerkleTree, LevelsFoldTheLeaves) {
+    MerkleTree tree(3);
+    EXPECT_EQ(tree.leaf_count(), 8u);
+    EXPECT_EQ(tree.level(3).size(), 8u);
+    EXPECT_EQ(tree.level(1).size(), 2u);
+    ASSERT_EQ(tree.level(0).size(), 1u);
+
+    const uint64_t empty_root = tree.level(0)[0];
+    tree.toggle(5, 42);
+    EXPECT_EQ(tree.leaf(5), 42u);
+    EXPECT_NE(tree.level(0)[0], empty_root);
+    // Only the path from leaf 5 to the root changes.
+    MerkleTree other(3);
+    EXPECT_EQ(tree.level(1)[0], other.level(1)[0]);
+    EXPECT_NE(tree.level(1)[1], other.level(1)[1]);
+
+    tree.toggle(5, 42);
+    EXPECT_EQ(tree.level(0)[0], empty_root);
+}
+
+TEST(MerkleTree, EntryHashesDependOnTheVersion) {
+    const uint64_t token = ConsistentHashRing::token("key");
+    EXPECT_EQ(MerkleTree::entry_hash(token, Version{1, 1}), MerkleTree::entry_hash(token, Version{1, 1}));
+    EXPECT_NE(MerkleTree::entry_hash(token, Version{1, 1}), MerkleTree::entry_hash(token, Version{2, 1}));
+    EXPECT_NE(MerkleTree::entry_hash(token, Version{1, 1}), MerkleTree::entry_hash(token, Version{1, 2}));
+    EXPECT_NE(MerkleTree::entry_hash(token, Version{1, 1}),
+              MerkleTree::entry_hash(ConsistentHashRing::token("other"), Version{1, 1}));
+}
+
+TEST(MerkleRanges, FindsTheRangeAndLeafOfAToken) {
+    MerkleRanges trees(halves(), 4);
+    EXPECT_EQ(trees.find(0), 0u);
+    EXPECT_EQ(trees.find(100), 0u);
+    EXPECT_EQ(trees.find(MAX_TOKEN), 0u);
+    EXPECT_EQ(trees.find(101), 1u);
+    EXPECT_EQ(trees.find(MAX_TOKEN / 2), 1u);
+    EXPECT_EQ(trees.find(100, MAX_TOKEN / 2), 1u);
+    EXPECT_FALSE(trees.find(101, MAX_TOKEN / 2).has_value());
+
+    // Leaves split a range evenly, in token order from its start.
+    EXPECT_EQ(trees.leaf_for(1, 101), 0u);
+    EXPECT_EQ(trees.leaf_for(1, MAX_TOKEN / 2), 15u);
+    EXPECT_EQ(trees.leaf_for(1, MAX_TOKEN / 4), 7u);
+    EXPECT_EQ(trees.leaf_for(0, MAX_TOKEN / 2 + 1), 0u);
+    EXPECT_EQ(trees.leaf_for(0, 100), 15u);
+
+    MerkleRanges partial({TokenRange{100, 200, {"a"}}}, 4);
+    EXPECT_FALSE(partial.find(50).has_value());
+    EXPECT_FALSE(partial.find(201).has_value());
+    EXPECT_EQ(partial.find(150), 0u);
+
+    MerkleRanges whole({TokenRange{7, 7, {"a"}}}, 4);
+    EXPECT_EQ(whole.find(7), 0u);
+    EXPECT_EQ(whole.find(8), 0u);
+    EXPECT_EQ(whole.leaf_for(0, 8), 0u);
+    EXPECT_EQ(whole.leaf_for(0, 7), 15u);
+}
+
+TEST(MerkleRanges, TreesMatchWhenTheSameVersionsArrivedInAnyOrder) {
+    MerkleRanges a(halves(), 6);
+    MerkleRanges b(halves(), 6);
+    std::vector<uint64_t> tokens;
+    for (int i = 0; i < 200; ++i) {
+        tokens.push_back(ConsistentHashRing::token("key_" + std::to_string(i)));
+    }
+
+    for (uint64_t token : tokens) {
+        a.update(token, std::nullopt, Version{1, 1});
+    }
+    for (uint64_t token : tokens) {
+        a.update(token, Version{1, 1}, Version{2, 1});
+    }
+    // b sees only the final versions, newest key first.
+    for (auto it = tokens.rbegin(); it != tokens.rend(); ++it) {
+        b.update(*it, std::nullopt, Version{2, 1});
+    }
+    for (size_t r = 0; r < 2; ++r) {
+        EXPECT_EQ(a.tree(r).level(0), b.tree(r).level(0));
+    }
+
+    // One stale key shows up in exactly one leaf.
+    b.update(tokens[17], Version{2, 1}, Version{3, 1});
+    const size_t range = *a.find(tokens[17]);
+    const size_t leaf = a.leaf_for(range, tokens[17]);
+    EXPECT_NE(a.tree(range).level(0), b.tree(range).level(0));
+    const auto la = a.tree(range).level(6);
+    const auto lb = b.tree(range).level(6);
+    for (size_t i = 0; i < la.size(); ++i) {
+        EXPECT_EQ(la[i] != lb[i], i == leaf) << "leaf " << i;
+    }
+}
+
+TEST(MerkleRanges, IgnoresTokensOutsideItsRanges) {
+    MerkleRanges trees({TokenRange{100, 200, {"a"}}}, 2);
+    const auto before = trees.tree(0).level(0);
+    trees.update(300, std::nullopt, Version{1, 1});
+    EXPECT_EQ(trees.tree(0).level(0), before);
+}
@@ -1,17 +1,20 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
 #include <thread>
 #include <vector>
 
 #include "cluster/cluster_view.h"
 #include "node/node.h"
 #include "node/node_config.h"
+#include "temp_dir.h"
 
 using kv::cluster::ClusterView;
 using kv::node::Node;
 using kv::node::StoreEntry;
 using kv::node::Version;
 using kv::NodeConfig;
+using kv::test::TempDir;
 
 namespace {
 struct NodeFixture {
@@ -26,6 +29,10 @@ struct NodeFixture {
         cluster.add_node_to_cluster(config.node_id, "localhost:5000");
     }
 
+    Version version(uint64_t ts, const std::string& writer) {
+        return Version{ts, cluster.intern_writer(writer)};
+    }
+
     static NodeConfig make_config(size_t replication_factor, int write_quorum) {
         NodeConfig cfg;
         cfg.node_id = "nodeA";
@@ -45,7 +52,8 @@ TEST(Node, PutGetSingleNode) {
     auto entry = fixture.node.get("k1");
     ASSERT_TRUE(entry.has_value());
     EXPECT_EQ(entry->value, "v1");
-    EXPECT_EQ(entry->version.writer_id, "nodeA");
+    EXPECT_EQ(entry->version.writer, fixture.node.writer());
+    EXPECT_EQ(fixture.node.writer_name(entry->version.writer), "nodeA");
     EXPECT_GT(entry->version.write_created_at_us, 0u);
 }
 
@@ -65,8 +73,8 @@ TEST(Node, LocalGetMissingReturnsNullopt) {
 TEST(Node, ApplyPutLocalUsesLastWriteWins) {
     NodeFixture fixture(1, 1);
 
-    Version older{100, "writerA"};
-    Version newer{200, "writerB"};
+    Version older = fixture.version(100, "writerA");
+    Version newer = fixture.version(200, "writerB");
 
     EXPECT_TRUE(fixture.node.apply_put_local("k3", "old", older));
     EXPECT_TRUE(fixture.node.apply_put_local("k3", "new", newer));
@@ -75,30 +83,38 @@ TEST(Node, ApplyPutLocalUsesLastWriteWins) {
     ASSERT_TRUE(entry.has_value());
     EXPECT_EQ(entry->value, "new");
     EXPECT_EQ(entry->version.write_created_at_us, 200u);
-    EXPECT_EQ(entry->version.writer_id, "writerB");
+    EXPECT_EQ(entry->version.writer, newer.writer);
 }
 
+// Equal timestamps resolve to the larger interned writer id, whichever order
+// the writes arrive in.
 TEST(Node, ApplyPutLocalTieBreaksByWriterId) {
     NodeFixture fixture(1, 1);
 
-    Version first{100, "A"};
-    Version second{100, "Z"};
-
-    EXPECT_TRUE(fixture.node.apply_put_local("k4", "v_a", first));
-    EXPECT_TRUE(fixture.node.apply_put_local("k4", "v_z", second));
-
-    auto entry = fixture.node.local_get("k4");
-    ASSERT_TRUE(entry.has_value());
-    EXPECT_EQ(entry->value, "v_z");
-    EXPECT_EQ(entry->version.writer_id, "Z");
+    Version a = fixture.version(100, "A");
+    Version z = fixture.version(100, "Z");
+    const Version& winner = a.writer > z.writer ? a : z;
+    const char* winning_value = a.writer > z.writer ? "v_a" : "v_z";
+
+    EXPECT_TRUE(fixture.node.apply_put_local("k4", "v_a", a));
+    EXPECT_TRUE(fixture.node.apply_put_local("k4", "v_z", z));
+    EXPECT_TRUE(fixture.node.apply_put_local("k4b", "v_z", z));
+    EXPECT_TRUE(fixture.node.apply_put_local("k4b", "v_a", a));
+
+    for (const char* key : {"k4", "k4b"}) {
+        auto entry = fixture.node.local_get(key);
+        ASSERT_TRUE(entry.has_value());
+        EXPECT_EQ(entry->value, winning_value);
+        EXPECT_EQ(entry->version.writer, winner.writer);
+    }
 }
 
 // A stale write arriving after a newer one must not overwrite the existing entry.
 TEST(Node, ApplyPutLocalRejectsStaleWrite) {
     NodeFixture fixture(1, 1);
 
-    Version newer{200, "writerA"};
-    Version older{100, "writerB"};
+    Version newer = fixture.version(200, "writerA");
+    Version older = fixture.version(100, "writerB");
 
     EXPECT_TRUE(fixture.node.apply_put_local("k5", "new_value", newer));
     EXPECT_TRUE(fixture.node.apply_put_local("k5", "stale_value", older));
@@ -113,7 +129,7 @@ TEST(Node, ApplyPutLocalRejectsStaleWrite) {
 TEST(Node, ApplyPutLocalSameVersionIsIdempotent) {
     NodeFixture fixture(1, 1);
 
-    Version v{100, "writerA"};
+    Version v = fixture.version(100, "writerA");
 
     EXPECT_TRUE(fixture.node.apply_put_local("k6", "first", v));
     EXPECT_TRUE(fixture.node.apply_put_local("k6", "second", v));
@@ -127,9 +143,9 @@ TEST(Node, ApplyPutLocalSameVersionIsIdempotent) {
 TEST(Node, IsNewerIsTransitive) {
     NodeFixture fixture(1, 1);
 
-    Version a{300, "x"};
-    Version b{200, "x"};
-    Version c{100, "x"};
+    Version a = fixture.version(300, "x");
+    Version b = fixture.version(200, "x");
+    Version c = fixture.version(100, "x");
 
     // Apply c first, then b (b wins), then a (a wins).
     fixture.node.apply_put_local("k7", "c", c);
@@ -218,7 +234,7 @@ TEST(Node, GetOnEmptyClusterReturnsNullopt) {
 TEST(Node, ForwardPutUnknownNodeIncrementsForwardFailureCount) {
     NodeFixture fixture(1, 1);
 
-    Version v{100, "nodeA"};
+    Version v = fixture.version(100, "nodeA");
     bool ok = fixture.node.forward_put("ghost_node", "key", "value", v);
 
     EXPECT_FALSE(ok);
@@ -249,8 +265,8 @@ TEST(Node, ConcurrentApplyPutLocalLWWWins) {
     // Thread i writes timestamp (i+1)*100. Thread kNumThreads-1 holds the max.
     for (int i = 0; i < kNumThreads; ++i) {
         threads.emplace_back([&, i]() {
-            Version v{static_cast<uint64_t>((i + 1) * 100),
-                      "writer_" + std::to_string(i)};
+            Version v = fixture.version(static_cast<uint64_t>((i + 1) * 100),
+                                        "writer_" + std::to_string(i));
             fixture.node.apply_put_local(
                 "contested", "value_" + std::to_string(i), v);
         });
@@ -263,3 +279,104 @@ TEST(Node, ConcurrentApplyPutLocalLWWWins) {
               static_cast<uint64_t>(kNumThreads * 100));
     EXPECT_EQ(entry->value, "value_" + std::to_string(kNumThreads - 1));
 }
+
+// Reads hand out references to the stored buffer instead of copying the value.
+TEST(Node, LocalGetSharesStoredValueBuffer) {
+    NodeFixture fixture(1, 1);
+    kv::node::ValueRef value(std::string(4096, 'x'));
+    ASSERT_TRUE(fixture.node.apply_put_local("big", value, Version{1, 1}));
+
+    auto e1 = fixture.node.local_get("big");
+    auto e2 = fixture.node.local_get("big");
+    ASSERT_TRUE(e1.has_value());
+    ASSERT_TRUE(e2.has_value());
+    EXPECT_TRUE(e1->value.shares_buffer_with(value));
+    EXPECT_TRUE(e2->value.shares_buffer_with(e1->value));
+    EXPECT_EQ(e1->value.size(), 4096u);
+}
+
+// With a data_dir, applied puts survive a restart via WAL replay.
+TEST(Node, RestartRecoversStoreFromWal) {
+    TempDir dir;
+
+    ClusterView cluster(10);
+    cluster.add_node_to_cluster("nodeA", "localhost:5000");
+    NodeConfig cfg = NodeFixture::make_config(1, 1);
+    cfg.data_dir = dir.path.string();
+
+    {
+        Node node(cfg, cluster);
+        EXPECT_TRUE(node.put("k1", "v1"));
+        EXPECT_TRUE(node.put("k1", "v2"));
+        EXPECT_TRUE(node.apply_put_local("k2", "from_peer", Version{5, cluster.intern_writer("B")}));
+    }
+    {
+        Node node(cfg, cluster);
+        auto k1 = node.local_get("k1");
+        ASSERT_TRUE(k1.has_value());
+        EXPECT_EQ(k1->value, "v2");
+        auto k2 = node.local_get("k2");
+        ASSERT_TRUE(k2.has_value());
+        EXPECT_EQ(k2->value, "from_peer");
+        EXPECT_EQ(k2->version.write_created_at_us, 5u);
+    }
+}
+
+// A snapshot replaces the WAL segments it covers; restart loads it and
+// replays only the writes made afterwards.
+TEST(Node, RestartRecoversFromSnapshotAndWalTail) {
+    TempDir dir;
+
+    ClusterView cluster(10);
+    cluster.add_node_to_cluster("nodeA", "localhost:5000");
+    NodeConfig cfg = NodeFixture::make_config(1, 1);
+    cfg.data_dir = dir.path.string();
+
+    {
+        Node node(cfg, cluster);
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_TRUE(node.put("k" + std::to_string(i), "before"));
+        }
+        EXPECT_TRUE(node.checkpoint());
+        EXPECT_TRUE(node.put("k0", "after"));
+        EXPECT_TRUE(node.put("tail", "only_in_wal"));
+    }
+
+    size_t snapshots = 0;
+    for (const auto& file : std::filesystem::directory_iterator(dir.path)) {
+        snapshots += file.path().filename().string().rfind("snapshot-", 0) == 0;
+    }
+    EXPECT_EQ(snapshots, 1u);
+    EXPECT_FALSE(std::filesystem::exists(dir.path / "wal-0000000000000001.log"));
+
+    {
+        Node node(cfg, cluster);
+        EXPECT_EQ(node.local_get("k0")->value, "after");
+        EXPECT_EQ(node.local_get("k99")->value, "before");
+        EXPECT_EQ(node.local_get("tail")->value, "only_in_wal");
+    }
+}
+
+// The lsm engine is a drop-in replacement behind the same Node API.
+TEST(Node, LsmEngineServesPutsAcrossRestart) {
+    TempDir dir;
+
+    ClusterView cluster(10);
+    cluster.add_node_to_cluster("nodeA", "localhost:5000");
+    NodeConfig cfg = NodeFixture::make_config(1, 1);
+    cfg.data_dir = dir.path.string();
+    cfg.storage_engine = kv::storage::StorageEngineKind::Lsm;
+
+    {
+        Node node(cfg, cluster);
+        EXPECT_EQ(node.storage_engine(), kv::storage::StorageEngineKind::Lsm);
+        EXPECT_TRUE(node.put("flushed", "v1"));
+        EXPECT_TRUE(node.checkpoint());
+        EXPECT_TRUE(node.put("tail", "v2"));
+    }
+    {
+        Node node(cfg, cluster);
+        EXPECT_EQ(node.local_get("flushed")->value, "v1");
+        EXPECT_EQ(node.local_get("tail")->value, "v2");
+    }
+}
@@ -74,3 +74,176 @@ TEST(NodeConfig, NegativeWriteQuorumFails) {
     ASSERT_TRUE(cfg.validate().has_value());
     EXPECT_NE(cfg.validate()->find("write_quorum"), std::string::npos);
 }
+
+TEST(NodeConfig, ReadQuorumZeroFails) {
+    auto cfg = valid_config();
+    cfg.read_quorum = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("read_quorum"), std::string::npos);
+}
+
+TEST(NodeConfig, ReadQuorumExceedsReplicationFactorFails) {
+    auto cfg = valid_config();
+    cfg.replication_factor = 2;
+    cfg.read_quorum = 3;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("read_quorum"), std::string::npos);
+}
+
+TEST(NodeConfig, ReadQuorumEqualsReplicationFactorIsValid) {
+    auto cfg = valid_config();
+    cfg.read_quorum = static_cast<int>(cfg.replication_factor);
+    EXPECT_FALSE(cfg.validate().has_value());
+}
+
+TEST(NodeConfig, ReadRepairQueueLimitZeroFails) {
+    auto cfg = valid_config();
+    cfg.read_repair_queue_limit = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("read_repair_queue_limit"), std::string::npos);
+}
+
+TEST(NodeConfig, PeerChannelsZeroFails) {
+    auto cfg = valid_config();
+    cfg.peer_channels = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("peer_channels"), std::string::npos);
+}
+
+TEST(NodeConfig, StoreShardsMustBePowerOfTwo) {
+    auto cfg = valid_config();
+    cfg.store_shards = 12;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("store_shards"), std::string::npos);
+
+    cfg.store_shards = 0;
+    EXPECT_TRUE(cfg.validate().has_value());
+
+    cfg.store_shards = 64;
+    EXPECT_FALSE(cfg.validate().has_value());
+}
+
+TEST(NodeConfig, PeriodicWalSyncNeedsInterval) {
+    auto cfg = valid_config();
+    cfg.wal_sync_mode = kv::storage::WalSyncMode::Periodic;
+    cfg.wal_sync_interval_ms = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("wal_sync_interval_ms"), std::string::npos);
+
+    cfg.wal_sync_mode = kv::storage::WalSyncMode::Batch;
+    EXPECT_FALSE(cfg.validate().has_value());
+}
+
+TEST(NodeConfig, CheckpointsRequireDataDir) {
+    auto cfg = valid_config();
+    cfg.checkpoint_interval_s = 60;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("data_dir"), std::string::npos);
+
+    cfg.data_dir = "/tmp/kv";
+    EXPECT_FALSE(cfg.validate().has_value());
+}
+
+TEST(NodeConfig, LsmEngineRequiresDataDir) {
+    auto cfg = valid_config();
+    cfg.storage_engine = kv::storage::StorageEngineKind::Lsm;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("data_dir"), std::string::npos);
+
+    cfg.data_dir = "/tmp/kv";
+    EXPECT_FALSE(cfg.validate().has_value());
+
+    cfg.lsm_compaction_trigger = 1;
+    EXPECT_TRUE(cfg.validate().has_value());
+}
+
+TEST(NodeConfig, HedgeBudgetOverHundredPercentFails) {
+    auto cfg = valid_config();
+    cfg.hedge_budget_percent = 101;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("hedge_budget_percent"), std::string::npos);
+}
+
+TEST(NodeConfig, HedgingNeedsAPositiveDelay) {
+    auto cfg = valid_config();
+    cfg.read_hedging = true;
+    cfg.hedge_delay_ms = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("hedge_delay_ms"), std::string::npos);
+}
+
+TEST(NodeConfig, ReplicaTimeoutMustLieWithinItsBounds) {
+    auto cfg = valid_config();
+    cfg.replica_timeout_min_ms = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("replica_timeout_min_ms"), std::string::npos);
+
+    cfg = valid_config();
+    cfg.replica_timeout_max_ms = cfg.replica_timeout_min_ms - 1;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("replica_timeout_max_ms"), std::string::npos);
+
+    cfg = valid_config();
+    cfg.replica_timeout_ms = cfg.replica_timeout_max_ms + 1;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("replica_timeout_ms"), std::string::npos);
+}
+
+TEST(NodeConfig, FailureDetectionNeedsPositiveSettings) {
+    auto cfg = valid_config();
+    cfg.heartbeat_interval_ms = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("heartbeat_interval_ms"), std::string::npos);
+    cfg.failure_detection = false;
+    EXPECT_FALSE(cfg.validate().has_value());
+
+    cfg = valid_config();
+    cfg.phi_threshold = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("phi_threshold"), std::string::npos);
+
+    cfg = valid_config();
+    cfg.failure_threshold = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("failure_threshold"), std::string::npos);
+}
+
+TEST(NodeConfig, HintedHandoffNeedsPositiveSettings) {
+    auto cfg = valid_config();
+    cfg.hint_limit_bytes = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("hint_limit_bytes"), std::string::npos);
+    cfg.hinted_handoff = false;
+    EXPECT_FALSE(cfg.validate().has_value());
+
+    cfg = valid_config();
+    cfg.handoff_interval_ms = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("handoff_interval_ms"), std::string::npos);
+
+    cfg = valid_config();
+    cfg.handoff_batch_size = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("handoff_batch_size"), std::string::npos);
+}
+
+TEST(NodeConfig, AntiEntropyNeedsPositiveSettings) {
+    auto cfg = valid_config();
+    cfg.anti_entropy_interval_ms = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("anti_entropy_interval_ms"), std::string::npos);
+    cfg.anti_entropy = false;
+    EXPECT_FALSE(cfg.validate().has_value());
+
+    cfg = valid_config();
+    cfg.anti_entropy_keys_per_sec = 0;
+    ASSERT_TRUE(cfg.validate().has_value());
+    EXPECT_NE(cfg.validate()->find("anti_entropy_keys_per_sec"), std::string::npos);
+
+    for (uint32_t depth : {0u, 17u}) {
+        cfg = valid_config();
+        cfg.merkle_tree_depth = depth;
+        ASSERT_TRUE(cfg.validate().has_value());
+        EXPECT_NE(cfg.validate()->find("merkle_tree_depth"), std::string::npos);
+    }
+}
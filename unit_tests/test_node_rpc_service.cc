@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
 #include <grpcpp/server_context.h>
 
 #include "cluster/cluster_view.h"
@@ -22,7 +26,13 @@ struct ServiceFixture {
                             const std::string& address = "localhost:5000")
         : cluster(10),
           node(make_node(node_id, address, cluster)),
-          service(node) {}
+          service(node) {
+        // Bare writer_id strings must name a known writer; these stand in
+        // for peers the tests write on behalf of.
+        for (const char* writer : {"writerA", "A", "Z"}) {
+            cluster.intern_writer(writer);
+        }
+    }
 
     static Node make_node(const std::string& node_id,
                           const std::string& address,
@@ -67,7 +77,9 @@ TEST(NodeRpcService, InternalPutThenInternalGetReturnsValueAndVersion) {
     EXPECT_TRUE(get_resp.found());
     EXPECT_EQ(get_resp.value(), "v1");
     EXPECT_EQ(get_resp.version().write_created_at_us(), 123u);
-    EXPECT_EQ(get_resp.version().writer_id(), "writerA");
+    // Internal responses carry only the compact writer id.
+    EXPECT_EQ(get_resp.version().writer(), fixture.cluster.intern_writer("writerA"));
+    EXPECT_TRUE(get_resp.version().writer_id().empty());
 }
 
 TEST(NodeRpcService, ExternalPutThenExternalGetReturnsValue) {
@@ -194,7 +206,8 @@ TEST(NodeRpcService, ExternalGetIncludesVersionInResponse) {
     EXPECT_TRUE(fixture.service.Get(&get_ctx, &get, &get_resp).ok());
     ASSERT_TRUE(get_resp.found());
     EXPECT_GT(get_resp.version().write_created_at_us(), 0u);
-    EXPECT_FALSE(get_resp.version().writer_id().empty());
+    EXPECT_EQ(get_resp.version().writer_id(), "nodeA");
+    EXPECT_EQ(get_resp.version().writer(), fixture.node.writer());
 }
 
 // An external GET on a missing key must return found=false via the coordinator path.
@@ -243,6 +256,165 @@ TEST(NodeRpcService, InternalPutTieBreaksByWriterId) {
 
     EXPECT_TRUE(fixture.service.Get(&get_ctx, &get, &get_resp).ok());
     EXPECT_TRUE(get_resp.found());
-    EXPECT_EQ(get_resp.value(), "v_z");
-    EXPECT_EQ(get_resp.version().writer_id(), "Z");
+    uint32_t a = fixture.cluster.intern_writer("A");
+    uint32_t z = fixture.cluster.intern_writer("Z");
+    EXPECT_EQ(get_resp.value(), a > z ? "v_a" : "v_z");
+    EXPECT_EQ(get_resp.version().writer(), std::max(a, z));
+}
+
+TEST(NodeRpcService, InternalMultiPutThenMultiGetIsPositional) {
+    ServiceFixture fixture;
+
+    kvstore::MultiPutRequest put;
+    kvstore::MultiPutResponse put_resp;
+    grpc::ServerContext put_ctx;
+    put.set_is_internal(true);
+    for (int i = 0; i < 3; ++i) {
+        auto* entry = put.add_entries();
+        entry->set_key("k" + std::to_string(i));
+        entry->set_value("v" + std::to_string(i));
+        entry->mutable_version()->set_write_created_at_us(100);
+        entry->mutable_version()->set_writer(7);
+    }
+    ASSERT_TRUE(fixture.service.MultiPut(&put_ctx, &put, &put_resp).ok());
+    ASSERT_EQ(put_resp.results_size(), 3);
+    for (const auto& result : put_resp.results()) {
+        EXPECT_TRUE(result.success());
+    }
+
+    kvstore::MultiGetRequest get;
+    kvstore::MultiGetResponse get_resp;
+    grpc::ServerContext get_ctx;
+    get.set_is_internal(true);
+    get.add_keys("k2");
+    get.add_keys("missing");
+    get.add_keys("k0");
+    ASSERT_TRUE(fixture.service.MultiGet(&get_ctx, &get, &get_resp).ok());
+    ASSERT_EQ(get_resp.results_size(), 3);
+    EXPECT_EQ(get_resp.results(0).value(), "v2");
+    EXPECT_FALSE(get_resp.results(1).found());
+    EXPECT_EQ(get_resp.results(2).value(), "v0");
+    EXPECT_EQ(get_resp.results(2).version().write_created_at_us(), 100u);
+    EXPECT_EQ(get_resp.results(2).version().writer(), 7u);
+}
+
+// An unknown writer_id is rejected, not interned, and nothing is applied.
+TEST(NodeRpcService, InternalWritesFromUnknownWritersAreRejected) {
+    ServiceFixture fixture;
+
+    kvstore::PutRequest put;
+    kvstore::PutResponse put_resp;
+    grpc::ServerContext put_ctx;
+    put.set_key("k6");
+    put.set_value("v6");
+    put.set_is_internal(true);
+    put.mutable_version()->set_write_created_at_us(100);
+    put.mutable_version()->set_writer_id("stranger");
+    auto status = fixture.service.Put(&put_ctx, &put, &put_resp);
+    EXPECT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+    EXPECT_FALSE(fixture.cluster.find_writer("stranger").has_value());
+
+    kvstore::MultiPutRequest multi;
+    kvstore::MultiPutResponse multi_resp;
+    grpc::ServerContext multi_ctx;
+    multi.set_is_internal(true);
+    auto* known = multi.add_entries();
+    known->set_key("k7");
+    known->set_value("v7");
+    known->mutable_version()->set_write_created_at_us(100);
+    known->mutable_version()->set_writer_id("writerA");
+    auto* unknown = multi.add_entries();
+    unknown->set_key("k8");
+    unknown->set_value("v8");
+    unknown->mutable_version()->set_write_created_at_us(100);
+    unknown->mutable_version()->set_writer_id("stranger");
+    status = fixture.service.MultiPut(&multi_ctx, &multi, &multi_resp);
+    EXPECT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+
+    EXPECT_FALSE(fixture.node.local_get("k6").has_value());
+    EXPECT_FALSE(fixture.node.local_get("k7").has_value());
+}
+
+TEST(NodeRpcService, ExternalMultiPutThenMultiGetReturnsWriterIds) {
+    ServiceFixture fixture;
+
+    kvstore::MultiPutRequest put;
+    kvstore::MultiPutResponse put_resp;
+    grpc::ServerContext put_ctx;
+    for (int i = 0; i < 4; ++i) {
+        auto* entry = put.add_entries();
+        entry->set_key("k" + std::to_string(i));
+        entry->set_value("v" + std::to_string(i));
+    }
+    ASSERT_TRUE(fixture.service.MultiPut(&put_ctx, &put, &put_resp).ok());
+    ASSERT_EQ(put_resp.results_size(), 4);
+
+    kvstore::MultiGetRequest get;
+    kvstore::MultiGetResponse get_resp;
+    grpc::ServerContext get_ctx;
+    for (int i = 0; i < 4; ++i) {
+        get.add_keys("k" + std::to_string(i));
+    }
+    ASSERT_TRUE(fixture.service.MultiGet(&get_ctx, &get, &get_resp).ok());
+    ASSERT_EQ(get_resp.results_size(), 4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(put_resp.results(i).success());
+        EXPECT_EQ(get_resp.results(i).value(), "v" + std::to_string(i));
+        EXPECT_EQ(get_resp.results(i).version().writer_id(), "nodeA");
+    }
+}
+
+TEST(NodeRpcService, MerkleLevelAnswersForTheNodesOwnRanges) {
+    ServiceFixture fixture;
+    auto ranges = fixture.cluster.get_token_ranges_for_node("nodeA", 1);
+    ASSERT_FALSE(ranges.empty());
+    const auto& range = ranges.front();
+
+    auto root = [&fixture, &range](uint32_t depth) {
+        kvstore::MerkleLevelRequest req;
+        kvstore::MerkleLevelResponse resp;
+        grpc::ServerContext ctx;
+        req.set_node_id("nodeB");
+        req.set_depth(depth);
+        auto* nodes = req.add_ranges();
+        nodes->set_range_start(range.start);
+        nodes->set_range_end(range.end);
+        nodes->set_level(0);
+        nodes->add_indexes(0);
+        EXPECT_TRUE(fixture.service.MerkleLevel(&ctx, &req, &resp).ok());
+        EXPECT_EQ(resp.ranges_size(), 1);
+        return resp.ranges(0);
+    };
+
+    // The anti-entropy thread builds the trees shortly after startup.
+    NodeConfig defaults;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!root(defaults.merkle_tree_depth).found() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto before = root(defaults.merkle_tree_depth);
+    ASSERT_TRUE(before.found());
+    ASSERT_EQ(before.hashes_size(), 1);
+    EXPECT_FALSE(root(defaults.merkle_tree_depth + 1).found());
+
+    // A write into the range changes its root.
+    std::string key;
+    for (int i = 0; key.empty(); ++i) {
+        std::string candidate = "k" + std::to_string(i);
+        auto token = kv::ring::ConsistentHashRing::token(candidate);
+        if (range.start < range.end ? token > range.start && token <= range.end
+                                    : token > range.start || token <= range.end) {
+            key = candidate;
+        }
+    }
+    kvstore::PutRequest put;
+    kvstore::PutResponse put_resp;
+    grpc::ServerContext put_ctx;
+    put.set_key(key);
+    put.set_value("v");
+    put.set_is_internal(true);
+    put.mutable_version()->set_write_created_at_us(1);
+    put.mutable_version()->set_writer_id("nodeA");
+    ASSERT_TRUE(fixture.service.Put(&put_ctx, &put, &put_resp).ok());
+    EXPECT_NE(root(defaults.merkle_tree_depth).hashes(0), before.hashes(0));
 }
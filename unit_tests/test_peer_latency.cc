@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "node/peer_latency.h"
+
+using kv::node::PeerLatency;
+using std::chrono::microseconds;
+
+TEST(PeerLatency, UnknownOrSparsePeerHasNoQuantile) {
+    PeerLatency latency(512, 16);
+    EXPECT_FALSE(latency.quantile("A", 0.95).has_value());
+
+    for (int i = 0; i < 15; ++i) {
+        latency.record("A", microseconds(100));
+    }
+    EXPECT_FALSE(latency.quantile("A", 0.95).has_value());
+    latency.record("A", microseconds(100));
+    EXPECT_TRUE(latency.quantile("A", 0.95).has_value());
+}
+
+TEST(PeerLatency, QuantilesAreWithinABucketOfTheSamples) {
+    PeerLatency latency;
+    // 90 fast calls, 10 slow ones.
+    for (int i = 0; i < 90; ++i) {
+        latency.record("A", microseconds(1000));
+    }
+    for (int i = 0; i < 10; ++i) {
+        latency.record("A", microseconds(20000));
+    }
+    auto p50 = latency.quantile("A", 0.5);
+    auto p95 = latency.quantile("A", 0.95);
+    ASSERT_TRUE(p50 && p95);
+    EXPECT_GE(p50->count(), 1000);
+    EXPECT_LT(p50->count(), 1200);
+    EXPECT_GE(p95->count(), 20000);
+    EXPECT_LT(p95->count(), 24000);
+}
+
+TEST(PeerLatency, PeersAreTrackedSeparately) {
+    PeerLatency latency(512, 1);
+    latency.record("A", microseconds(50));
+    latency.record("B", microseconds(5000));
+    EXPECT_LT(latency.quantile("A", 0.95)->count(), 100);
+    EXPECT_GE(latency.quantile("B", 0.95)->count(), 5000);
+
+    auto peers = latency.peers();
+    std::sort(peers.begin(), peers.end());
+    EXPECT_EQ(peers, (std::vector<std::string>{"A", "B"}));
+}
+
+TEST(PeerLatency, OldSamplesDecayAway) {
+    PeerLatency latency(64, 1);
+    for (int i = 0; i < 64; ++i) {
+        latency.record("A", microseconds(50000));
+    }
+    // Several windows of fast calls push the old slow ones out of the p95.
+    for (int i = 0; i < 64 * 6; ++i) {
+        latency.record("A", microseconds(500));
+    }
+    EXPECT_LT(latency.quantile("A", 0.95)->count(), 1000);
+}
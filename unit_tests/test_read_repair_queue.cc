@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "node/read_repair_queue.h"
+
+using kv::node::ReadRepairQueue;
+using kv::node::RepairTask;
+using kv::node::StoreEntry;
+using kv::node::Version;
+
+namespace {
+RepairTask make_task(const std::string& replica, const std::string& key,
+                     const std::string& value, uint64_t ts) {
+    return RepairTask{replica, key, StoreEntry{value, Version{ts, 1}}};
+}
+
+// Holds the worker inside its first repair until release() is called, so
+// later enqueues stay pending and can be inspected deterministically.
+struct BlockingRepair {
+    std::mutex mu;
+    std::condition_variable cv;
+    bool started = false;
+    bool released = false;
+    std::vector<RepairTask> applied;
+
+    void operator()(const RepairTask& task) {
+        std::unique_lock<std::mutex> lock(mu);
+        applied.push_back(task);
+        started = true;
+        cv.notify_all();
+        cv.wait(lock, [this] { return released; });
+    }
+
+    void wait_started() {
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [this] { return started; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mu);
+        released = true;
+        cv.notify_all();
+    }
+};
+}  // namespace
+
+TEST(ReadRepairQueue, AppliesQueuedRepairs) {
+    std::mutex mu;
+    std::vector<RepairTask> applied;
+    ReadRepairQueue queue(16, [&](const RepairTask& task) {
+        std::lock_guard<std::mutex> lock(mu);
+        applied.push_back(task);
+    });
+
+    EXPECT_EQ(queue.enqueue(make_task("n1", "k1", "v1", 100)),
+              ReadRepairQueue::EnqueueResult::Queued);
+    EXPECT_EQ(queue.enqueue(make_task("n2", "k1", "v1", 100)),
+              ReadRepairQueue::EnqueueResult::Queued);
+    queue.wait_idle();
+
+    std::lock_guard<std::mutex> lock(mu);
+    ASSERT_EQ(applied.size(), 2u);
+    EXPECT_EQ(applied[0].replica_id, "n1");
+    EXPECT_EQ(applied[1].replica_id, "n2");
+    EXPECT_EQ(queue.depth(), 0u);
+}
+
+// Repeated repairs for the same (replica, key) collapse into one pending task
+// carrying the newest version.
+TEST(ReadRepairQueue, CoalescesSameReplicaAndKeyKeepingNewest) {
+    BlockingRepair repair;
+    ReadRepairQueue queue(16, [&](const RepairTask& task) { repair(task); });
+
+    queue.enqueue(make_task("n0", "busy", "x", 1));
+    repair.wait_started();
+
+    EXPECT_EQ(queue.enqueue(make_task("n1", "k", "v200", 200)),
+              ReadRepairQueue::EnqueueResult::Queued);
+    EXPECT_EQ(queue.enqueue(make_task("n1", "k", "v100", 100)),
+              ReadRepairQueue::EnqueueResult::Coalesced);
+    EXPECT_EQ(queue.enqueue(make_task("n1", "k", "v300", 300)),
+              ReadRepairQueue::EnqueueResult::Coalesced);
+    EXPECT_EQ(queue.depth(), 1u);
+    EXPECT_EQ(queue.coalesced(), 2u);
+
+    repair.release();
+    queue.wait_idle();
+
+    std::lock_guard<std::mutex> lock(repair.mu);
+    ASSERT_EQ(repair.applied.size(), 2u);
+    EXPECT_EQ(repair.applied[1].entry.value, "v300");
+}
+
+TEST(ReadRepairQueue, DropsWhenFull) {
+    BlockingRepair repair;
+    ReadRepairQueue queue(2, [&](const RepairTask& task) { repair(task); });
+
+    queue.enqueue(make_task("n0", "busy", "x", 1));
+    repair.wait_started();
+
+    EXPECT_EQ(queue.enqueue(make_task("n1", "a", "v", 1)),
+              ReadRepairQueue::EnqueueResult::Queued);
+    EXPECT_EQ(queue.enqueue(make_task("n1", "b", "v", 1)),
+              ReadRepairQueue::EnqueueResult::Queued);
+    EXPECT_EQ(queue.enqueue(make_task("n1", "c", "v", 1)),
+              ReadRepairQueue::EnqueueResult::Dropped);
+    EXPECT_EQ(queue.depth(), 2u);
+    EXPECT_EQ(queue.dropped(), 1u);
+
+    repair.release();
+    queue.wait_idle();
+}
+
+TEST(ReadRepairQueue, EnqueueAfterStopIsDropped) {
+    std::atomic<int> applied{0};
+    ReadRepairQueue queue(16, [&](const RepairTask&) { applied++; });
+
+    queue.stop();
+    EXPECT_EQ(queue.enqueue(make_task("n1", "k", "v", 1)),
+              ReadRepairQueue::EnqueueResult::Dropped);
+    EXPECT_EQ(applied.load(), 0);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/sharded_store.h"
+
+using kv::storage::ShardedStore;
+using kv::node::Version;
+
+TEST(ShardedStore, ShardCountRoundsUpToPowerOfTwo) {
+    EXPECT_EQ(ShardedStore(0).shard_count(), 1u);
+    EXPECT_EQ(ShardedStore(1).shard_count(), 1u);
+    EXPECT_EQ(ShardedStore(12).shard_count(), 16u);
+    EXPECT_EQ(ShardedStore(64).shard_count(), 64u);
+}
+
+TEST(ShardedStore, ShardIndexIsDeterministicAndInRange) {
+    ShardedStore store(8);
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "key_" + std::to_string(i);
+        size_t idx = store.shard_index(key);
+        EXPECT_LT(idx, 8u);
+        EXPECT_EQ(idx, store.shard_index(key));
+    }
+}
+
+// Keys should spread over every shard rather than piling onto a few.
+TEST(ShardedStore, KeysSpreadAcrossShards) {
+    ShardedStore store(16);
+    std::vector<int> counts(16, 0);
+    for (int i = 0; i < 16000; ++i) {
+        counts[store.shard_index("key_" + std::to_string(i))]++;
+    }
+    for (int c : counts) {
+        EXPECT_GT(c, 500);
+        EXPECT_LT(c, 1500);
+    }
+}
+
+TEST(ShardedStore, PutIfNewerAppliesLastWriteWins) {
+    ShardedStore store(4);
+
+    auto first = store.put_if_newer("k", "old", Version{100, 1});
+    EXPECT_TRUE(first.overwritten);
+    EXPECT_FALSE(first.previous.has_value());
+
+    auto stale = store.put_if_newer("k", "stale", Version{50, 1});
+    EXPECT_FALSE(stale.overwritten);
+    ASSERT_TRUE(stale.previous.has_value());
+    EXPECT_EQ(stale.previous->write_created_at_us, 100u);
+
+    auto newer = store.put_if_newer("k", "new", Version{200, 1});
+    EXPECT_TRUE(newer.overwritten);
+
+    auto entry = store.get("k");
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->value, "new");
+    EXPECT_EQ(store.size(), 1u);
+}
+
+TEST(ShardedStore, GetMissingReturnsNullopt) {
+    ShardedStore store(4);
+    EXPECT_FALSE(store.get("missing").has_value());
+}
+
+// Writers on disjoint keys across all shards; every key must be readable
+// afterwards. Run with -DENABLE_TSAN=ON to check shard locking.
+TEST(ShardedStore, ConcurrentWritersOnDisjointKeys) {
+    ShardedStore store(8);
+    constexpr int kThreads = 8;
+    constexpr int kKeysPerThread = 500;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < kKeysPerThread; ++i) {
+                std::string key = "t" + std::to_string(t) + "_" + std::to_string(i);
+                store.put_if_newer(key, key, Version{1, 1});
+                EXPECT_TRUE(store.get(key).has_value());
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(store.size(), static_cast<size_t>(kThreads * kKeysPerThread));
+}
+
+// A single shard must keep every key reachable while its table grows.
+TEST(ShardedStore, SingleShardGrowsPastInitialBuckets) {
+    ShardedStore store(1);
+    for (int i = 0; i < 5000; ++i) {
+        std::string key = "key_" + std::to_string(i);
+        store.put_if_newer(key, key, Version{1, 1});
+    }
+    EXPECT_EQ(store.size(), 5000u);
+    for (int i = 0; i < 5000; ++i) {
+        std::string key = "key_" + std::to_string(i);
+        auto entry = store.get(key);
+        ASSERT_TRUE(entry.has_value()) << key;
+        EXPECT_EQ(entry->value, key);
+    }
+}
+
+// Lock-free readers racing writers that overwrite the same keys and grow the
+// table must only ever see complete entries whose value matches its version.
+TEST(ShardedStore, ReadersSeeConsistentEntriesDuringWrites) {
+    ShardedStore store(2);
+    constexpr int kKeys = 64;
+    constexpr uint64_t kRounds = 200;
+    for (int i = 0; i < kKeys; ++i) {
+        store.put_if_newer("k" + std::to_string(i), "0", Version{0, 1});
+    }
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            while (!done.load()) {
+                for (int i = 0; i < kKeys; ++i) {
+                    auto entry = store.get("k" + std::to_string(i));
+                    ASSERT_TRUE(entry.has_value());
+                    EXPECT_EQ(entry->value, std::to_string(entry->version.write_created_at_us));
+                }
+            }
+        });
+    }
+
+    std::thread writer([&]() {
+        for (uint64_t round = 1; round <= kRounds; ++round) {
+            for (int i = 0; i < kKeys; ++i) {
+                store.put_if_newer("k" + std::to_string(i), std::to_string(round),
+                                   Version{round, 1});
+            }
+            // Fresh keys force table growth while readers are active.
+            store.put_if_newer("grow_" + std::to_string(round), "x", Version{1, 1});
+        }
+    });
+    writer.join();
+    done.store(true);
+    for (auto& t : readers) t.join();
+
+    for (int i = 0; i < kKeys; ++i) {
+        EXPECT_EQ(store.get("k" + std::to_string(i))->value, std::to_string(kRounds));
+    }
+}
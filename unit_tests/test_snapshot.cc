@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/memory_engine.h"
+#include "storage/sharded_store.h"
+#include "storage/snapshot.h"
+#include "temp_dir.h"
+
+using kv::node::Version;
+using kv::storage::ShardedStore;
+using kv::test::TempDir;
+
+TEST(Snapshot, RoundTripAcrossShards) {
+    ShardedStore source(8);
+    for (int i = 0; i < 2000; ++i) {
+        std::string key = "key_" + std::to_string(i);
+        source.put_if_newer(key, "value_" + std::to_string(i),
+                            Version{static_cast<uint64_t>(i), 7});
+    }
+    TempDir dir;
+    auto path = dir.path / "roundtrip.bin";
+
+    auto written = kv::storage::write_snapshot(path.string(), source, 42);
+    EXPECT_EQ(written.records, 2000u);
+    EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+    // A different shard count on load still lands every key.
+    ShardedStore target(4);
+    auto loaded = kv::storage::load_snapshot(path.string(), target, 4);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->wal_segment, 42u);
+    EXPECT_EQ(loaded->records, 2000u);
+    EXPECT_EQ(target.size(), 2000u);
+    auto entry = target.get("key_1234");
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->value, "value_1234");
+    EXPECT_EQ(entry->version.write_created_at_us, 1234u);
+    EXPECT_EQ(entry->version.writer, 7u);
+}
+
+TEST(Snapshot, MissingOrGarbageFileIsRejected) {
+    TempDir dir;
+    ShardedStore store(2);
+    EXPECT_FALSE(kv::storage::load_snapshot((dir.path / "missing.bin").string(), store, 2));
+
+    auto path = dir.path / "garbage.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << std::string(256, 'z');
+    }
+    EXPECT_FALSE(kv::storage::load_snapshot(path.string(), store, 2));
+    EXPECT_EQ(store.size(), 0u);
+}
+
+// Flipping a byte in the last section fails the whole load: the WAL segments
+// the snapshot covers are gone, so its records cannot be recovered elsewhere.
+TEST(Snapshot, CorruptSectionFailsTheLoad) {
+    ShardedStore source(2);
+    for (int i = 0; i < 200; ++i) {
+        source.put_if_newer("key_" + std::to_string(i), "v", Version{1, 1});
+    }
+    TempDir dir;
+    auto path = dir.path / "corrupt.bin";
+    kv::storage::write_snapshot(path.string(), source, 1);
+
+    {
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(-1, std::ios::end);
+        f.put('#');
+    }
+
+    ShardedStore target(2);
+    EXPECT_FALSE(kv::storage::load_snapshot(path.string(), target, 2).has_value());
+}
+
+TEST(Snapshot, MemoryEngineRefusesToStartFromACorruptSnapshot) {
+    TempDir dir;
+    kv::storage::StorageEngineOptions options;
+    options.data_dir = dir.path.string();
+    options.wal_sync_mode = kv::storage::WalSyncMode::None;
+    {
+        kv::storage::MemoryEngine engine(options);
+        for (int i = 0; i < 200; ++i) {
+            engine.put_if_newer("key_" + std::to_string(i), "v", Version{1, 1});
+        }
+        ASSERT_TRUE(engine.checkpoint());
+    }
+    for (const auto& file : std::filesystem::directory_iterator(dir.path)) {
+        if (file.path().extension() == ".bin") {
+            std::fstream f(file.path(), std::ios::binary | std::ios::in | std::ios::out);
+            f.seekp(-1, std::ios::end);
+            f.put('#');
+        }
+    }
+    EXPECT_THROW(kv::storage::MemoryEngine engine(options), std::runtime_error);
+}
+
+// Writes whose fsync is still in flight when a checkpoint rotates the WAL
+// must be in that snapshot, since the segments they were logged to go away.
+TEST(Snapshot, CheckpointDuringConcurrentWritesLosesNothing) {
+    TempDir dir;
+    kv::storage::StorageEngineOptions options;
+    options.data_dir = dir.path.string();
+    options.wal_sync_mode = kv::storage::WalSyncMode::Batch;
+    options.memory_shards = 2;
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 300;
+    {
+        kv::storage::MemoryEngine engine(options);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < kThreads; ++t) {
+            writers.emplace_back([&engine, t] {
+                for (int i = 0; i < kPerThread; ++i) {
+                    auto key = "t" + std::to_string(t) + "_" + std::to_string(i);
+                    EXPECT_TRUE(engine.put_if_newer(key, "v", Version{1, 1}).overwritten);
+                }
+            });
+        }
+        for (int i = 0; i < 5; ++i) {
+            EXPECT_TRUE(engine.checkpoint());
+        }
+        for (auto& w : writers) {
+            w.join();
+        }
+        EXPECT_TRUE(engine.checkpoint());
+    }
+    kv::storage::MemoryEngine engine(options);
+    EXPECT_EQ(engine.size(), static_cast<size_t>(kThreads * kPerThread));
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/wal.h"
+#include "temp_dir.h"
+
+using kv::node::ValueRef;
+using kv::node::Version;
+using kv::storage::WalSyncMode;
+using kv::storage::WriteAheadLog;
+using kv::test::TempDir;
+
+namespace {
+WriteAheadLog::Options wal_options(const TempDir& dir, WalSyncMode mode = WalSyncMode::Batch) {
+    WriteAheadLog::Options opts;
+    opts.dir = dir.path.string();
+    opts.sync_mode = mode;
+    opts.sync_interval = std::chrono::milliseconds(5);
+    return opts;
+}
+
+struct Record {
+    std::string value;
+    Version version;
+};
+
+std::map<std::string, Record> replay(const TempDir& log) {
+    std::map<std::string, Record> out;
+    WriteAheadLog wal(wal_options(log), [&](const std::string& key, ValueRef value,
+                                         const Version& version) {
+        out[key] = Record{value.str(), version};
+    });
+    return out;
+}
+}  // namespace
+
+TEST(WriteAheadLog, AppendedRecordsReplayAfterReopen) {
+    TempDir log;
+    {
+        WriteAheadLog wal(wal_options(log), [](auto&&...) {});
+        EXPECT_EQ(wal.replayed_records(), 0u);
+        EXPECT_TRUE(wal.append("a", "1", Version{10, 7}));
+        EXPECT_TRUE(wal.append("b", std::string(5000, 'x'), Version{20, 8}));
+        EXPECT_TRUE(wal.append("empty", "", Version{30, 9}));
+    }
+
+    auto records = replay(log);
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records["a"].value, "1");
+    EXPECT_EQ(records["a"].version.write_created_at_us, 10u);
+    EXPECT_EQ(records["a"].version.writer, 7u);
+    EXPECT_EQ(records["b"].value.size(), 5000u);
+    EXPECT_EQ(records["empty"].value, "");
+}
+
+// A crash mid-write leaves a partial record; it is dropped, and records
+// appended after reopening are not hidden behind it.
+TEST(WriteAheadLog, TornTailIsTruncatedOnOpen) {
+    TempDir log;
+    {
+        WriteAheadLog wal(wal_options(log), [](auto&&...) {});
+        EXPECT_TRUE(wal.append("a", "1", Version{10, 1}));
+    }
+    {
+        std::ofstream out(log.path / "wal-0000000000000001.log", std::ios::binary | std::ios::app);
+        out.write("\x40\x00\x00\x00garbage", 11);
+    }
+    {
+        WriteAheadLog wal(wal_options(log), [](auto&&...) {});
+        EXPECT_EQ(wal.replayed_records(), 1u);
+        EXPECT_TRUE(wal.append("b", "2", Version{20, 1}));
+    }
+
+    auto records = replay(log);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records["b"].value, "2");
+}
+
+// Only the newest segment may end in a torn record; a bad record in an older
+// one would hide acknowledged writes, so the log refuses to open.
+TEST(WriteAheadLog, CorruptOlderSegmentFailsOpen) {
+    TempDir log;
+    {
+        WriteAheadLog wal(wal_options(log), [](auto&&...) {});
+        EXPECT_TRUE(wal.append("a", "1", Version{10, 1}));
+        EXPECT_EQ(wal.rotate(), 2u);
+        EXPECT_TRUE(wal.append("b", "2", Version{20, 1}));
+    }
+    {
+        std::ofstream out(log.path / "wal-0000000000000001.log", std::ios::binary | std::ios::app);
+        out.write("\x40\x00\x00\x00garbage", 11);
+    }
+    EXPECT_THROW(WriteAheadLog(wal_options(log), [](auto&&...) {}), std::runtime_error);
+    EXPECT_GT(std::filesystem::file_size(log.path / "wal-0000000000000001.log"), 11u);
+}
+
+// Concurrent writers in batch mode share fsyncs; every acknowledged record
+// must be on disk.
+TEST(WriteAheadLog, GroupCommitCoversConcurrentWriters) {
+    TempDir log;
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 50;
+    uint64_t syncs = 0;
+    {
+        WriteAheadLog wal(wal_options(log, WalSyncMode::Batch), [](auto&&...) {});
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < kPerThread; ++i) {
+                    std::string key = "t" + std::to_string(t) + "_" + std::to_string(i);
+                    EXPECT_TRUE(wal.append(key, key, Version{1, 1}));
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        syncs = wal.syncs();
+    }
+
+    EXPECT_GE(syncs, 1u);
+    EXPECT_LE(syncs, static_cast<uint64_t>(kThreads * kPerThread));
+    EXPECT_EQ(replay(log).size(), static_cast<size_t>(kThreads * kPerThread));
+}
+
+TEST(WriteAheadLog, NonBlockingModesPersistOnSyncAndClose) {
+    for (auto mode : {WalSyncMode::None, WalSyncMode::Periodic}) {
+        TempDir log;
+        {
+            WriteAheadLog wal(wal_options(log, mode), [](auto&&...) {});
+            for (int i = 0; i < 100; ++i) {
+                EXPECT_TRUE(wal.append("k" + std::to_string(i), "v", Version{1, 1}));
+            }
+            EXPECT_TRUE(wal.sync());
+        }
+        EXPECT_EQ(replay(log).size(), 100u) << kv::storage::to_string(mode);
+    }
+}
+
+TEST(WriteAheadLog, ParseSyncMode) {
+    EXPECT_EQ(kv::storage::parse_wal_sync_mode("none"), WalSyncMode::None);
+    EXPECT_EQ(kv::storage::parse_wal_sync_mode("batch"), WalSyncMode::Batch);
+    EXPECT_EQ(kv::storage::parse_wal_sync_mode("periodic"), WalSyncMode::Periodic);
+    EXPECT_FALSE(kv::storage::parse_wal_sync_mode("always").has_value());
+}
+
+// Rotation moves later appends to a new segment; dropping the older segments
+// leaves only what was written after the rotation to replay.
+TEST(WriteAheadLog, RotateSplitsSegments) {
+    TempDir log;
+    uint64_t segment = 0;
+    {
+        WriteAheadLog wal(wal_options(log), [](auto&&...) {});
+        EXPECT_TRUE(wal.append("before", "1", Version{1, 1}));
+        segment = wal.rotate();
+        EXPECT_EQ(segment, 2u);
+        EXPECT_TRUE(wal.append("after", "2", Version{2, 1}));
+    }
+    EXPECT_EQ(replay(log).size(), 2u);
+
+    auto opts = wal_options(log);
+    opts.first_segment = segment;
+    std::map<std::string, Record> records;
+    {
+        WriteAheadLog wal(opts, [&](const std::string& key, ValueRef value, const Version& v) {
+            records[key] = Record{value.str(), v};
+        });
+    }
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records["after"].value, "2");
+    EXPECT_FALSE(std::filesystem::exists(log.path / "wal-0000000000000001.log"));
+}
+
+// A wal.log from before segmentation is replayed as the first segment; next
+// to existing segments it is refused rather than silently ignored.
+TEST(WriteAheadLog, LegacyLogIsMigratedOrRefused) {
+    TempDir log;
+    {
+        WriteAheadLog wal(wal_options(log), [](auto&&...) {});
+        EXPECT_TRUE(wal.append("a", "1", Version{10, 1}));
+    }
+    std::filesystem::rename(log.path / "wal-0000000000000001.log", log.path / "wal.log");
+
+    {
+        WriteAheadLog wal(wal_options(log), [](auto&&...) {});
+        EXPECT_EQ(wal.replayed_records(), 1u);
+        EXPECT_TRUE(wal.append("b", "2", Version{20, 1}));
+    }
+    EXPECT_FALSE(std::filesystem::exists(log.path / "wal.log"));
+    EXPECT_EQ(replay(log).size(), 2u);
+
+    std::filesystem::copy_file(log.path / "wal-0000000000000001.log", log.path / "wal.log");
+    EXPECT_THROW(WriteAheadLog(wal_options(log), [](auto&&...) {}), std::runtime_error);
+}